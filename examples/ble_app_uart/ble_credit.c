@@ -0,0 +1,58 @@
+/** @file
+ *
+ * @brief Write credit characteristic implementation.
+ */
+
+#include "ble_credit.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "app_util.h"
+
+
+/**@brief Function for sending the limit, as a notification if possible.
+ */
+static void limit_send(ble_credit_t * p_credit)
+{
+    UNUSED_VARIABLE(uint16_encode(p_credit->limit, p_credit->value));
+    ble_notify_char_send(&p_credit->chr);
+}
+
+
+uint32_t ble_credit_init(ble_credit_t * p_credit, uint16_t service_handle, uint8_t uuid_type)
+{
+    p_credit->limit = 0;
+    memset(p_credit->value, 0, sizeof(p_credit->value));
+
+    return ble_notify_char_add(&p_credit->chr,
+                               service_handle,
+                               uuid_type,
+                               BLE_UUID_NUS_CREDIT_CHARACTERISTIC,
+                               p_credit->value,
+                               sizeof(p_credit->value));
+}
+
+
+void ble_credit_on_ble_evt(ble_credit_t * p_credit, ble_evt_t * p_ble_evt)
+{
+    ble_notify_char_on_ble_evt(&p_credit->chr, p_ble_evt);
+
+    if (p_ble_evt->header.evt_id == BLE_GAP_EVT_CONNECTED)
+    {
+        // The client counts its writes from the start of the connection.
+        p_credit->limit = 0;
+        limit_send(p_credit);
+    }
+}
+
+
+void ble_credit_limit_set(ble_credit_t * p_credit, uint16_t limit)
+{
+    if ((int16_t)(limit - p_credit->limit) <= 0)
+    {
+        return;
+    }
+
+    p_credit->limit = limit;
+    limit_send(p_credit);
+}
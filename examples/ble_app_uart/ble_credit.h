@@ -0,0 +1,57 @@
+/** @file
+ *
+ * @defgroup ble_credit Write credit characteristic
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Characteristic telling the NUS client how many writes the bridge can accept.
+ *
+ * @details The characteristic is added to the Nordic UART Service (UUID 0x0004 on the NUS base).
+ *          Its value is a uint16 write limit, little endian: the client may keep writing to the NUS
+ *          RX characteristic while the number of writes it did since the connection was set up is
+ *          lower than the limit. The limit only grows, so a client never has to combine a
+ *          notification with the writes in flight when it was sent.
+ *
+ *          The value is notified every time it changes while notifications are enabled, see
+ *          @ref ble_notify_char.
+ */
+
+#ifndef BLE_CREDIT_H__
+#define BLE_CREDIT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble.h"
+#include "ble_notify_char.h"
+
+#define BLE_UUID_NUS_CREDIT_CHARACTERISTIC 0x0004                                  /**< UUID of the credit characteristic, on the NUS base UUID. */
+
+/**@brief Credit characteristic instance. */
+typedef struct
+{
+    ble_notify_char_t        chr;                                                   /**< Characteristic. */
+    uint16_t                 limit;                                                 /**< Current write limit. */
+    uint8_t                  value[sizeof(uint16_t)];                               /**< limit, encoded. */
+} ble_credit_t;
+
+/**@brief Function for adding the characteristic to a service.
+ *
+ * @param[out] p_credit        Instance.
+ * @param[in]  service_handle  Handle of the NUS service.
+ * @param[in]  uuid_type       UUID type of the NUS base UUID.
+ *
+ * @return NRF_SUCCESS or an error code from sd_ble_gatts_characteristic_add.
+ */
+uint32_t ble_credit_init(ble_credit_t * p_credit, uint16_t service_handle, uint8_t uuid_type);
+
+/**@brief Function for handling the events of the BLE stack. */
+void ble_credit_on_ble_evt(ble_credit_t * p_credit, ble_evt_t * p_ble_evt);
+
+/**@brief Function for setting the write limit, notifying it if it changed.
+ *
+ * @details Setting a limit lower than the current one is ignored.
+ */
+void ble_credit_limit_set(ble_credit_t * p_credit, uint16_t limit);
+
+#endif // BLE_CREDIT_H__
+
+/** @} */
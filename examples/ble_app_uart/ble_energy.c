@@ -0,0 +1,43 @@
+/** @file
+ *
+ * @brief Energy characteristic implementation.
+ */
+
+#include "ble_energy.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "app_util.h"
+
+
+uint32_t ble_energy_init(ble_energy_t * p_energy, uint16_t service_handle, uint8_t uuid_type)
+{
+    memset(p_energy->value, 0, sizeof(p_energy->value));
+
+    return ble_notify_char_add(&p_energy->chr,
+                               service_handle,
+                               uuid_type,
+                               BLE_UUID_NUS_ENERGY_CHARACTERISTIC,
+                               p_energy->value,
+                               sizeof(p_energy->value));
+}
+
+
+void ble_energy_on_ble_evt(ble_energy_t * p_energy, ble_evt_t * p_ble_evt)
+{
+    ble_notify_char_on_ble_evt(&p_energy->chr, p_ble_evt);
+}
+
+
+void ble_energy_update(ble_energy_t * p_energy, energy_summary_t const * p_summary)
+{
+    uint8_t * p_value = p_energy->value;
+
+    p_value += uint32_encode(p_summary->elapsed_s, p_value);
+    p_value += uint32_encode(p_summary->current_na, p_value);
+    p_value += uint32_encode(p_summary->charge_uc, p_value);
+    p_value += uint32_encode(p_summary->bytes, p_value);
+    UNUSED_VARIABLE(uint32_encode(p_summary->nj_per_byte, p_value));
+
+    ble_notify_char_send(&p_energy->chr);
+}
@@ -0,0 +1,51 @@
+/** @file
+ *
+ * @defgroup ble_energy Energy characteristic
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Characteristic carrying the energy estimate of @ref energy to the NUS client.
+ *
+ * @details The characteristic is added to the Nordic UART Service (UUID 0x0005 on the NUS base).
+ *          Its value is an @ref energy_summary_t, five uint32 little endian, 20 bytes so that it
+ *          fits a notification at the default ATT MTU. It can be read at any time and is notified
+ *          on every update while notifications are enabled, see @ref ble_notify_char.
+ */
+
+#ifndef BLE_ENERGY_H__
+#define BLE_ENERGY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble.h"
+#include "ble_notify_char.h"
+#include "energy.h"
+
+#define BLE_UUID_NUS_ENERGY_CHARACTERISTIC 0x0005                                  /**< UUID of the energy characteristic, on the NUS base UUID. */
+#define BLE_ENERGY_VALUE_LEN            20                                          /**< Length of the value. */
+
+/**@brief Energy characteristic instance. */
+typedef struct
+{
+    ble_notify_char_t        chr;                                                   /**< Characteristic. */
+    uint8_t                  value[BLE_ENERGY_VALUE_LEN];                           /**< Current value, encoded. */
+} ble_energy_t;
+
+/**@brief Function for adding the characteristic to a service.
+ *
+ * @param[out] p_energy        Instance.
+ * @param[in]  service_handle  Handle of the NUS service.
+ * @param[in]  uuid_type       UUID type of the NUS base UUID.
+ *
+ * @return NRF_SUCCESS or an error code from sd_ble_gatts_characteristic_add.
+ */
+uint32_t ble_energy_init(ble_energy_t * p_energy, uint16_t service_handle, uint8_t uuid_type);
+
+/**@brief Function for handling the events of the BLE stack. */
+void ble_energy_on_ble_evt(ble_energy_t * p_energy, ble_evt_t * p_ble_evt);
+
+/**@brief Function for setting the value, notifying it if enabled. */
+void ble_energy_update(ble_energy_t * p_energy, energy_summary_t const * p_summary);
+
+#endif // BLE_ENERGY_H__
+
+/** @} */
@@ -0,0 +1,157 @@
+/** @file
+ *
+ * @brief Notified characteristic implementation.
+ */
+
+#include "ble_notify_char.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "app_error.h"
+
+
+uint32_t ble_notify_char_add(ble_notify_char_t * p_char,
+                             uint16_t            service_handle,
+                             uint8_t             uuid_type,
+                             uint16_t            uuid,
+                             uint8_t *           p_value,
+                             uint16_t            value_len)
+{
+    ble_gatts_char_md_t char_md;
+    ble_gatts_attr_md_t cccd_md;
+    ble_gatts_attr_t    attr_char_value;
+    ble_uuid_t          ble_uuid;
+    ble_gatts_attr_md_t attr_md;
+
+    p_char->conn_handle             = BLE_CONN_HANDLE_INVALID;
+    p_char->p_value                 = p_value;
+    p_char->value_len               = value_len;
+    p_char->is_notification_enabled = false;
+    p_char->notify_pending          = false;
+
+    memset(&cccd_md, 0, sizeof(cccd_md));
+
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.read_perm);
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.write_perm);
+
+    cccd_md.vloc = BLE_GATTS_VLOC_STACK;
+
+    memset(&char_md, 0, sizeof(char_md));
+
+    char_md.char_props.read   = 1;
+    char_md.char_props.notify = 1;
+    char_md.p_char_user_desc  = NULL;
+    char_md.p_char_pf         = NULL;
+    char_md.p_user_desc_md    = NULL;
+    char_md.p_cccd_md         = &cccd_md;
+    char_md.p_sccd_md         = NULL;
+
+    ble_uuid.type = uuid_type;
+    ble_uuid.uuid = uuid;
+
+    memset(&attr_md, 0, sizeof(attr_md));
+
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&attr_md.read_perm);
+    BLE_GAP_CONN_SEC_MODE_SET_NO_ACCESS(&attr_md.write_perm);
+
+    attr_md.vloc    = BLE_GATTS_VLOC_STACK;
+    attr_md.rd_auth = 0;
+    attr_md.wr_auth = 0;
+    attr_md.vlen    = 0;
+
+    memset(&attr_char_value, 0, sizeof(attr_char_value));
+
+    attr_char_value.p_uuid    = &ble_uuid;
+    attr_char_value.p_attr_md = &attr_md;
+    attr_char_value.init_len  = value_len;
+    attr_char_value.init_offs = 0;
+    attr_char_value.max_len   = value_len;
+    attr_char_value.p_value   = p_value;
+
+    return sd_ble_gatts_characteristic_add(service_handle,
+                                           &char_md,
+                                           &attr_char_value,
+                                           &p_char->handles);
+}
+
+
+void ble_notify_char_on_ble_evt(ble_notify_char_t * p_char, ble_evt_t * p_ble_evt)
+{
+    ble_gatts_evt_write_t * p_evt_write;
+
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+            p_char->conn_handle             = p_ble_evt->evt.gap_evt.conn_handle;
+            p_char->is_notification_enabled = false;
+            break;
+
+        case BLE_GAP_EVT_DISCONNECTED:
+            p_char->conn_handle             = BLE_CONN_HANDLE_INVALID;
+            p_char->is_notification_enabled = false;
+            p_char->notify_pending          = false;
+            break;
+
+        case BLE_GATTS_EVT_WRITE:
+            p_evt_write = &p_ble_evt->evt.gatts_evt.params.write;
+            if ((p_evt_write->handle == p_char->handles.cccd_handle) && (p_evt_write->len == 2))
+            {
+                p_char->is_notification_enabled = ((p_evt_write->data[0] & BLE_GATT_HVX_NOTIFICATION) != 0);
+                if (p_char->is_notification_enabled)
+                {
+                    ble_notify_char_send(p_char);
+                }
+            }
+            break;
+
+        case BLE_EVT_TX_COMPLETE:
+            if (p_char->notify_pending)
+            {
+                ble_notify_char_send(p_char);
+            }
+            break;
+
+        default:
+            // No implementation needed.
+            break;
+    }
+}
+
+
+void ble_notify_char_send(ble_notify_char_t * p_char)
+{
+    uint16_t               length = p_char->value_len;
+    uint32_t               err_code;
+    ble_gatts_hvx_params_t hvx_params;
+    ble_gatts_value_t      gatts_value;
+
+    if ((p_char->conn_handle == BLE_CONN_HANDLE_INVALID) || !p_char->is_notification_enabled)
+    {
+        memset(&gatts_value, 0, sizeof(gatts_value));
+        gatts_value.len     = length;
+        gatts_value.p_value = p_char->p_value;
+
+        err_code = sd_ble_gatts_value_set(p_char->conn_handle, p_char->handles.value_handle, &gatts_value);
+        APP_ERROR_CHECK(err_code);
+        p_char->notify_pending = false;
+        return;
+    }
+
+    memset(&hvx_params, 0, sizeof(hvx_params));
+    hvx_params.handle = p_char->handles.value_handle;
+    hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+    hvx_params.p_len  = &length;
+    hvx_params.p_data = p_char->p_value;
+
+    err_code = sd_ble_gatts_hvx(p_char->conn_handle, &hvx_params);
+    if (err_code == BLE_ERROR_NO_TX_BUFFERS)
+    {
+        p_char->notify_pending = true;
+        return;
+    }
+    if ((err_code != NRF_ERROR_INVALID_STATE) && (err_code != BLE_ERROR_GATTS_SYS_ATTR_MISSING))
+    {
+        APP_ERROR_CHECK(err_code);
+    }
+    p_char->notify_pending = false;
+}
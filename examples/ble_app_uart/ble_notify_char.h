@@ -0,0 +1,63 @@
+/** @file
+ *
+ * @defgroup ble_notify_char Notified characteristic
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Read-only characteristic whose value is notified when it changes, the common part of
+ *           @ref ble_credit and @ref ble_energy.
+ *
+ * @details The user owns the value buffer and encodes into it, then calls
+ *          @ref ble_notify_char_send. The value is notified while the client has enabled
+ *          notifications and only stored otherwise, so that it can always be read. A notification
+ *          that finds no free SoftDevice TX buffer is sent again on BLE_EVT_TX_COMPLETE.
+ */
+
+#ifndef BLE_NOTIFY_CHAR_H__
+#define BLE_NOTIFY_CHAR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble.h"
+
+/**@brief Notified characteristic instance. */
+typedef struct
+{
+    uint16_t                 conn_handle;                                           /**< Handle of the current connection, BLE_CONN_HANDLE_INVALID if not connected. */
+    ble_gatts_char_handles_t handles;                                               /**< Handles of the characteristic. */
+    uint8_t *                p_value;                                               /**< Encoded value, owned by the user. */
+    uint16_t                 value_len;                                             /**< Length of the value. */
+    bool                     is_notification_enabled;                               /**< The client enabled notifications. */
+    bool                     notify_pending;                                        /**< The value changed and was not notified yet. */
+} ble_notify_char_t;
+
+/**@brief Function for adding the characteristic to a service.
+ *
+ * @param[out] p_char          Instance.
+ * @param[in]  service_handle  Handle of the service.
+ * @param[in]  uuid_type       UUID type of the base UUID of the service.
+ * @param[in]  uuid            UUID of the characteristic on that base.
+ * @param[in]  p_value         Value buffer, its content is the initial value.
+ * @param[in]  value_len       Length of the value.
+ *
+ * @return NRF_SUCCESS or an error code from sd_ble_gatts_characteristic_add.
+ */
+uint32_t ble_notify_char_add(ble_notify_char_t * p_char,
+                             uint16_t            service_handle,
+                             uint8_t             uuid_type,
+                             uint16_t            uuid,
+                             uint8_t *           p_value,
+                             uint16_t            value_len);
+
+/**@brief Function for handling the events of the BLE stack: connection, CCCD writes and the retry
+ *        of a pending notification.
+ *
+ * @details Enabling notifications sends the current value.
+ */
+void ble_notify_char_on_ble_evt(ble_notify_char_t * p_char, ble_evt_t * p_ble_evt);
+
+/**@brief Function for sending the value, as a notification if possible. */
+void ble_notify_char_send(ble_notify_char_t * p_char);
+
+#endif // BLE_NOTIFY_CHAR_H__
+
+/** @} */
@@ -0,0 +1,278 @@
+/** @file
+ *
+ * @brief BLE activity timeline implementation.
+ */
+
+#include "ble_timeline.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "ctrl.h"
+#include "isr_prof.h"
+
+STATIC_ASSERT(sizeof(ble_timeline_stats_t) <= CTRL_RSP_DATA_MAX);
+
+static ble_timeline_gap_handler_t m_gap_handler;                                    /**< Handler of the gaps waited for. */
+static ble_timeline_stats_t       m_stats;                                          /**< Statistics. */
+static volatile bool              m_active = false;                                 /**< Between the two notifications of an event. */
+static volatile bool              m_gap_wait = false;                               /**< A run waits for the end of the next event. */
+static volatile bool              m_synced = false;                                 /**< m_next holds a prediction. */
+static volatile uint32_t          m_interval = 0;                                   /**< Connection interval, 0 when not connected. */
+static volatile uint32_t          m_next;                                           /**< RTC1 counter at the predicted start notification of the next event. */
+static uint32_t                   m_active_start;                                   /**< RTC1 counter at the start notification of the current event. */
+static uint32_t                   m_run_start;                                      /**< RTC1 counter at the start of the current run. */
+static uint32_t                   m_run_events;                                     /**< Events seen when the current run started. */
+
+
+/**@brief Function for getting the signed distance between two RTC1 counter values.
+ */
+static int32_t ticks_between(uint32_t from, uint32_t to)
+{
+    // The RTC1 counter has 24 bits, move the sign to bit 31.
+    return ((int32_t)((to - from) << 8)) / 256;
+}
+
+
+/**@brief Function for checking whether the current event has lasted too long to still be in
+ *        progress, its end notification having been lost.
+ *
+ * @details Between events of a connection the gap is the longer part of the interval, so an
+ *          alternation inverted by a lost start notification is caught in the same way.
+ */
+static bool active_expired(uint32_t now)
+{
+    uint32_t limit = BLE_TIMELINE_ACTIVE_MAX_TICKS;
+    uint32_t active;
+
+    if (m_interval != 0)
+    {
+        limit = MIN(limit, m_interval / 2);
+    }
+
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_active_start, &active));
+    return (active > limit);
+}
+
+
+/**@brief Function for checking an event against its prediction and predicting the next one.
+ */
+static void on_event_start(uint32_t now)
+{
+    int32_t  error;
+    uint32_t missed;
+
+    m_stats.events++;
+    m_active_start = now;
+
+    if (m_interval == 0)
+    {
+        return;
+    }
+
+    if (m_synced)
+    {
+        // An event later than half an interval is the next one, the SoftDevice skipped some.
+        error = ticks_between(m_next, now);
+        if (error > (int32_t)(m_interval / 2))
+        {
+            missed          = ((uint32_t)error + m_interval / 2) / m_interval;
+            m_stats.skipped += missed;
+            error          -= (int32_t)(missed * m_interval);
+        }
+
+        m_stats.jitter_last = (uint32_t)((error < 0) ? -error : error);
+        m_stats.jitter_max  = MAX(m_stats.jitter_max, m_stats.jitter_last);
+    }
+
+    // Predict from the actual start, the interval is rounded to ticks and would drift otherwise.
+    m_next   = now + m_interval;
+    m_synced = true;
+}
+
+
+/**@brief Function for handling the SoftDevice radio notification, at the start and at the end of
+ *        every BLE radio event.
+ */
+void RADIO_NOTIFICATION_IRQHandler(void)
+{
+    uint16_t start = isr_prof_enter(ISR_PROF_RADIO_NOTIFICATION);
+    uint32_t now;
+    uint32_t active;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+
+    if (m_active && active_expired(now))
+    {
+        m_stats.resyncs++;
+        m_active = false;
+    }
+
+    m_active = !m_active;
+    if (m_active)
+    {
+        on_event_start(now);
+    }
+    else
+    {
+        UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_active_start, &active));
+        m_stats.active_max = MAX(m_stats.active_max, active);
+        if (active > BLE_TIMELINE_DISTANCE_TICKS)
+        {
+            m_stats.active_ticks += active - BLE_TIMELINE_DISTANCE_TICKS;
+        }
+
+        if (m_gap_wait)
+        {
+            m_gap_wait = false;
+            m_gap_handler();
+        }
+    }
+
+    isr_prof_exit(ISR_PROF_RADIO_NOTIFICATION, start);
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_BLE_TIMELINE.
+ */
+static uint8_t ble_timeline_stats_get(uint8_t * p_buf)
+{
+    CRITICAL_REGION_ENTER();
+    memcpy(p_buf, &m_stats, sizeof(m_stats));
+    CRITICAL_REGION_EXIT();
+    return sizeof(m_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_BLE_TIMELINE.
+ */
+static void ble_timeline_stats_clear(void)
+{
+    CRITICAL_REGION_ENTER();
+    memset(&m_stats, 0, sizeof(m_stats));
+    CRITICAL_REGION_EXIT();
+}
+
+
+uint32_t ble_timeline_init(ble_timeline_gap_handler_t gap_handler)
+{
+    uint32_t err_code;
+
+    m_gap_handler = gap_handler;
+
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_BLE_TIMELINE, ble_timeline_stats_get, ble_timeline_stats_clear);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = sd_nvic_ClearPendingIRQ(RADIO_NOTIFICATION_IRQn);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    err_code = sd_nvic_SetPriority(RADIO_NOTIFICATION_IRQn, APP_IRQ_PRIORITY_LOW);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    err_code = sd_nvic_EnableIRQ(RADIO_NOTIFICATION_IRQn);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    return sd_radio_notification_cfg_set(NRF_RADIO_NOTIFICATION_TYPE_INT_ON_BOTH, BLE_TIMELINE_DISTANCE);
+}
+
+
+void ble_timeline_interval_set(uint32_t interval_ticks)
+{
+    bool release;
+
+    CRITICAL_REGION_ENTER();
+    m_interval = interval_ticks;
+    m_synced   = false;
+    release    = (interval_ticks == 0) && m_gap_wait;
+    if (release)
+    {
+        m_gap_wait = false;
+    }
+    CRITICAL_REGION_EXIT();
+
+    // Nothing to wait for without a connection.
+    if (release)
+    {
+        m_gap_handler();
+    }
+}
+
+
+bool ble_timeline_gap_fits(uint32_t run_ticks)
+{
+    uint32_t now;
+    int32_t  left;
+    bool     fits = true;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+
+    CRITICAL_REGION_ENTER();
+    if (m_active && !active_expired(now))
+    {
+        fits = false;
+    }
+    else if (m_synced)
+    {
+        left = ticks_between(now, m_next);
+        if (left < 0)
+        {
+            // Overdue: the event was skipped, the next one is due an interval later.
+            left = (int32_t)m_interval - (int32_t)((uint32_t)(-left) % m_interval);
+        }
+        fits = ((uint32_t)left >= run_ticks);
+    }
+
+    if (!fits)
+    {
+        m_gap_wait = true;
+        m_stats.deferrals++;
+    }
+    CRITICAL_REGION_EXIT();
+
+    return fits;
+}
+
+
+uint32_t ble_timeline_active_ticks_get(void)
+{
+    uint32_t ticks;
+
+    CRITICAL_REGION_ENTER();
+    ticks = m_stats.active_ticks;
+    CRITICAL_REGION_EXIT();
+    return ticks;
+}
+
+
+void ble_timeline_run_begin(void)
+{
+    UNUSED_VARIABLE(app_timer_cnt_get(&m_run_start));
+    m_run_events = m_stats.events;
+}
+
+
+void ble_timeline_run_end(void)
+{
+    uint32_t now;
+    uint32_t run;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_run_start, &run));
+
+    CRITICAL_REGION_ENTER();
+    m_stats.run_max = MAX(m_stats.run_max, run);
+    if ((m_stats.events != m_run_events) || (m_active && !active_expired(now)))
+    {
+        m_stats.overlaps++;
+    }
+    CRITICAL_REGION_EXIT();
+}
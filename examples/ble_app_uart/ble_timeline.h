@@ -0,0 +1,103 @@
+/** @file
+ *
+ * @defgroup ble_timeline BLE activity timeline
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Prediction of the BLE radio events, to fit the CC1101 work in the gaps between them.
+ *
+ * @details The SoftDevice blocks the application around each of its radio events. SPI transfers
+ *          caught by such an event stretch by the length of the event, so the time the CC1101
+ *          waits for its FIFO to be drained or loaded becomes unpredictable.
+ *
+ *          The SoftDevice radio notification signals both the start of an event, @ref
+ *          BLE_TIMELINE_DISTANCE ahead of it, and its end. Each notification is stamped with the
+ *          RTC1 counter. While connected, the next event is predicted from the previous one and the
+ *          connection interval, and the difference with the actual start is the jitter.
+ *
+ *          The notification does not tell a start from an end, so they are told apart by
+ *          alternation. A lost notification would invert that for good, hence an event that lasts
+ *          longer than @ref BLE_TIMELINE_ACTIVE_MAX_TICKS, or half the connection interval, is taken
+ *          as ended and the notification that found it as the start of the next one.
+ *
+ *          Before a piece of work that must not be split, @ref ble_timeline_gap_fits tells whether
+ *          it ends before the next event. If not, the gap handler runs at the end of the next
+ *          event, at the start of a full gap. @ref ble_timeline_run_begin and
+ *          @ref ble_timeline_run_end count the runs that were caught by an event anyway.
+ *
+ *          The timing is read from @ref CTRL_STATS_PAGE_BLE_TIMELINE.
+ */
+
+#ifndef BLE_TIMELINE_H__
+#define BLE_TIMELINE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nrf_soc.h"
+
+#define BLE_TIMELINE_DISTANCE           NRF_RADIO_NOTIFICATION_DISTANCE_800US       /**< Notification ahead of an event, long enough for the SPI transfer in progress to end. */
+#define BLE_TIMELINE_DISTANCE_TICKS     26                                          /**< BLE_TIMELINE_DISTANCE in RTC1 ticks. */
+#define BLE_TIMELINE_ACTIVE_MAX_TICKS   328                                         /**< Longest event believed, 10 ms, notification distance included. Longer ones lost their end notification. */
+
+/**@brief Function called at the end of a BLE radio event when work was held back for the gap.
+ *
+ * @details Runs in interrupt context, at APP_IRQ_PRIORITY_LOW.
+ */
+typedef void (*ble_timeline_gap_handler_t)(void);
+
+/**@brief Statistics, @ref CTRL_STATS_PAGE_BLE_TIMELINE. Times in RTC1 ticks. */
+typedef struct
+{
+    uint32_t events;                                                                /**< BLE radio events. */
+    uint32_t skipped;                                                               /**< Connection events that did not take place. */
+    uint32_t jitter_last;                                                           /**< Distance between the last event and its prediction. */
+    uint32_t jitter_max;                                                            /**< Largest distance between an event and its prediction. */
+    uint32_t active_max;                                                            /**< Longest event, notification distance included. */
+    uint32_t deferrals;                                                             /**< Runs held back to the next gap. */
+    uint32_t overlaps;                                                              /**< Runs caught by a BLE radio event. */
+    uint32_t run_max;                                                               /**< Longest run. */
+    uint32_t active_ticks;                                                          /**< Time in BLE radio events, notification distance excluded. */
+    uint32_t resyncs;                                                               /**< Notifications taken as a start although an event was in progress. */
+} ble_timeline_stats_t;
+
+/**@brief Function for enabling the radio notifications.
+ *
+ * @details Registers @ref CTRL_STATS_PAGE_BLE_TIMELINE. The SoftDevice must be enabled.
+ *
+ * @param[in] gap_handler  Handler of the gaps waited for.
+ *
+ * @return NRF_SUCCESS or an error code from the SoftDevice.
+ */
+uint32_t ble_timeline_init(ble_timeline_gap_handler_t gap_handler);
+
+/**@brief Function for setting the connection interval, which the prediction is based on.
+ *
+ * @details To be called on connection, on a connection parameter update and on disconnection.
+ *          Without a connection nothing is predicted and every run fits.
+ *
+ * @param[in] interval_ticks  Connection interval in RTC1 ticks, 0 when not connected.
+ */
+void ble_timeline_interval_set(uint32_t interval_ticks);
+
+/**@brief Function for checking whether a run ends before the next BLE radio event.
+ *
+ * @details If not, the run is counted as deferred and the gap handler will be called at the end of
+ *          the next event.
+ *
+ * @param[in] run_ticks  Longest time the run takes.
+ */
+bool ble_timeline_gap_fits(uint32_t run_ticks);
+
+/**@brief Function for getting the time spent in BLE radio events, as in
+ *        @ref CTRL_STATS_PAGE_BLE_TIMELINE.
+ */
+uint32_t ble_timeline_active_ticks_get(void);
+
+/**@brief Function for marking the start of a run. */
+void ble_timeline_run_begin(void);
+
+/**@brief Function for marking the end of a run. */
+void ble_timeline_run_end(void);
+
+#endif // BLE_TIMELINE_H__
+
+/** @} */
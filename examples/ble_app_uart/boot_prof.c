@@ -0,0 +1,58 @@
+/** @file
+ *
+ * @brief Boot timing implementation.
+ */
+
+#include "boot_prof.h"
+#include "nordic_common.h"
+#include "app_timer.h"
+#include "SEGGER_RTT.h"
+
+#define BOOT_PROF_TICKS_TO_US(ticks)    ((uint32_t)(((uint64_t)(ticks) * 1000000) / APP_TIMER_CLOCK_FREQ)) /**< RTC1 ticks to us, app_timer runs RTC1 without prescaler. */
+
+STATIC_ASSERT(BOOT_PROF_COUNT <= 16);
+
+/**@brief Names printed, in the order of @ref boot_prof_phase_t. */
+static char const * const m_names[BOOT_PROF_COUNT] =
+{
+    "timers",
+    "drivers",
+    "radio_start",
+    "ble_stack",
+    "storage",
+    "services",
+    "advertising",
+    "main_loop",
+    "radio_ready",
+    "connected",
+};
+
+static uint32_t m_ticks[BOOT_PROF_COUNT];                                           /**< RTC1 counter at every mark. */
+static uint16_t m_marked   = 0;                                                     /**< Phases marked, one bit each. */
+static uint16_t m_reported = 0;                                                     /**< Phases printed, one bit each. */
+
+
+void boot_prof_mark(boot_prof_phase_t phase)
+{
+    if ((m_marked & (1u << phase)) != 0)
+    {
+        return;
+    }
+    UNUSED_VARIABLE(app_timer_cnt_get(&m_ticks[phase]));
+    m_marked |= (1u << phase);
+}
+
+
+void boot_prof_report(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < BOOT_PROF_COUNT; i++)
+    {
+        if (((m_marked & ~m_reported) & (1u << i)) != 0)
+        {
+            SEGGER_RTT_printf(0, "boot %s %u\n", m_names[i], BOOT_PROF_TICKS_TO_US(m_ticks[i]));
+            m_reported |= (1u << i);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/** @file
+ *
+ * @defgroup boot_prof Boot timing
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Time of every init phase from the start of RTC1, printed on RTT.
+ *
+ * @details main() marks the end of every phase with @ref boot_prof_mark, and the radio and the BLE
+ *          event handler mark the CC1101 ready and the first connection, which happen later from
+ *          the main loop. Only the first mark of a phase counts. @ref boot_prof_report prints the
+ *          marks not printed yet on RTT channel 0, as "boot <phase> <us>".
+ *
+ *          RTC1 starts in app_timer init, with the LFCLK already running from the crystal the
+ *          SoftDevice uses. The reset and the crystal start before it are not counted. The
+ *          resolution is one RTC1 tick, 31 us.
+ */
+
+#ifndef BOOT_PROF_H__
+#define BOOT_PROF_H__
+
+#include <stdint.h>
+
+/**@brief Phases timed, in boot order. */
+typedef enum
+{
+    BOOT_PROF_TIMERS,                                                               /**< Scheduler and app_timer, the time origin. */
+    BOOT_PROF_DRIVERS,                                                              /**< ctrl, profilers, watchdog, router, GPIOTE, UART and SPI. */
+    BOOT_PROF_RADIO_START,                                                          /**< CC1101 driver set up and its reset sequence started. */
+    BOOT_PROF_BLE_STACK,                                                            /**< SoftDevice enabled. */
+    BOOT_PROF_STORAGE,                                                              /**< pstorage, flash scheduler, key/value store and the settings read from it. */
+    BOOT_PROF_SERVICES,                                                             /**< GAP, NUS, advertising data and connection parameters. */
+    BOOT_PROF_ADVERTISING,                                                          /**< Advertising started. */
+    BOOT_PROF_MAIN_LOOP,                                                            /**< Main loop entered. */
+    BOOT_PROF_RADIO_READY,                                                          /**< CC1101 reset, configured and receiving. */
+    BOOT_PROF_CONNECTED,                                                            /**< First BLE connection. */
+    BOOT_PROF_COUNT                                                                 /**< Number of phases. */
+} boot_prof_phase_t;
+
+/**@brief Function for recording the end of a phase, once. */
+void boot_prof_mark(boot_prof_phase_t phase);
+
+/**@brief Function for printing the marks recorded since the last report on RTT.
+ *
+ * @details Not for interrupt context.
+ */
+void boot_prof_report(void);
+
+#endif // BOOT_PROF_H__
+
+/** @} */
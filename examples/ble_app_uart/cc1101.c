@@ -0,0 +1,253 @@
+/** @file
+ *
+ * @brief CC1101 driver implementation.
+ */
+
+#include "cc1101.h"
+#include <string.h>
+
+#ifndef CC1101_HAL_HEADER
+#define CC1101_HAL_HEADER "cc1101_hal_nrf51.h"
+#endif
+
+#include CC1101_HAL_HEADER
+
+#define CC1101_RX_APPENDED              2                                           /**< RSSI and LQI bytes after a received packet. */
+#define CC1101_CRC_OK                   0x80                                        /**< CRC_OK bit of the LQI byte. */
+#define CC1101_BYTES_MASK               0x7F                                        /**< Byte count of TXBYTES and RXBYTES. */
+
+
+/**@brief Function for pulling SS low and waiting for CHIP_RDYn.
+ *
+ * @return false if the chip did not get ready, SS is then high again.
+ */
+static bool cc1101_select(cc1101_t * p_dev)
+{
+    uint32_t spins = CC1101_RDY_SPINS;
+
+    cc1101_hal_ss_low();
+    while (cc1101_hal_so())
+    {
+        if (--spins == 0)
+        {
+            cc1101_hal_ss_high();
+            p_dev->rdy_timeouts++;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**@brief Function for decoding the chip status byte answered to a header.
+ */
+static void cc1101_status_update(cc1101_t * p_dev, uint8_t header, uint8_t status)
+{
+    p_dev->status     = status;
+    p_dev->state      = status & CC1101_STATUS_STATE_MASK;
+    p_dev->fifo_bytes = status & CC1101_STATUS_FIFO_MASK;
+
+    // A flush strobe answers the status from before it, so it clears the flag whatever it reads.
+    if (header == CC1101_SFRX)
+    {
+        p_dev->rx_overflow = false;
+    }
+    else if (p_dev->state == CC1101_STATE_RXFIFO_OVERFLOW)
+    {
+        p_dev->rx_overflow = true;
+    }
+
+    if (header == CC1101_SFTX)
+    {
+        p_dev->tx_underflow = false;
+    }
+    else if (p_dev->state == CC1101_STATE_TXFIFO_UNDERFLOW)
+    {
+        p_dev->tx_underflow = true;
+    }
+}
+
+
+/**@brief Function for an access of a header byte and len bytes of p_dev->buf.
+ *
+ * @details The header goes into buf[0], the chip status byte comes back in its place.
+ */
+static bool cc1101_access(cc1101_t * p_dev, uint8_t header, uint8_t len)
+{
+    if (!cc1101_select(p_dev))
+    {
+        return false;
+    }
+
+    p_dev->buf[0] = header;
+    cc1101_hal_transfer(p_dev->buf, p_dev->buf, 1 + len);
+    cc1101_hal_ss_high();
+
+    p_dev->accesses++;
+    cc1101_status_update(p_dev, header, p_dev->buf[0]);
+    return true;
+}
+
+
+void cc1101_init(cc1101_t * p_dev)
+{
+    memset(p_dev, 0, sizeof(*p_dev));
+    cc1101_hal_init();
+}
+
+
+bool cc1101_chip_ready(cc1101_t * p_dev)
+{
+    cc1101_hal_ss_low();
+    return !cc1101_hal_so();
+}
+
+
+void cc1101_deselect(cc1101_t * p_dev)
+{
+    cc1101_hal_ss_high();
+}
+
+
+bool cc1101_wake(cc1101_t * p_dev)
+{
+    uint32_t waited = 0;
+
+    cc1101_hal_ss_low();
+    while (cc1101_hal_so())
+    {
+        if (waited >= CC1101_WAKE_US)
+        {
+            cc1101_hal_ss_high();
+            p_dev->rdy_timeouts++;
+            return false;
+        }
+        cc1101_hal_delay_us(CC1101_WAKE_STEP_US);
+        waited += CC1101_WAKE_STEP_US;
+    }
+    cc1101_hal_ss_high();
+    return true;
+}
+
+
+bool cc1101_strobe(cc1101_t * p_dev, uint8_t strobe)
+{
+    return cc1101_access(p_dev, strobe, 0);
+}
+
+
+bool cc1101_status_read(cc1101_t * p_dev, bool rx_fifo)
+{
+    return cc1101_access(p_dev, rx_fifo ? (CC1101_SNOP | CC1101_READ_SINGLE) : CC1101_SNOP, 0);
+}
+
+
+bool cc1101_write(cc1101_t * p_dev, uint8_t addr, uint8_t value)
+{
+    p_dev->buf[1] = value;
+    return cc1101_access(p_dev, addr, 1);
+}
+
+
+bool cc1101_write_burst(cc1101_t * p_dev, uint8_t addr, uint8_t const * p_data, uint8_t len)
+{
+    memcpy(&p_dev->buf[1], p_data, len);
+    return cc1101_access(p_dev, addr | CC1101_WRITE_BURST, len);
+}
+
+
+uint8_t cc1101_read(cc1101_t * p_dev, uint8_t addr)
+{
+    p_dev->buf[1] = 0;
+    if (!cc1101_access(p_dev, addr | CC1101_READ_SINGLE, 1))
+    {
+        return 0;
+    }
+    return p_dev->buf[1];
+}
+
+
+bool cc1101_read_burst(cc1101_t * p_dev, uint8_t addr, uint8_t * p_data, uint8_t len)
+{
+    memset(&p_dev->buf[1], 0, len);
+    if (!cc1101_access(p_dev, addr | CC1101_READ_BURST, len))
+    {
+        memset(p_data, 0, len);
+        return false;
+    }
+    memcpy(p_data, &p_dev->buf[1], len);
+    return true;
+}
+
+
+uint8_t cc1101_read_status(cc1101_t * p_dev, uint8_t addr)
+{
+    p_dev->buf[1] = 0;
+    if (!cc1101_access(p_dev, addr | CC1101_READ_BURST, 1))
+    {
+        return 0;
+    }
+    return p_dev->buf[1];
+}
+
+
+cc1101_rx_t cc1101_rx_read(cc1101_t * p_dev, uint8_t * p_packet, uint8_t max_len, uint8_t * p_len)
+{
+    uint8_t rx_bytes;
+    uint8_t len;
+
+    if (!cc1101_status_read(p_dev, true))
+    {
+        return CC1101_RX_NONE;
+    }
+    if (p_dev->rx_overflow)
+    {
+        (void)cc1101_strobe(p_dev, CC1101_SFRX);
+        return CC1101_RX_OVERFLOW;
+    }
+
+    // MCSM1 returns the radio to IDLE once a whole packet is in the RX FIFO, the count is stable.
+    if ((p_dev->state != CC1101_STATE_IDLE) || (p_dev->fifo_bytes == 0))
+    {
+        return CC1101_RX_NONE;
+    }
+    rx_bytes = p_dev->fifo_bytes;
+
+    len = cc1101_read(p_dev, CC1101_FIFO);
+    if ((rx_bytes == CC1101_STATUS_FIFO_MASK) && (1 + len + CC1101_RX_APPENDED > rx_bytes))
+    {
+        // The status byte stops counting at 15, only RXBYTES tells whether the rest is there.
+        // It no longer counts the length byte read above.
+        rx_bytes = 1 + (cc1101_read_status(p_dev, CC1101_RXBYTES) & CC1101_BYTES_MASK);
+    }
+    if ((len == 0) || (len > max_len) || (1 + len + CC1101_RX_APPENDED > rx_bytes))
+    {
+        (void)cc1101_strobe(p_dev, CC1101_SFRX);
+        return CC1101_RX_OVERFLOW;
+    }
+
+    // The packet and the RSSI and LQI bytes, read in one burst.
+    if (!cc1101_access(p_dev, CC1101_FIFO | CC1101_READ_BURST, len + CC1101_RX_APPENDED))
+    {
+        return CC1101_RX_NONE;
+    }
+
+    if ((p_dev->buf[1 + len + 1] & CC1101_CRC_OK) == 0)
+    {
+        return CC1101_RX_CRC_ERROR;
+    }
+
+    memcpy(p_packet, &p_dev->buf[1], len);
+    *p_len = len;
+    return CC1101_RX_OK;
+}
+
+
+bool cc1101_tx_start(cc1101_t * p_dev, uint8_t const * p_packet, uint8_t len)
+{
+    if (!cc1101_write_burst(p_dev, CC1101_FIFO, p_packet, len))
+    {
+        return false;
+    }
+    return cc1101_strobe(p_dev, CC1101_STX);
+}
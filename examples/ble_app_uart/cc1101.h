@@ -0,0 +1,274 @@
+/** @file
+ *
+ * @defgroup cc1101 CC1101 driver
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Register, strobe and FIFO access to a CC1101 over SPI.
+ *
+ * @details Every access pulls SS low, waits for CHIP_RDYn (SO low) for at most
+ *          @ref CC1101_RDY_SPINS checks, then exchanges the header byte and the data. The chip
+ *          status byte it answers to the header is decoded into the device context: the state of
+ *          the radio and the bytes in the RX FIFO after a read, or free in the TX FIFO after a
+ *          write. An RX FIFO overflow or a TX FIFO underflow is latched by whichever access sees it
+ *          first and cleared by the SFRX or SFTX strobe, so the packet paths do not read MARCSTATE,
+ *          RXBYTES or TXBYTES for it. A missing or stuck chip makes the access fail and counts a
+ *          timeout, it never hangs the application.
+ *
+ *          The driver only handles bytes, the pins and the SPI peripheral are reached through a
+ *          HAL of static inline functions, selected at compile time with CC1101_HAL_HEADER. The
+ *          default, @ref cc1101_hal_nrf51.h, maps to the nRF51 GPIO and SPI registers with the
+ *          pins fixed at compile time. The host build in host/ provides its own HAL with the same
+ *          functions and runs the driver against a simulated chip, "make test" there.
+ *
+ *          Nothing here waits for the radio itself: the caller sequences resets and sends.
+ */
+
+#ifndef CC1101_H__
+#define CC1101_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CC1101_FIFO_SIZE                64                                          /**< Size of the RX and TX FIFOs. */
+#define CC1101_RDY_SPINS                100                                         /**< Checks of CHIP_RDYn before an access gives up. The crystal is running then, so it is low right away. */
+#define CC1101_WAKE_US                  1000                                        /**< Longest crystal start after SXOFF or SPWD, 150 us typical. */
+#define CC1101_WAKE_STEP_US             10                                          /**< Interval of the CHIP_RDYn checks while the crystal starts. */
+
+#define CC1101_WRITE_BURST              0x40                                        /**< Header bit of a burst write. */
+#define CC1101_READ_SINGLE              0x80                                        /**< Header bit of a single read. */
+#define CC1101_READ_BURST               0xC0                                        /**< Header bits of a burst read, also selects the status registers. */
+
+#define CC1101_STATUS_CHIP_RDYN         0x80                                        /**< Chip status byte: crystal not running yet. */
+#define CC1101_STATUS_STATE_MASK        0x70                                        /**< Chip status byte: state of the radio. */
+#define CC1101_STATUS_FIFO_MASK         0x0F                                        /**< Chip status byte: FIFO bytes, 15 meaning 15 or more. */
+#define CC1101_MARCSTATE_MASK           0x1F                                        /**< MARCSTATE: state bits. */
+
+/**@brief Configuration registers. */
+enum
+{
+    CC1101_IOCFG2   = 0x00,                                                         /**< GDO2 output pin configuration. */
+    CC1101_IOCFG1   = 0x01,                                                         /**< GDO1 output pin configuration. */
+    CC1101_IOCFG0   = 0x02,                                                         /**< GDO0 output pin configuration. */
+    CC1101_FIFOTHR  = 0x03,                                                         /**< RX FIFO and TX FIFO thresholds. */
+    CC1101_SYNC1    = 0x04,                                                         /**< Sync word, high byte. */
+    CC1101_SYNC0    = 0x05,                                                         /**< Sync word, low byte. */
+    CC1101_PKTLEN   = 0x06,                                                         /**< Packet length. */
+    CC1101_PKTCTRL1 = 0x07,                                                         /**< Packet automation control. */
+    CC1101_PKTCTRL0 = 0x08,                                                         /**< Packet automation control. */
+    CC1101_ADDR     = 0x09,                                                         /**< Device address. */
+    CC1101_CHANNR   = 0x0A,                                                         /**< Channel number. */
+    CC1101_FSCTRL1  = 0x0B,                                                         /**< Frequency synthesizer control. */
+    CC1101_FSCTRL0  = 0x0C,                                                         /**< Frequency synthesizer control. */
+    CC1101_FREQ2    = 0x0D,                                                         /**< Frequency control word, high byte. */
+    CC1101_FREQ1    = 0x0E,                                                         /**< Frequency control word, middle byte. */
+    CC1101_FREQ0    = 0x0F,                                                         /**< Frequency control word, low byte. */
+    CC1101_MDMCFG4  = 0x10,                                                         /**< Modem configuration. */
+    CC1101_MDMCFG3  = 0x11,                                                         /**< Modem configuration. */
+    CC1101_MDMCFG2  = 0x12,                                                         /**< Modem configuration. */
+    CC1101_MDMCFG1  = 0x13,                                                         /**< Modem configuration. */
+    CC1101_MDMCFG0  = 0x14,                                                         /**< Modem configuration. */
+    CC1101_DEVIATN  = 0x15,                                                         /**< Modem deviation setting. */
+    CC1101_MCSM2    = 0x16,                                                         /**< Main radio control state machine configuration. */
+    CC1101_MCSM1    = 0x17,                                                         /**< Main radio control state machine configuration. */
+    CC1101_MCSM0    = 0x18,                                                         /**< Main radio control state machine configuration. */
+    CC1101_FOCCFG   = 0x19,                                                         /**< Frequency offset compensation configuration. */
+    CC1101_BSCFG    = 0x1A,                                                         /**< Bit synchronization configuration. */
+    CC1101_AGCCTRL2 = 0x1B,                                                         /**< AGC control. */
+    CC1101_AGCCTRL1 = 0x1C,                                                         /**< AGC control. */
+    CC1101_AGCCTRL0 = 0x1D,                                                         /**< AGC control. */
+    CC1101_WOREVT1  = 0x1E,                                                         /**< Event 0 timeout, high byte. */
+    CC1101_WOREVT0  = 0x1F,                                                         /**< Event 0 timeout, low byte. */
+    CC1101_WORCTRL  = 0x20,                                                         /**< Wake on radio control. */
+    CC1101_FREND1   = 0x21,                                                         /**< Front end RX configuration. */
+    CC1101_FREND0   = 0x22,                                                         /**< Front end TX configuration. */
+    CC1101_FSCAL3   = 0x23,                                                         /**< Frequency synthesizer calibration. */
+    CC1101_FSCAL2   = 0x24,                                                         /**< Frequency synthesizer calibration. */
+    CC1101_FSCAL1   = 0x25,                                                         /**< Frequency synthesizer calibration. */
+    CC1101_FSCAL0   = 0x26,                                                         /**< Frequency synthesizer calibration. */
+    CC1101_RCCTRL1  = 0x27,                                                         /**< RC oscillator configuration. */
+    CC1101_RCCTRL0  = 0x28,                                                         /**< RC oscillator configuration. */
+    CC1101_FSTEST   = 0x29,                                                         /**< Frequency synthesizer calibration control. */
+    CC1101_PTEST    = 0x2A,                                                         /**< Production test. */
+    CC1101_AGCTEST  = 0x2B,                                                         /**< AGC test. */
+    CC1101_TEST2    = 0x2C,                                                         /**< Various test settings. */
+    CC1101_TEST1    = 0x2D,                                                         /**< Various test settings. */
+    CC1101_TEST0    = 0x2E,                                                         /**< Various test settings. */
+    CC1101_PATABLE  = 0x3E,                                                         /**< PA power table. */
+    CC1101_FIFO     = 0x3F                                                          /**< TX FIFO when written, RX FIFO when read. */
+};
+
+/**@brief Command strobes. */
+enum
+{
+    CC1101_SRES    = 0x30,                                                          /**< Reset chip. */
+    CC1101_SFSTXON = 0x31,                                                          /**< Enable and calibrate the frequency synthesizer. */
+    CC1101_SXOFF   = 0x32,                                                          /**< Turn off the crystal oscillator. */
+    CC1101_SCAL    = 0x33,                                                          /**< Calibrate the frequency synthesizer and turn it off. */
+    CC1101_SRX     = 0x34,                                                          /**< Enable RX. */
+    CC1101_STX     = 0x35,                                                          /**< Enable TX. */
+    CC1101_SIDLE   = 0x36,                                                          /**< Exit RX or TX, turn off the frequency synthesizer. */
+    CC1101_SAFC    = 0x37,                                                          /**< AFC adjustment of the frequency synthesizer. */
+    CC1101_SWOR    = 0x38,                                                          /**< Start wake on radio. */
+    CC1101_SPWD    = 0x39,                                                          /**< Enter power down mode when SS goes high. */
+    CC1101_SFRX    = 0x3A,                                                          /**< Flush the RX FIFO. */
+    CC1101_SFTX    = 0x3B,                                                          /**< Flush the TX FIFO. */
+    CC1101_SWORRST = 0x3C,                                                          /**< Reset the wake on radio timer. */
+    CC1101_SNOP    = 0x3D                                                           /**< No operation, returns the status byte. */
+};
+
+/**@brief Status registers, read with @ref cc1101_read_status. */
+enum
+{
+    CC1101_PARTNUM   = 0x30,                                                        /**< Part number. */
+    CC1101_VERSION   = 0x31,                                                        /**< Chip version. */
+    CC1101_FREQEST   = 0x32,                                                        /**< Frequency offset estimate. */
+    CC1101_LQI       = 0x33,                                                        /**< Link quality estimate. */
+    CC1101_RSSI      = 0x34,                                                        /**< Received signal strength. */
+    CC1101_MARCSTATE = 0x35,                                                        /**< Main radio control state machine state. */
+    CC1101_PKTSTATUS = 0x38,                                                        /**< GDOx and packet status. */
+    CC1101_TXBYTES   = 0x3A,                                                        /**< Underflow and bytes in the TX FIFO. */
+    CC1101_RXBYTES   = 0x3B                                                         /**< Overflow and bytes in the RX FIFO. */
+};
+
+/**@brief MARCSTATE values the driver looks at. */
+enum
+{
+    CC1101_MARCSTATE_IDLE             = 0x01,                                       /**< Idle. */
+    CC1101_MARCSTATE_RX               = 0x0D,                                       /**< Receiving. */
+    CC1101_MARCSTATE_RXFIFO_OVERFLOW  = 0x11,                                       /**< RX FIFO overflowed, flush with SFRX. */
+    CC1101_MARCSTATE_TX               = 0x13,                                       /**< Sending. */
+    CC1101_MARCSTATE_TXFIFO_UNDERFLOW = 0x16                                        /**< TX FIFO underflowed, flush with SFTX. */
+};
+
+/**@brief States of the chip status byte, see @ref cc1101_t.state. */
+enum
+{
+    CC1101_STATE_IDLE             = 0x00,                                           /**< Idle. */
+    CC1101_STATE_RX               = 0x10,                                           /**< Receiving. */
+    CC1101_STATE_TX               = 0x20,                                           /**< Sending. */
+    CC1101_STATE_FSTXON           = 0x30,                                           /**< Frequency synthesizer on, ready to send. */
+    CC1101_STATE_CALIBRATE        = 0x40,                                           /**< Calibrating the frequency synthesizer. */
+    CC1101_STATE_SETTLING         = 0x50,                                           /**< PLL settling. */
+    CC1101_STATE_RXFIFO_OVERFLOW  = 0x60,                                           /**< RX FIFO overflowed, flush with SFRX. */
+    CC1101_STATE_TXFIFO_UNDERFLOW = 0x70                                            /**< TX FIFO underflowed, flush with SFTX. */
+};
+
+/**@brief Results of @ref cc1101_rx_read. */
+typedef enum
+{
+    CC1101_RX_NONE,                                                                 /**< No packet, the radio is still receiving. */
+    CC1101_RX_OK,                                                                   /**< Packet read, with a valid CRC. */
+    CC1101_RX_OVERFLOW,                                                             /**< RX FIFO overflow or bad length byte, the FIFO was flushed. */
+    CC1101_RX_CRC_ERROR                                                             /**< Packet read, with a bad CRC. */
+} cc1101_rx_t;
+
+/**@brief Device context. */
+typedef struct
+{
+    uint8_t  status;                                                                /**< Chip status byte of the last access. */
+    uint8_t  state;                                                                 /**< State bits of status, one of CC1101_STATE_*. */
+    uint8_t  fifo_bytes;                                                            /**< Bytes in the RX FIFO after a read, free in the TX FIFO after a write, 15 meaning 15 or more. */
+    bool     rx_overflow;                                                           /**< An RX FIFO overflow was seen, until SFRX. */
+    bool     tx_underflow;                                                          /**< A TX FIFO underflow was seen, until SFTX. */
+    uint32_t accesses;                                                              /**< SPI accesses. */
+    uint32_t rdy_timeouts;                                                          /**< Accesses abandoned because CHIP_RDYn stayed high. */
+    uint8_t  buf[1 + CC1101_FIFO_SIZE];                                             /**< Header and data of a burst, sent and received in place. */
+} cc1101_t;
+
+/**@brief Function for initializing a device context and its pins. SS is left high.
+ */
+void cc1101_init(cc1101_t * p_dev);
+
+/**@brief Function for pulling SS low and checking CHIP_RDYn once, for the reset sequence.
+ *
+ * @details SS stays low, @ref cc1101_deselect releases it.
+ *
+ * @return true if the chip is ready.
+ */
+bool cc1101_chip_ready(cc1101_t * p_dev);
+
+/**@brief Function for pulling SS high. */
+void cc1101_deselect(cc1101_t * p_dev);
+
+/**@brief Function for waking the chip from SXOFF or SPWD.
+ *
+ * @details Pulls SS low and waits for the crystal, at most @ref CC1101_WAKE_US. The chip is then
+ *          IDLE. After SPWD the registers it loses in SLEEP must be written again. Busy-waits, a
+ *          caller with a timer polls @ref cc1101_chip_ready instead.
+ *
+ * @return false if the chip did not get ready.
+ */
+bool cc1101_wake(cc1101_t * p_dev);
+
+/**@brief Function for sending a command strobe.
+ *
+ * @return false if the chip did not answer.
+ */
+bool cc1101_strobe(cc1101_t * p_dev, uint8_t strobe);
+
+/**@brief Function for refreshing the chip status with a single byte SNOP.
+ *
+ * @param[in] rx_fifo  true for the bytes in the RX FIFO, false for the bytes free in the TX FIFO.
+ *
+ * @return false if the chip did not answer.
+ */
+bool cc1101_status_read(cc1101_t * p_dev, bool rx_fifo);
+
+/**@brief Function for writing a configuration register.
+ *
+ * @return false if the chip did not answer.
+ */
+bool cc1101_write(cc1101_t * p_dev, uint8_t addr, uint8_t value);
+
+/**@brief Function for writing consecutive registers, the PATABLE or the TX FIFO.
+ *
+ * @param[in] len  At most @ref CC1101_FIFO_SIZE.
+ *
+ * @return false if the chip did not answer.
+ */
+bool cc1101_write_burst(cc1101_t * p_dev, uint8_t addr, uint8_t const * p_data, uint8_t len);
+
+/**@brief Function for reading a configuration register.
+ *
+ * @return Register value, 0 if the chip did not answer.
+ */
+uint8_t cc1101_read(cc1101_t * p_dev, uint8_t addr);
+
+/**@brief Function for reading consecutive registers or the RX FIFO.
+ *
+ * @param[in] len  At most @ref CC1101_FIFO_SIZE.
+ *
+ * @return false if the chip did not answer, p_data is then zeroed.
+ */
+bool cc1101_read_burst(cc1101_t * p_dev, uint8_t addr, uint8_t * p_data, uint8_t len);
+
+/**@brief Function for reading a status register.
+ *
+ * @return Register value, 0 if the chip did not answer.
+ */
+uint8_t cc1101_read_status(cc1101_t * p_dev, uint8_t addr);
+
+/**@brief Function for reading a packet from the RX FIFO, once the radio went back to IDLE after it.
+ *
+ * @details Expects variable length packets with the RSSI and LQI bytes appended (PKTCTRL1). The
+ *          state and the byte count come from the status byte of an SNOP, RXBYTES is only read when
+ *          a packet is longer than the status byte can count.
+ *
+ * @param[out] p_packet  Packet without its length byte, at least @p max_len bytes.
+ * @param[in]  max_len   Largest packet accepted, longer ones are counted as an overflow.
+ * @param[out] p_len     Length of the packet, for @ref CC1101_RX_OK.
+ */
+cc1101_rx_t cc1101_rx_read(cc1101_t * p_dev, uint8_t * p_packet, uint8_t max_len, uint8_t * p_len);
+
+/**@brief Function for loading a packet into the TX FIFO and starting to send it.
+ *
+ * @param[in] p_packet  Packet, length byte first.
+ * @param[in] len       Bytes in p_packet, at most @ref CC1101_FIFO_SIZE.
+ *
+ * @return false if the chip did not answer.
+ */
+bool cc1101_tx_start(cc1101_t * p_dev, uint8_t const * p_packet, uint8_t len);
+
+#endif // CC1101_H__
+
+/** @} */
@@ -0,0 +1,135 @@
+/** @file
+ *
+ * @defgroup cc1101_cfg CC1101 register generator
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    CC1101 register values computed at compile time from physical parameters.
+ *
+ * @details Each macro implements a formula of the CC1101 datasheet (section 12 to 21) in 64 bit
+ *          integer arithmetic, so it folds into a constant and a const register table costs nothing
+ *          at runtime. All parameters are in Hz, or Baud for the data rate, and results are rounded
+ *          to the nearest value the chip can produce:
+ *
+ *          - Carrier:         f = f_xosc / 2^16 * FREQ
+ *          - Data rate:       R = f_xosc / 2^28 * (256 + DRATE_M) * 2^DRATE_E
+ *          - Deviation:       f_dev = f_xosc / 2^17 * (8 + DEVIATION_M) * 2^DEVIATION_E
+ *          - Channel spacing: df = f_xosc / 2^18 * (256 + CHANSPC_M) * 2^CHANSPC_E
+ *          - RX filter:       BW = f_xosc / (8 * (4 + CHANBW_M) * 2^CHANBW_E), the narrowest
+ *                             setting at least as wide as requested
+ *          - IF:              f_if = f_xosc / 2^10 * FREQ_IF
+ *
+ *          @ref CC1101_CFG_CHECK rejects parameters the chip cannot produce when the file is
+ *          compiled. The end of this file checks the generator against the RF Studio values of the
+ *          original 868 MHz, 1.2 kBaud GFSK configuration. host/test_cc1101_cfg.c sweeps every
+ *          macro over its range against the formulas above in floating point, "make test" there.
+ */
+
+#ifndef CC1101_CFG_H__
+#define CC1101_CFG_H__
+
+#include "app_util.h"
+
+#define CC1101_XOSC_HZ                  26000000ULL                                 /**< Crystal frequency. */
+
+#define CC1101_DIV_ROUND(a, b)          (((a) + ((b) / 2)) / (b))                   /**< Rounded division of unsigned values. */
+
+/**@brief Carrier frequency. */
+#define CC1101_FREQ_WORD(f)             CC1101_DIV_ROUND((unsigned long long)(f) << 16, CC1101_XOSC_HZ)
+#define CC1101_FREQ2(f)                 ((uint8_t)(CC1101_FREQ_WORD(f) >> 16))
+#define CC1101_FREQ1(f)                 ((uint8_t)(CC1101_FREQ_WORD(f) >> 8))
+#define CC1101_FREQ0(f)                 ((uint8_t)(CC1101_FREQ_WORD(f)))
+
+/**@brief Data rate. E is the largest exponent with a mantissa of at least 256, rounding the
+ *        mantissa up to 512 moves to the next exponent. */
+#define CC1101_DRATE_SCALED(r)          ((unsigned long long)(r) << 20)
+#define CC1101_DRATE_E_FIT(r, e)        (CC1101_DRATE_SCALED(r) >= (CC1101_XOSC_HZ << (e)))
+#define CC1101_DRATE_E_RAW(r)                                                                        \
+    (CC1101_DRATE_E_FIT(r, 14) ? 14 : CC1101_DRATE_E_FIT(r, 13) ? 13 : CC1101_DRATE_E_FIT(r, 12) ? 12 : \
+     CC1101_DRATE_E_FIT(r, 11) ? 11 : CC1101_DRATE_E_FIT(r, 10) ? 10 : CC1101_DRATE_E_FIT(r, 9) ? 9 :   \
+     CC1101_DRATE_E_FIT(r, 8) ? 8 : CC1101_DRATE_E_FIT(r, 7) ? 7 : CC1101_DRATE_E_FIT(r, 6) ? 6 :       \
+     CC1101_DRATE_E_FIT(r, 5) ? 5 : CC1101_DRATE_E_FIT(r, 4) ? 4 : CC1101_DRATE_E_FIT(r, 3) ? 3 :       \
+     CC1101_DRATE_E_FIT(r, 2) ? 2 : CC1101_DRATE_E_FIT(r, 1) ? 1 : 0)
+#define CC1101_DRATE_M_RAW(r)           \
+    (CC1101_DIV_ROUND((unsigned long long)(r) << 28, CC1101_XOSC_HZ << CC1101_DRATE_E_RAW(r)) - 256)
+#define CC1101_DRATE_E(r)               (CC1101_DRATE_E_RAW(r) + ((CC1101_DRATE_M_RAW(r) >= 256) ? 1 : 0))
+#define CC1101_DRATE_M(r)               ((uint8_t)((CC1101_DRATE_M_RAW(r) >= 256) ? 0 : CC1101_DRATE_M_RAW(r)))
+
+/**@brief Frequency deviation, same scheme as the data rate with a 3 bit mantissa. */
+#define CC1101_DEV_SCALED(d)            ((unsigned long long)(d) << 17)
+#define CC1101_DEV_E_FIT(d, e)          (CC1101_DEV_SCALED(d) >= ((8 * CC1101_XOSC_HZ) << (e)))
+#define CC1101_DEV_E_RAW(d)                                                                          \
+    (CC1101_DEV_E_FIT(d, 7) ? 7 : CC1101_DEV_E_FIT(d, 6) ? 6 : CC1101_DEV_E_FIT(d, 5) ? 5 :          \
+     CC1101_DEV_E_FIT(d, 4) ? 4 : CC1101_DEV_E_FIT(d, 3) ? 3 : CC1101_DEV_E_FIT(d, 2) ? 2 :          \
+     CC1101_DEV_E_FIT(d, 1) ? 1 : 0)
+#define CC1101_DEV_M_RAW(d)             \
+    (CC1101_DIV_ROUND(CC1101_DEV_SCALED(d), CC1101_XOSC_HZ << CC1101_DEV_E_RAW(d)) - 8)
+#define CC1101_DEV_E(d)                 (CC1101_DEV_E_RAW(d) + (((CC1101_DEV_M_RAW(d) >= 8) && (CC1101_DEV_E_RAW(d) < 7)) ? 1 : 0))
+#define CC1101_DEV_M(d)                 ((CC1101_DEV_M_RAW(d) >= 8) ? ((CC1101_DEV_E_RAW(d) < 7) ? 0 : 7) : CC1101_DEV_M_RAW(d))
+#define CC1101_DEVIATN(d)               ((uint8_t)((CC1101_DEV_E(d) << 4) | CC1101_DEV_M(d)))
+
+/**@brief Channel spacing, 2 bit exponent and 8 bit mantissa. */
+#define CC1101_CHANSPC_SCALED(s)        ((unsigned long long)(s) << 18)
+#define CC1101_CHANSPC_E_FIT(s, e)      (CC1101_CHANSPC_SCALED(s) >= ((256 * CC1101_XOSC_HZ) << (e)))
+#define CC1101_CHANSPC_E_RAW(s)         \
+    (CC1101_CHANSPC_E_FIT(s, 3) ? 3 : CC1101_CHANSPC_E_FIT(s, 2) ? 2 : CC1101_CHANSPC_E_FIT(s, 1) ? 1 : 0)
+#define CC1101_CHANSPC_M_RAW(s)         \
+    (CC1101_DIV_ROUND(CC1101_CHANSPC_SCALED(s), CC1101_XOSC_HZ << CC1101_CHANSPC_E_RAW(s)) - 256)
+#define CC1101_CHANSPC_E(s)             (CC1101_CHANSPC_E_RAW(s) + (((CC1101_CHANSPC_M_RAW(s) >= 256) && (CC1101_CHANSPC_E_RAW(s) < 3)) ? 1 : 0))
+#define CC1101_CHANSPC_M(s)             ((uint8_t)((CC1101_CHANSPC_M_RAW(s) >= 256) ? ((CC1101_CHANSPC_E_RAW(s) < 3) ? 0 : 255) : CC1101_CHANSPC_M_RAW(s)))
+
+/**@brief RX filter bandwidth. Settings are numbered 4 * E + M, from the widest (0, 812 kHz) to the
+ *        narrowest (15, 58 kHz). */
+#define CC1101_CHANBW_HZ(k)             (CC1101_XOSC_HZ / (8 * (4 + ((k) & 3)) << ((k) >> 2)))
+#define CC1101_CHANBW_FIT(b, k)         (CC1101_CHANBW_HZ(k) >= (unsigned long long)(b))
+#define CC1101_CHANBW_K(b)                                                                          \
+    (CC1101_CHANBW_FIT(b, 15) ? 15 : CC1101_CHANBW_FIT(b, 14) ? 14 : CC1101_CHANBW_FIT(b, 13) ? 13 : \
+     CC1101_CHANBW_FIT(b, 12) ? 12 : CC1101_CHANBW_FIT(b, 11) ? 11 : CC1101_CHANBW_FIT(b, 10) ? 10 : \
+     CC1101_CHANBW_FIT(b, 9) ? 9 : CC1101_CHANBW_FIT(b, 8) ? 8 : CC1101_CHANBW_FIT(b, 7) ? 7 :       \
+     CC1101_CHANBW_FIT(b, 6) ? 6 : CC1101_CHANBW_FIT(b, 5) ? 5 : CC1101_CHANBW_FIT(b, 4) ? 4 :       \
+     CC1101_CHANBW_FIT(b, 3) ? 3 : CC1101_CHANBW_FIT(b, 2) ? 2 : CC1101_CHANBW_FIT(b, 1) ? 1 : 0)
+
+/**@brief Modem registers. */
+#define CC1101_MDMCFG4(bw, r)           ((uint8_t)((CC1101_CHANBW_K(bw) << 4) | CC1101_DRATE_E(r)))
+#define CC1101_MDMCFG3(r)               CC1101_DRATE_M(r)
+#define CC1101_MDMCFG1(fec, preamble, s) ((uint8_t)(((fec) << 7) | ((preamble) << 4) | CC1101_CHANSPC_E(s)))
+#define CC1101_MDMCFG0(s)               CC1101_CHANSPC_M(s)
+
+/**@brief Intermediate frequency. */
+#define CC1101_FSCTRL1(f_if)            ((uint8_t)(CC1101_DIV_ROUND((unsigned long long)(f_if) << 10, CC1101_XOSC_HZ) & 0x1F))
+
+/**@brief Compile time range checks of a set of parameters.
+ *
+ * @details Place at file scope next to the register table built from the same parameters.
+ */
+#define CC1101_CFG_CHECK(f, r, d, s, bw)                                                            \
+    STATIC_ASSERT((((f) >= 300000000ULL) && ((f) <= 348000000ULL)) ||                               \
+                  (((f) >= 387000000ULL) && ((f) <= 464000000ULL)) ||                               \
+                  (((f) >= 779000000ULL) && ((f) <= 928000000ULL)));                                \
+    STATIC_ASSERT(((r) >= 600) && ((r) <= 500000));                                                 \
+    STATIC_ASSERT(((d) >= 1587) && ((d) <= 380859));                                                \
+    STATIC_ASSERT(((s) >= 25390) && ((s) <= 405456));                                               \
+    STATIC_ASSERT(((bw) >= 58000) && ((bw) <= 812500))
+
+/* Generator checked against the RF Studio values of the original configuration: 868 MHz, 1.2 kBaud,
+ * 5.2 kHz deviation, 200 kHz channel spacing, 58 kHz RX filter, 152 kHz IF. */
+STATIC_ASSERT(CC1101_FREQ2(868000000) == 0x21);
+STATIC_ASSERT(CC1101_FREQ1(868000000) == 0x62);
+STATIC_ASSERT(CC1101_FREQ0(868000000) == 0x76);
+STATIC_ASSERT(CC1101_MDMCFG4(58000, 1200) == 0xF5);
+STATIC_ASSERT(CC1101_MDMCFG3(1200) == 0x83);
+STATIC_ASSERT(CC1101_MDMCFG1(0, 2, 200000) == 0x22);
+STATIC_ASSERT(CC1101_MDMCFG0(200000) == 0xF8);
+STATIC_ASSERT(CC1101_DEVIATN(5200) == 0x15);
+STATIC_ASSERT(CC1101_FSCTRL1(152000) == 0x06);
+
+/* Corner cases: mantissa rounding into the next exponent, and the limits of each field. */
+STATIC_ASSERT((CC1101_DRATE_E(249938) == 13) && (CC1101_DRATE_M(249938) == 0x3B));
+STATIC_ASSERT((CC1101_DRATE_E(38383) == 10) && (CC1101_DRATE_M(38383) == 0x83));
+STATIC_ASSERT((CC1101_DRATE_E(1586) == 6) && (CC1101_DRATE_M(1586) == 0x00));
+STATIC_ASSERT(CC1101_DEVIATN(47607) == 0x47);
+STATIC_ASSERT(CC1101_MDMCFG4(812500, 1200) == 0x05);
+STATIC_ASSERT(CC1101_MDMCFG4(100000, 1200) == 0xC5);
+
+#endif // CC1101_CFG_H__
+
+/** @} */
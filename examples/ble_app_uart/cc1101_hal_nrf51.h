@@ -0,0 +1,138 @@
+/** @file
+ *
+ * @defgroup cc1101_hal_nrf51 CC1101 driver HAL for the nRF51
+ * @{
+ * @ingroup  cc1101
+ * @brief    Pins and SPI of the @ref cc1101 driver, on the nRF51 registers.
+ *
+ * @details The pins are fixed at compile time, so every function compiles to a few register
+ *          accesses. SS is a plain GPIO owned by the driver, nrf_drv_spi is initialized without it.
+ *
+ *          Transfers of up to @ref CC1101_HAL_POLL_MAX bytes, strobes and register accesses, are
+ *          polled on the double buffered TXD/RXD registers: two bytes are written up front, then
+ *          one more every time a received byte is read, so the clock never stops between bytes.
+ *          nrf_drv_spi is idle then, its interrupt is disabled so that it does not see the READY
+ *          events; it enables it again for its next transfer. Longer bursts go to
+ *          @ref cc1101_hal_burst, interrupt driven by the application.
+ *
+ *          A transfer may use the same buffer for TX and RX: byte n is received after byte n + 1
+ *          was written.
+ */
+
+#ifndef CC1101_HAL_NRF51_H__
+#define CC1101_HAL_NRF51_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nrf.h"
+#include "nrf_gpio.h"
+#include "nrf_delay.h"
+#include "boards.h"
+#include "compiler_abstraction.h"
+
+#define CC1101_HAL_SS_PIN               SPIM0_SS_PIN                                /**< CC1101 CSn. */
+#define CC1101_HAL_SO_PIN               SPIM0_MISO_PIN                              /**< CC1101 SO, low when the chip is ready. */
+#define CC1101_HAL_SPI                  NRF_SPI0                                    /**< SPI master of the CC1101, instance 0 in nrf_drv_config.h. */
+#define CC1101_HAL_POLL_MAX             8                                           /**< Longest transfer that is polled rather than interrupt driven. */
+
+/**@brief Function for an interrupt driven transfer, provided by the application.
+ *
+ * @details Returns once the transfer is done, or once it has failed: the application then resets
+ *          the chip, see @ref recovery.
+ */
+void cc1101_hal_burst(uint8_t const * p_tx, uint8_t * p_rx, uint16_t len);
+
+
+/**@brief Function for configuring SS as an output, high. */
+static __INLINE void cc1101_hal_init(void)
+{
+    NRF_GPIO->OUTSET = (1UL << CC1101_HAL_SS_PIN);
+    nrf_gpio_cfg_output(CC1101_HAL_SS_PIN);
+}
+
+
+/**@brief Function for pulling SS low. */
+static __INLINE void cc1101_hal_ss_low(void)
+{
+    NRF_GPIO->OUTCLR = (1UL << CC1101_HAL_SS_PIN);
+}
+
+
+/**@brief Function for pulling SS high. */
+static __INLINE void cc1101_hal_ss_high(void)
+{
+    NRF_GPIO->OUTSET = (1UL << CC1101_HAL_SS_PIN);
+}
+
+
+/**@brief Function for reading SO, CHIP_RDYn while no byte is exchanged. */
+static __INLINE bool cc1101_hal_so(void)
+{
+    return ((NRF_GPIO->IN >> CC1101_HAL_SO_PIN) & 1UL) != 0;
+}
+
+
+/**@brief Function for waiting, while the crystal starts. */
+static __INLINE void cc1101_hal_delay_us(uint32_t us)
+{
+    nrf_delay_us(us);
+}
+
+
+/**@brief Function for a polled transfer. */
+static __INLINE void cc1101_hal_poll(uint8_t const * p_tx, uint8_t * p_rx, uint16_t len)
+{
+    uint16_t tx = 0;
+    uint16_t rx = 0;
+
+    if (CC1101_HAL_SPI->ENABLE == 0)
+    {
+        // No SPI master until the recovery started by the application: read 0xFF, do not hang.
+        while (rx < len)
+        {
+            p_rx[rx++] = 0xFF;
+        }
+        return;
+    }
+
+    CC1101_HAL_SPI->INTENCLR     = SPI_INTENCLR_READY_Msk;
+    CC1101_HAL_SPI->EVENTS_READY = 0;
+
+    CC1101_HAL_SPI->TXD = p_tx[tx++];
+    if (tx < len)
+    {
+        CC1101_HAL_SPI->TXD = p_tx[tx++];
+    }
+
+    while (rx < len)
+    {
+        while (CC1101_HAL_SPI->EVENTS_READY == 0)
+        {
+        }
+        CC1101_HAL_SPI->EVENTS_READY = 0;
+        p_rx[rx++] = (uint8_t)CC1101_HAL_SPI->RXD;
+
+        if (tx < len)
+        {
+            CC1101_HAL_SPI->TXD = p_tx[tx++];
+        }
+    }
+}
+
+
+/**@brief Function for a transfer, SS is already low. */
+static __INLINE void cc1101_hal_transfer(uint8_t const * p_tx, uint8_t * p_rx, uint16_t len)
+{
+    if (len <= CC1101_HAL_POLL_MAX)
+    {
+        cc1101_hal_poll(p_tx, p_rx, len);
+    }
+    else
+    {
+        cc1101_hal_burst(p_tx, p_rx, len);
+    }
+}
+
+#endif // CC1101_HAL_NRF51_H__
+
+/** @} */
@@ -0,0 +1,263 @@
+/** @file
+ *
+ * @brief CC1101 shadow registers implementation.
+ */
+
+#include "cc1101_shadow.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "compiler_abstraction.h"
+#include "nrf_error.h"
+
+#define REG_FSCAL3                      0x23                                        /**< Frequency synthesizer calibration. */
+#define REG_FSCAL2                      0x24                                        /**< Frequency synthesizer calibration. */
+#define REG_FSCAL1                      0x25                                        /**< Frequency synthesizer calibration. */
+#define REG_TEST2                       0x2C                                        /**< First register lost in SLEEP. */
+
+/**@brief Reset values of the configuration registers, from the CC1101 datasheet. */
+static uint8_t const m_reset_values[CC1101_CFG_REG_COUNT] =
+{
+    0x29, 0x2E, 0x3F, 0x07, 0xD3, 0x91, 0xFF, 0x04,                                 // IOCFG2 .. PKTCTRL1
+    0x45, 0x00, 0x00, 0x0F, 0x00, 0x1E, 0xC4, 0xEC,                                 // PKTCTRL0 .. FREQ0
+    0x8C, 0x22, 0x02, 0x22, 0xF8, 0x47, 0x07, 0x30,                                 // MDMCFG4 .. MCSM1
+    0x04, 0x36, 0x6C, 0x03, 0x40, 0x91, 0x87, 0x6B,                                 // MCSM0 .. WOREVT0
+    0xF8, 0x56, 0x10, 0xA9, 0x0A, 0x20, 0x0D, 0x41,                                 // WORCTRL .. RCCTRL1
+    0x00, 0x59, 0x7F, 0x3F, 0x88, 0x31, 0x0B                                        // RCCTRL0 .. TEST0
+};
+
+/**@brief Reset values of the PATABLE. */
+static uint8_t const m_patable_reset_values[CC1101_PATABLE_LEN] =
+{
+    0xC6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+
+static __INLINE bool is_dirty(cc1101_shadow_t const * p_shadow, uint8_t index)
+{
+    return ((p_shadow->dirty[index / 8] & (1 << (index % 8))) != 0);
+}
+
+
+static __INLINE void dirty_set(cc1101_shadow_t * p_shadow, uint8_t index)
+{
+    p_shadow->dirty[index / 8] |= (1 << (index % 8));
+}
+
+
+static __INLINE void dirty_clear(cc1101_shadow_t * p_shadow, uint8_t index)
+{
+    p_shadow->dirty[index / 8] &= ~(1 << (index % 8));
+}
+
+
+/**@brief Function for getting the bits of a configuration register that are not written by the chip.
+ */
+static uint8_t verify_mask(uint8_t addr)
+{
+    switch (addr)
+    {
+        case REG_FSCAL3:
+            return 0xF0;                                                            // FSCAL3[3:0] is a calibration result.
+
+        case REG_FSCAL2:
+            return 0x20;                                                            // FSCAL2[4:0] is a calibration result.
+
+        case REG_FSCAL1:
+            return 0x00;                                                            // Calibration result.
+
+        default:
+            return 0xFF;
+    }
+}
+
+
+void cc1101_shadow_init(cc1101_shadow_t * p_shadow, cc1101_shadow_write_t write, cc1101_shadow_read_t read)
+{
+    memset(p_shadow, 0, sizeof(*p_shadow));
+    memcpy(p_shadow->values, m_reset_values, sizeof(m_reset_values));
+    memcpy(&p_shadow->values[CC1101_SHADOW_PATABLE(0)], m_patable_reset_values, sizeof(m_patable_reset_values));
+    p_shadow->write = write;
+    p_shadow->read  = read;
+
+    cc1101_shadow_invalidate(p_shadow);
+}
+
+
+void cc1101_shadow_set(cc1101_shadow_t * p_shadow, uint8_t index, uint8_t value)
+{
+    if ((index >= CC1101_SHADOW_SIZE) || (p_shadow->values[index] == value))
+    {
+        return;
+    }
+
+    p_shadow->values[index] = value;
+    dirty_set(p_shadow, index);
+}
+
+
+void cc1101_shadow_set_list(cc1101_shadow_t * p_shadow, cc1101_reg_t const * p_regs, uint8_t count)
+{
+    uint8_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        cc1101_shadow_set(p_shadow, p_regs[i].addr, p_regs[i].value);
+    }
+}
+
+
+uint8_t cc1101_shadow_get(cc1101_shadow_t const * p_shadow, uint8_t index)
+{
+    return (index < CC1101_SHADOW_SIZE) ? p_shadow->values[index] : 0;
+}
+
+
+void cc1101_shadow_invalidate(cc1101_shadow_t * p_shadow)
+{
+    uint8_t i;
+
+    for (i = 0; i < CC1101_SHADOW_SIZE; i++)
+    {
+        dirty_set(p_shadow, i);
+    }
+}
+
+
+void cc1101_shadow_on_sleep(cc1101_shadow_t * p_shadow)
+{
+    uint8_t i;
+
+    for (i = REG_TEST2; i < CC1101_CFG_REG_COUNT; i++)
+    {
+        dirty_set(p_shadow, i);
+    }
+    for (i = 1; i < CC1101_PATABLE_LEN; i++)
+    {
+        dirty_set(p_shadow, CC1101_SHADOW_PATABLE(i));
+    }
+}
+
+
+bool cc1101_shadow_is_dirty(cc1101_shadow_t const * p_shadow)
+{
+    uint8_t i;
+
+    for (i = 0; i < sizeof(p_shadow->dirty); i++)
+    {
+        if (p_shadow->dirty[i] != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+uint16_t cc1101_shadow_flush(cc1101_shadow_t * p_shadow)
+{
+    uint16_t bytes = 0;
+    uint8_t  start;
+    uint8_t  end;
+    uint8_t  i;
+
+    // Configuration registers, as runs of dirty registers. A single clean register between two
+    // dirty ones is rewritten rather than starting a new burst.
+    start = 0;
+    while (start < CC1101_CFG_REG_COUNT)
+    {
+        if (!is_dirty(p_shadow, start))
+        {
+            start++;
+            continue;
+        }
+
+        end = start + 1;
+        while (end < CC1101_CFG_REG_COUNT)
+        {
+            if (is_dirty(p_shadow, end))
+            {
+                end++;
+            }
+            else if ((end + 1 < CC1101_CFG_REG_COUNT) && is_dirty(p_shadow, end + 1))
+            {
+                end += 2;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        p_shadow->write(start, &p_shadow->values[start], end - start);
+        p_shadow->stats.bursts++;
+        p_shadow->stats.regs_written += end - start;
+        bytes += 1 + end - start;
+
+        for (i = start; i < end; i++)
+        {
+            dirty_clear(p_shadow, i);
+        }
+        start = end;
+    }
+
+    // The PATABLE index restarts at 0 with every burst, so write up to the last dirty entry.
+    end = 0;
+    for (i = 0; i < CC1101_PATABLE_LEN; i++)
+    {
+        if (is_dirty(p_shadow, CC1101_SHADOW_PATABLE(i)))
+        {
+            end = i + 1;
+        }
+    }
+    if (end > 0)
+    {
+        p_shadow->write(CC1101_PATABLE, &p_shadow->values[CC1101_SHADOW_PATABLE(0)], end);
+        p_shadow->stats.bursts++;
+        p_shadow->stats.regs_written += end;
+        bytes += 1 + end;
+
+        for (i = 0; i < end; i++)
+        {
+            dirty_clear(p_shadow, CC1101_SHADOW_PATABLE(i));
+        }
+    }
+
+    if (bytes > 0)
+    {
+        p_shadow->stats.flushes++;
+    }
+    return bytes;
+}
+
+
+uint32_t cc1101_shadow_verify(cc1101_shadow_t * p_shadow, uint8_t * p_first_diff)
+{
+    uint8_t  chip[CC1101_SHADOW_SIZE];
+    uint8_t  mask;
+    uint8_t  i;
+    uint32_t err_code = NRF_SUCCESS;
+
+    p_shadow->read(0x00, chip, CC1101_CFG_REG_COUNT);
+    p_shadow->read(CC1101_PATABLE, &chip[CC1101_SHADOW_PATABLE(0)], CC1101_PATABLE_LEN);
+
+    for (i = 0; i < CC1101_SHADOW_SIZE; i++)
+    {
+        if (is_dirty(p_shadow, i))
+        {
+            continue;
+        }
+
+        mask = (i < CC1101_CFG_REG_COUNT) ? verify_mask(i) : 0xFF;
+        if (((chip[i] ^ p_shadow->values[i]) & mask) != 0)
+        {
+            if ((err_code == NRF_SUCCESS) && (p_first_diff != NULL))
+            {
+                *p_first_diff = i;
+            }
+            p_shadow->stats.verify_errors++;
+            err_code = NRF_ERROR_INVALID_DATA;
+        }
+    }
+
+    return err_code;
+}
@@ -0,0 +1,120 @@
+/** @file
+ *
+ * @defgroup cc1101_shadow CC1101 shadow registers
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    RAM copy of the CC1101 configuration, written to the chip as a minimal set of bursts.
+ *
+ * @details The shadow holds the 47 configuration registers (0x00 to 0x2E) and the 8 PATABLE entries,
+ *          starting from their reset values, plus a dirty bit per entry. Changing a value with
+ *          @ref cc1101_shadow_set only marks it dirty when it differs from the shadow, and
+ *          @ref cc1101_shadow_flush writes the dirty entries as burst runs. Runs separated by a
+ *          single clean register are merged, as rewriting that register costs one byte, the same as
+ *          the header of a new burst. A new profile that differs in a few registers therefore costs
+ *          a few SPI bytes.
+ *
+ *          After SRES everything is marked dirty (@ref cc1101_shadow_invalidate) and the next flush
+ *          rewrites the whole configuration in two bursts. After SPWD only the registers the chip
+ *          loses in SLEEP (TEST2 to TEST0, PATABLE entries 1 to 7) are marked dirty
+ *          (@ref cc1101_shadow_on_sleep).
+ *
+ *          @ref cc1101_shadow_verify reads the chip back and compares it with the shadow, ignoring
+ *          the bits the frequency synthesizer calibration writes to FSCAL3 to FSCAL1.
+ */
+
+#ifndef CC1101_SHADOW_H__
+#define CC1101_SHADOW_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cc1101.h"
+
+#define CC1101_CFG_REG_COUNT            0x2F                                        /**< Number of configuration registers, 0x00 to 0x2E. */
+#define CC1101_PATABLE_LEN              8                                           /**< Number of PATABLE entries. */
+#define CC1101_SHADOW_SIZE              (CC1101_CFG_REG_COUNT + CC1101_PATABLE_LEN) /**< Number of shadowed values. */
+#define CC1101_SHADOW_PATABLE(index)    (CC1101_CFG_REG_COUNT + (index))            /**< Shadow index of a PATABLE entry. */
+
+/**@brief Register address and value, see @ref cc1101_shadow_set_list. */
+typedef struct
+{
+    uint8_t addr;                                                                   /**< Configuration register address, or @ref CC1101_SHADOW_PATABLE. */
+    uint8_t value;                                                                  /**< Value. */
+} cc1101_reg_t;
+
+/**@brief Function for writing consecutive registers, starting at a register or PATABLE address. */
+typedef void (*cc1101_shadow_write_t)(uint8_t addr, uint8_t const * p_data, uint8_t length);
+
+/**@brief Function for reading consecutive registers, starting at a register or PATABLE address. */
+typedef void (*cc1101_shadow_read_t)(uint8_t addr, uint8_t * p_data, uint8_t length);
+
+/**@brief Shadow statistics. */
+typedef struct
+{
+    uint32_t flushes;                                                               /**< Flushes that wrote at least one register. */
+    uint32_t regs_written;                                                          /**< Registers written, including merged clean ones. */
+    uint32_t bursts;                                                                /**< Bursts written. */
+    uint32_t verify_errors;                                                         /**< Registers found different from the shadow. */
+} cc1101_shadow_stats_t;
+
+/**@brief Shadow instance. */
+typedef struct
+{
+    uint8_t               values[CC1101_SHADOW_SIZE];                               /**< Values the chip holds once the dirty ones are written. */
+    uint8_t               dirty[(CC1101_SHADOW_SIZE + 7) / 8];                      /**< One bit per value. */
+    cc1101_shadow_write_t write;                                                    /**< Burst write to the chip. */
+    cc1101_shadow_read_t  read;                                                     /**< Burst read from the chip. */
+    cc1101_shadow_stats_t stats;                                                    /**< Statistics. */
+} cc1101_shadow_t;
+
+/**@brief Function for initializing the shadow with the reset values, all dirty.
+ *
+ * @param[out] p_shadow  Shadow.
+ * @param[in]  write     Burst write to the chip.
+ * @param[in]  read      Burst read from the chip.
+ */
+void cc1101_shadow_init(cc1101_shadow_t * p_shadow, cc1101_shadow_write_t write, cc1101_shadow_read_t read);
+
+/**@brief Function for setting one value.
+ *
+ * @param[in] p_shadow  Shadow.
+ * @param[in] index     Register address, or @ref CC1101_SHADOW_PATABLE.
+ * @param[in] value     Value.
+ */
+void cc1101_shadow_set(cc1101_shadow_t * p_shadow, uint8_t index, uint8_t value);
+
+/**@brief Function for setting a list of values, e.g. a radio profile. */
+void cc1101_shadow_set_list(cc1101_shadow_t * p_shadow, cc1101_reg_t const * p_regs, uint8_t count);
+
+/**@brief Function for getting the value the chip holds, or will hold after the next flush. */
+uint8_t cc1101_shadow_get(cc1101_shadow_t const * p_shadow, uint8_t index);
+
+/**@brief Function for marking every value dirty, after the chip was reset. */
+void cc1101_shadow_invalidate(cc1101_shadow_t * p_shadow);
+
+/**@brief Function for marking dirty the values the chip loses in SLEEP, after SPWD. */
+void cc1101_shadow_on_sleep(cc1101_shadow_t * p_shadow);
+
+/**@brief Function for checking whether a flush would write anything. */
+bool cc1101_shadow_is_dirty(cc1101_shadow_t const * p_shadow);
+
+/**@brief Function for writing the dirty values to the chip.
+ *
+ * @return Number of SPI bytes written, headers included.
+ */
+uint16_t cc1101_shadow_flush(cc1101_shadow_t * p_shadow);
+
+/**@brief Function for comparing the chip with the shadow.
+ *
+ * @details Dirty values are not compared.
+ *
+ * @param[in]  p_shadow      Shadow.
+ * @param[out] p_first_diff  Shadow index of the first mismatch, may be NULL.
+ *
+ * @retval NRF_SUCCESS            The chip matches the shadow.
+ * @retval NRF_ERROR_INVALID_DATA At least one register differs.
+ */
+uint32_t cc1101_shadow_verify(cc1101_shadow_t * p_shadow, uint8_t * p_first_diff);
+
+#endif // CC1101_SHADOW_H__
+
+/** @} */
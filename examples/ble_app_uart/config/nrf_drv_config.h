@@ -125,7 +125,7 @@
 #define SPI0_ENABLED 1
 
 #if (SPI0_ENABLED == 1)
-#define SPI0_USE_EASY_DMA 1
+#define SPI0_USE_EASY_DMA 0                 /* the nRF51 SPI master has no EasyDMA */
 
 #define SPI0_CONFIG_SCK_PIN         2
 #define SPI0_CONFIG_MOSI_PIN        3
@@ -0,0 +1,105 @@
+/** @file
+ *
+ * @brief CPU duty cycle implementation.
+ */
+
+#include "cpu_load.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "nrf_gpio.h"
+#include "ctrl.h"
+
+static cpu_load_stats_t m_stats;                                                    /**< Statistics. */
+static uint64_t         m_active_ticks;                                             /**< RTC1 ticks spent awake. */
+static uint64_t         m_sleep_ticks;                                              /**< RTC1 ticks spent in sd_app_evt_wait. */
+static uint32_t         m_mark_ticks;                                               /**< RTC1 counter at the last transition between awake and asleep. */
+
+
+/**@brief Function for accumulating the time since the last transition and starting a new one. */
+static void mark(uint64_t * p_total)
+{
+    uint32_t now;
+    uint32_t diff;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_mark_ticks, &diff));
+    *p_total    += diff;
+    m_mark_ticks = now;
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_CPU.
+ */
+static uint8_t cpu_load_stats_get(uint8_t * p_buf)
+{
+    uint64_t total;
+
+    // Bring the active time up to now, the caller is awake.
+    mark(&m_active_ticks);
+
+    // The 32 bit totals of the page wrap after about 36 hours, the duty comes from the 64 bit ones.
+    total                 = m_active_ticks + m_sleep_ticks;
+    m_stats.active_ticks  = (uint32_t)m_active_ticks;
+    m_stats.sleep_ticks   = (uint32_t)m_sleep_ticks;
+    m_stats.duty_permille = (total == 0) ? 0 : (uint16_t)((m_active_ticks * 1000) / total);
+
+    memcpy(p_buf, &m_stats, sizeof(m_stats));
+    return sizeof(m_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_CPU.
+ */
+static void cpu_load_stats_clear(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_active_ticks = 0;
+    m_sleep_ticks  = 0;
+    UNUSED_VARIABLE(app_timer_cnt_get(&m_mark_ticks));
+}
+
+
+void cpu_load_init(void)
+{
+    uint32_t err_code;
+
+    cpu_load_stats_clear();
+
+#ifdef CPU_LOAD_PIN
+    nrf_gpio_cfg_output(CPU_LOAD_PIN);
+    nrf_gpio_pin_set(CPU_LOAD_PIN);
+#endif
+
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_CPU, cpu_load_stats_get, cpu_load_stats_clear);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+void cpu_load_ticks_get(uint32_t * p_active, uint32_t * p_sleep)
+{
+    // The caller is awake.
+    mark(&m_active_ticks);
+    *p_active = (uint32_t)m_active_ticks;
+    *p_sleep  = (uint32_t)m_sleep_ticks;
+}
+
+
+void cpu_load_sleep_enter(void)
+{
+#ifdef CPU_LOAD_PIN
+    nrf_gpio_pin_clear(CPU_LOAD_PIN);
+#endif
+    mark(&m_active_ticks);
+}
+
+
+void cpu_load_sleep_exit(void)
+{
+    mark(&m_sleep_ticks);
+    m_stats.wakeups++;
+#ifdef CPU_LOAD_PIN
+    nrf_gpio_pin_set(CPU_LOAD_PIN);
+#endif
+}
@@ -0,0 +1,55 @@
+/** @file
+ *
+ * @defgroup cpu_load CPU duty cycle
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Time the application spends awake versus waiting in sd_app_evt_wait.
+ *
+ * @details The main loop calls @ref cpu_load_sleep_enter right before sd_app_evt_wait and
+ *          @ref cpu_load_sleep_exit right after it. The RTC1 counter is sampled on both sides and the
+ *          differences are accumulated as active and sleep time, so the counter wrapping (every 512
+ *          seconds at prescaler 0) is harmless as long as the CPU wakes up more often than that.
+ *          Time spent in the SoftDevice while the application waits counts as sleep.
+ *
+ *          The totals are kept in 64 bits and read from @ref CTRL_STATS_PAGE_CPU, where the tick
+ *          counts wrap after about 36 hours but the duty cycle does not. With CPU_LOAD_PIN defined,
+ *          the pin is also driven high while the application is awake, for a logic analyzer or a
+ *          scope.
+ */
+
+#ifndef CPU_LOAD_H__
+#define CPU_LOAD_H__
+
+#include <stdint.h>
+
+/**@brief CPU duty cycle statistics. */
+typedef struct
+{
+    uint32_t active_ticks;                                                          /**< RTC1 ticks spent awake, low 32 bits. */
+    uint32_t sleep_ticks;                                                           /**< RTC1 ticks spent in sd_app_evt_wait, low 32 bits. */
+    uint32_t wakeups;                                                               /**< Number of times sd_app_evt_wait returned. */
+    uint16_t duty_permille;                                                         /**< Awake over the total, in 1/1000, from 64 bit totals. Computed when read. */
+} cpu_load_stats_t;
+
+/**@brief Function for initializing the duty cycle accounting.
+ *
+ * @details Registers @ref CTRL_STATS_PAGE_CPU. Requires app_timer to be initialized.
+ */
+void cpu_load_init(void);
+
+/**@brief Function for getting the time spent awake and asleep, up to now.
+ *
+ * @param[out] p_active  RTC1 ticks awake, as in @ref CTRL_STATS_PAGE_CPU. Wraps, compare two reads.
+ * @param[out] p_sleep   RTC1 ticks in sd_app_evt_wait. Wraps as well.
+ */
+void cpu_load_ticks_get(uint32_t * p_active, uint32_t * p_sleep);
+
+/**@brief Function for marking the start of a sleep. */
+void cpu_load_sleep_enter(void);
+
+/**@brief Function for marking the end of a sleep. */
+void cpu_load_sleep_exit(void);
+
+#endif // CPU_LOAD_H__
+
+/** @} */
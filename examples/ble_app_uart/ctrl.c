@@ -0,0 +1,140 @@
+/** @file
+ *
+ * @brief Control channel implementation.
+ */
+
+#include "ctrl.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+
+/**@brief A statistics page. */
+typedef struct
+{
+    ctrl_stats_get_t   get;                                                         /**< Page reader. */
+    ctrl_stats_clear_t clear;                                                       /**< Page reset. */
+} stats_page_t;
+
+static ctrl_cmd_handler_t m_cmd_handlers[CTRL_CMD_COUNT];                           /**< Handlers of the registered commands. */
+static stats_page_t       m_stats_pages[CTRL_STATS_PAGE_COUNT];                     /**< Registered statistics pages. */
+
+
+/**@brief Function for handling @ref CTRL_CMD_PING. */
+static uint32_t cmd_ping(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    *p_rsp_len = MIN(args_len, CTRL_RSP_DATA_MAX);
+    memcpy(p_rsp, p_args, *p_rsp_len);
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_STATS_GET. */
+static uint32_t cmd_stats_get(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    if ((args_len < 1) || (p_args[0] >= CTRL_STATS_PAGE_COUNT))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (m_stats_pages[p_args[0]].get == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    *p_rsp_len = m_stats_pages[p_args[0]].get(p_rsp);
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_STATS_CLEAR. */
+static uint32_t cmd_stats_clear(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    if ((args_len < 1) || (p_args[0] >= CTRL_STATS_PAGE_COUNT))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (m_stats_pages[p_args[0]].clear == NULL)
+    {
+        return NRF_ERROR_NOT_SUPPORTED;
+    }
+
+    m_stats_pages[p_args[0]].clear();
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ctrl_cmd_register(uint8_t cmd, ctrl_cmd_handler_t handler)
+{
+    if (cmd >= CTRL_CMD_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_cmd_handlers[cmd] = handler;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ctrl_stats_page_register(uint8_t page, ctrl_stats_get_t get, ctrl_stats_clear_t clear)
+{
+    if (page >= CTRL_STATS_PAGE_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_stats_pages[page].get   = get;
+    m_stats_pages[page].clear = clear;
+    return NRF_SUCCESS;
+}
+
+
+void ctrl_on_request(uint8_t const * p_req, uint8_t req_len, ctrl_send_t send)
+{
+    uint8_t            rsp[2 + CTRL_RSP_DATA_MAX];
+    uint8_t            rsp_len = 0;
+    uint32_t           err_code;
+    ctrl_cmd_handler_t handler = NULL;
+
+    if (req_len < 1)
+    {
+        return;
+    }
+
+    switch (p_req[0])
+    {
+        case CTRL_CMD_PING:
+            handler = cmd_ping;
+            break;
+
+        case CTRL_CMD_STATS_GET:
+            handler = cmd_stats_get;
+            break;
+
+        case CTRL_CMD_STATS_CLEAR:
+            handler = cmd_stats_clear;
+            break;
+
+        default:
+            if (p_req[0] < CTRL_CMD_COUNT)
+            {
+                handler = m_cmd_handlers[p_req[0]];
+            }
+            break;
+    }
+
+    if (handler == NULL)
+    {
+        err_code = NRF_ERROR_NOT_SUPPORTED;
+    }
+    else
+    {
+        err_code = handler(&p_req[1], req_len - 1, &rsp[2], &rsp_len);
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        rsp_len = 0;
+    }
+    rsp[0] = p_req[0] | CTRL_RSP_FLAG;
+    rsp[1] = (uint8_t)err_code;
+    send(rsp, rsp_len + 2);
+}
@@ -0,0 +1,126 @@
+/** @file
+ *
+ * @defgroup ctrl Control channel
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Command channel for configuration and statistics of the bridge.
+ *
+ * @details A request is | command (1) | arguments |. Every request gets exactly one response
+ *          | command | 0x80 (1) | status (1, low byte of an NRF_ERROR code) | data |.
+ *
+ *          Modules add their own commands with @ref ctrl_cmd_register and publish their counters
+ *          as statistics pages with @ref ctrl_stats_page_register. A page is a packed structure of
+ *          little endian counters and is read with @ref CTRL_CMD_STATS_GET.
+ */
+
+#ifndef CTRL_H__
+#define CTRL_H__
+
+#include <stdint.h>
+
+#define CTRL_RSP_FLAG                   0x80                                        /**< Set in the command byte of a response. */
+#define CTRL_RSP_DATA_MAX               56                                          /**< Largest amount of data in a response. */
+
+/**@brief Commands. */
+typedef enum
+{
+    CTRL_CMD_PING        = 0x00,                                                    /**< Echo the arguments back. */
+    CTRL_CMD_STATS_GET   = 0x01,                                                    /**< Args: page. Returns the page content. */
+    CTRL_CMD_STATS_CLEAR = 0x02,                                                    /**< Args: page. Clears the counters of the page. */
+    CTRL_CMD_UART_CFG_GET = 0x03,                                                   /**< Returns framing mode (1), baud rate register (4) and flow control (1). */
+    CTRL_CMD_ROUTE_GET   = 0x04,                                                    /**< Returns the set of sinks of every source port, ROUTER_PORT_COUNT bytes per source. */
+    CTRL_CMD_ROUTE_SET   = 0x05,                                                    /**< Args: source, port, set of sinks. See @ref router. */
+    CTRL_CMD_CLASS_GET   = 0x06,                                                    /**< Args: sink. Returns the traffic class of every port. */
+    CTRL_CMD_CLASS_SET   = 0x07,                                                    /**< Args: sink, port, traffic class. */
+    CTRL_CMD_RADIO_VERIFY = 0x08,                                                   /**< Reads the CC1101 registers back. Returns 1 if they match the shadow, else 0, and the index of the first mismatch (1). */
+    CTRL_CMD_RADIO_PROFILE_GET = 0x09,                                              /**< Args: profile, optional. Returns the profile in use (1), the number of profiles (1), then carrier in Hz (4), data rate in Baud (4) and name of the requested profile, by default the one in use. */
+    CTRL_CMD_RADIO_PROFILE_SET = 0x0A,                                              /**< Args: profile. Switches the radio to it between two packets and keeps it for the next boot. See @ref radio_profile. */
+    CTRL_CMD_SPI_BENCH   = 0x0B,                                                    /**< Returns the time of a CC1101 register read polled (4) and interrupt driven (4), then of a 48 byte burst read polled (4) and interrupt driven (4), in ns. */
+    CTRL_CMD_POWER_GET   = 0x0C,                                                    /**< Returns the wake latency budget in us (2) and the state of the CC1101 (1). See @ref power_mgr. */
+    CTRL_CMD_POWER_SET   = 0x0D,                                                    /**< Args: wake latency budget in us (2), 0 to keep the radio in RX. Kept for the next boot. */
+    CTRL_CMD_SLOT_GET    = 0x0E,                                                    /**< Returns the longest slot period in ms (2), 0 if slots are off, and the role (1). See @ref slot_sync. */
+    CTRL_CMD_SLOT_SET    = 0x0F,                                                    /**< Args: longest slot period in ms (2), 0 to turn slots off. Kept for the next boot. */
+    CTRL_CMD_ENERGY_GET  = 0x10,                                                    /**< Returns the current of every state in nA (4 each), in the order of @ref energy_state_t. */
+    CTRL_CMD_ENERGY_SET  = 0x11,                                                    /**< Args: state (1), current in nA (4). Kept for the next boot. See @ref energy. */
+    CTRL_CMD_COUNT                                                                  /**< Number of command slots. */
+} ctrl_cmd_t;
+
+/**@brief Statistics pages. */
+typedef enum
+{
+    CTRL_STATS_PAGE_UART = 0,                                                       /**< UART framing and UART->BLE uplink. */
+    CTRL_STATS_PAGE_ROUTER = 1,                                                     /**< Packets queued and dropped per endpoint. */
+    CTRL_STATS_PAGE_RADIO_SCHED = 2,                                                /**< Packets sent, latency and preemptions per radio traffic class. */
+    CTRL_STATS_PAGE_LINK = 3,                                                       /**< Radio link credits and NUS write overruns. */
+    CTRL_STATS_PAGE_CPU = 4,                                                        /**< CPU duty cycle, see @ref cpu_load. */
+    CTRL_STATS_PAGE_RADIO = 5,                                                      /**< CC1101 packets, CRC errors, FIFO errors, timeouts and SPI accesses. */
+    CTRL_STATS_PAGE_KV = 6,                                                         /**< Flash records and erases of the key/value store, see @ref kv. */
+    CTRL_STATS_PAGE_FLASH = 7,                                                      /**< Flash operations started and held back for the radio, see @ref flash_sched. */
+    CTRL_STATS_PAGE_BLE_TIMELINE = 8,                                               /**< BLE radio event jitter and radio work fitted between the events, see @ref ble_timeline. */
+    CTRL_STATS_PAGE_ISR = 9,                                                        /**< Runs and execution time per interrupt handler, see @ref isr_prof. Only with ISR_PROF_ENABLED. */
+    CTRL_STATS_PAGE_POWER = 10,                                                     /**< Time in every CC1101 state and wakes, see @ref power_mgr. */
+    CTRL_STATS_PAGE_STANDBY = 11,                                                   /**< Standby periods, wakes and wake to first packet latency, see @ref standby. */
+    CTRL_STATS_PAGE_RADIO_TS = 12,                                                  /**< Airtime, RX FIFO read delay and TX start delay from the GDO0 timestamps, see @ref radio_ts. */
+    CTRL_STATS_PAGE_SLOT = 13,                                                      /**< Role, period, guard time, clock drift and beacons of the radio slots, see @ref slot_sync. */
+    CTRL_STATS_PAGE_ENERGY = 14,                                                    /**< Time in every CC1101 and nRF51 state, estimated charge and energy per byte, see @ref energy. */
+    CTRL_STATS_PAGE_RECOVERY = 15,                                                  /**< CC1101 recoveries per cause, their duration and the last crash, see @ref recovery. */
+    CTRL_STATS_PAGE_COUNT                                                           /**< Number of statistics pages. */
+} ctrl_stats_page_t;
+
+/**@brief Command handler.
+ *
+ * @param[in]    p_args     Arguments following the command byte.
+ * @param[in]    args_len   Length of the arguments.
+ * @param[out]   p_rsp      Response data, at most @ref CTRL_RSP_DATA_MAX bytes.
+ * @param[inout] p_rsp_len  In: 0. Out: number of bytes written to p_rsp.
+ *
+ * @return NRF_SUCCESS or an NRF_ERROR code which is returned in the status byte.
+ */
+typedef uint32_t (*ctrl_cmd_handler_t)(uint8_t const * p_args,
+                                       uint8_t         args_len,
+                                       uint8_t *       p_rsp,
+                                       uint8_t *       p_rsp_len);
+
+/**@brief Statistics page reader.
+ *
+ * @param[out] p_buf  Buffer of @ref CTRL_RSP_DATA_MAX bytes.
+ *
+ * @return Number of bytes written to p_buf.
+ */
+typedef uint8_t (*ctrl_stats_get_t)(uint8_t * p_buf);
+
+/**@brief Statistics page reset. */
+typedef void (*ctrl_stats_clear_t)(void);
+
+/**@brief Function for sending a response back to where the request came from. */
+typedef void (*ctrl_send_t)(uint8_t const * p_data, uint8_t length);
+
+/**@brief Function for registering a command handler.
+ *
+ * @retval NRF_SUCCESS             Handler registered.
+ * @retval NRF_ERROR_INVALID_PARAM Unknown command.
+ */
+uint32_t ctrl_cmd_register(uint8_t cmd, ctrl_cmd_handler_t handler);
+
+/**@brief Function for registering a statistics page.
+ *
+ * @param[in] page      Page number.
+ * @param[in] get       Page reader.
+ * @param[in] clear     Page reset, may be NULL.
+ *
+ * @retval NRF_SUCCESS             Page registered.
+ * @retval NRF_ERROR_INVALID_PARAM Unknown page.
+ */
+uint32_t ctrl_stats_page_register(uint8_t page, ctrl_stats_get_t get, ctrl_stats_clear_t clear);
+
+/**@brief Function for executing a request and sending its response.
+ *
+ * @param[in] p_req     Request.
+ * @param[in] req_len   Request length.
+ * @param[in] send      Function used to send the response.
+ */
+void ctrl_on_request(uint8_t const * p_req, uint8_t req_len, ctrl_send_t send);
+
+#endif // CTRL_H__
+
+/** @} */
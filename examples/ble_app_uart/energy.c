@@ -0,0 +1,241 @@
+/** @file
+ *
+ * @brief Energy accounting implementation.
+ */
+
+#include "energy.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "SEGGER_RTT.h"
+#include "ctrl.h"
+#include "kv.h"
+#include "power_mgr.h"
+#include "cpu_load.h"
+#include "ble_timeline.h"
+
+#define ENERGY_TICKS_TO_MS(ticks)       (((uint64_t)(ticks) * 1000) / APP_TIMER_CLOCK_FREQ) /**< RTC1 ticks to ms, app_timer runs RTC1 without prescaler. */
+#define ENERGY_GROWTH_MAX               (1UL << 24)                                 /**< Longest time between two updates in RTC1 ticks, the RTC1 wrap. */
+
+STATIC_ASSERT(sizeof(energy_stats_t) <= CTRL_RSP_DATA_MAX);
+STATIC_ASSERT(sizeof(uint32_t) * ENERGY_STATE_COUNT <= KV_VALUE_MAX);
+STATIC_ASSERT(ENERGY_CC1101_SLEEP - ENERGY_CC1101_RX == POWER_MGR_SLEEP - POWER_MGR_RX);
+
+/**@brief Names printed, in the order of @ref energy_state_t. */
+static char const * const m_names[ENERGY_STATE_COUNT] =
+{
+    "rx",
+    "tx",
+    "idle",
+    "xoff",
+    "sleep",
+    "cpu",
+    "ble",
+    "cpu_idle",
+};
+
+/**@brief Default current of every state in nA, in the order of @ref energy_state_t. */
+static uint32_t const m_current_defaults[ENERGY_STATE_COUNT] =
+{
+    15000000,                                                                       // CC1101 RX, 868 MHz, 250 kBaud.
+    30000000,                                                                       // CC1101 TX, PATABLE 0xC6.
+    1700000,                                                                        // CC1101 IDLE.
+    165000,                                                                         // CC1101 XOFF.
+    200,                                                                            // CC1101 SLEEP.
+    4400000,                                                                        // nRF51 CPU from flash, 16 MHz.
+    13000000,                                                                       // nRF51 radio, average of RX and TX at 0 dBm.
+    2600,                                                                           // nRF51 System ON idle, RTC running.
+};
+
+static energy_stats_t m_stats;                                                      /**< Statistics, computed when read. */
+static uint64_t       m_ticks[ENERGY_STATE_COUNT];                                  /**< RTC1 ticks spent in every state. */
+static uint64_t       m_bytes;                                                      /**< Payload bytes carried over the radio. */
+static uint32_t       m_current_na[ENERGY_STATE_COUNT];                             /**< Current of every state. */
+static uint32_t       m_last_radio[POWER_MGR_COUNT];                                /**< @ref power_mgr totals at the last update. */
+static uint32_t       m_last_active;                                                /**< @ref cpu_load awake total at the last update. */
+static uint32_t       m_last_sleep;                                                 /**< @ref cpu_load sleep total at the last update. */
+static uint32_t       m_last_ble;                                                   /**< @ref ble_timeline event total at the last update. */
+
+
+/**@brief Function for getting the growth of a total since the last update.
+ *
+ * @details The totals are 32 bit tick counts and wrap. A growth larger than the time allowed
+ *          between two updates means the total was cleared in between, it all grew since.
+ */
+static uint32_t growth(uint32_t total, uint32_t * p_last)
+{
+    uint32_t diff = total - *p_last;
+
+    if (diff > ENERGY_GROWTH_MAX)
+    {
+        diff = total;
+    }
+
+    *p_last = total;
+    return diff;
+}
+
+
+/**@brief Function for computing the summary from the time in every state.
+ */
+static void summary_compute(energy_summary_t * p_summary)
+{
+    uint64_t charge_nc = 0;
+    uint64_t elapsed   = 0;                                                         // RTC1 ticks.
+    uint64_t elapsed_ms;
+    uint8_t  i;
+
+    for (i = 0; i < ENERGY_STATE_COUNT; i++)
+    {
+        // Whole seconds first, ticks times nA would overflow after months.
+        charge_nc += (m_ticks[i] / APP_TIMER_CLOCK_FREQ) * m_current_na[i] +
+                     ((m_ticks[i] % APP_TIMER_CLOCK_FREQ) * m_current_na[i]) / APP_TIMER_CLOCK_FREQ;
+    }
+    // The CC1101 is always in exactly one of its states.
+    for (i = ENERGY_CC1101_RX; i <= ENERGY_CC1101_SLEEP; i++)
+    {
+        elapsed += m_ticks[i];
+    }
+    elapsed_ms = ENERGY_TICKS_TO_MS(elapsed);
+
+    p_summary->elapsed_s    = (uint32_t)(elapsed / APP_TIMER_CLOCK_FREQ);
+    p_summary->current_na   = (elapsed_ms == 0) ? 0 : (uint32_t)((charge_nc * 1000) / elapsed_ms);
+    p_summary->charge_uc    = (uint32_t)MIN(charge_nc / 1000, UINT32_MAX);
+    p_summary->bytes        = (uint32_t)m_bytes;
+    p_summary->nj_per_byte  = (m_bytes == 0) ? 0 :
+                              (uint32_t)((charge_nc * ENERGY_SUPPLY_MV) / 1000 / m_bytes);
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_ENERGY.
+ */
+static uint8_t energy_stats_get(uint8_t * p_buf)
+{
+    uint8_t i;
+
+    energy_update();
+    for (i = 0; i < ENERGY_STATE_COUNT; i++)
+    {
+        m_stats.ms[i] = (uint32_t)ENERGY_TICKS_TO_MS(m_ticks[i]);
+    }
+    summary_compute(&m_stats.summary);
+    memcpy(p_buf, &m_stats, sizeof(m_stats));
+    return sizeof(m_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_ENERGY.
+ */
+static void energy_stats_clear(void)
+{
+    // Move the marks to now first, so that the time before the clear is dropped.
+    energy_update();
+    memset(&m_stats, 0, sizeof(m_stats));
+    memset(m_ticks, 0, sizeof(m_ticks));
+    m_bytes = 0;
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_ENERGY_GET.
+ */
+static uint32_t energy_cmd_get(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    memcpy(p_rsp, m_current_na, sizeof(m_current_na));
+    *p_rsp_len = sizeof(m_current_na);
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_ENERGY_SET.
+ */
+static uint32_t energy_cmd_set(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    if (args_len < 1 + sizeof(uint32_t))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+    if (p_args[0] >= ENERGY_STATE_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    memcpy(&m_current_na[p_args[0]], &p_args[1], sizeof(uint32_t));
+    return kv_write(KV_KEY_ENERGY_CURRENT, (uint8_t const *)m_current_na, sizeof(m_current_na));
+}
+
+
+void energy_init(void)
+{
+    uint32_t err_code;
+    uint8_t  length = sizeof(m_current_na);
+
+    if ((kv_read(KV_KEY_ENERGY_CURRENT, (uint8_t *)m_current_na, &length) != NRF_SUCCESS) ||
+        (length != sizeof(m_current_na)))
+    {
+        memcpy(m_current_na, m_current_defaults, sizeof(m_current_na));
+    }
+
+    err_code = ctrl_cmd_register(CTRL_CMD_ENERGY_GET, energy_cmd_get);
+    APP_ERROR_CHECK(err_code);
+    err_code = ctrl_cmd_register(CTRL_CMD_ENERGY_SET, energy_cmd_set);
+    APP_ERROR_CHECK(err_code);
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_ENERGY, energy_stats_get, energy_stats_clear);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+void energy_update(void)
+{
+    uint32_t active;
+    uint32_t sleep;
+    uint32_t ble;
+    uint8_t  i;
+
+    for (i = 0; i < POWER_MGR_COUNT; i++)
+    {
+        m_ticks[ENERGY_CC1101_RX + i] += growth(power_mgr_ticks_get((power_mgr_state_t)i), &m_last_radio[i]);
+    }
+
+    cpu_load_ticks_get(&active, &sleep);
+    active = growth(active, &m_last_active);
+    sleep  = growth(sleep, &m_last_sleep);
+    ble    = growth(ble_timeline_active_ticks_get(), &m_last_ble);
+
+    // The SoftDevice runs its radio events mostly while the application waits.
+    m_ticks[ENERGY_NRF_ACTIVE] += active;
+    m_ticks[ENERGY_NRF_BLE]    += ble;
+    m_ticks[ENERGY_NRF_IDLE]   += (sleep > ble) ? (sleep - ble) : 0;
+}
+
+
+void energy_on_bytes(uint32_t count)
+{
+    m_bytes += count;
+}
+
+
+void energy_summary_get(energy_summary_t * p_summary)
+{
+    energy_update();
+    summary_compute(p_summary);
+}
+
+
+void energy_report(void)
+{
+    energy_summary_t summary;
+    uint8_t          i;
+
+    energy_summary_get(&summary);
+    for (i = 0; i < ENERGY_STATE_COUNT; i++)
+    {
+        SEGGER_RTT_printf(0, "energy %s_ms %u\n", m_names[i], (uint32_t)ENERGY_TICKS_TO_MS(m_ticks[i]));
+    }
+    SEGGER_RTT_printf(0, "energy elapsed_s %u\n", summary.elapsed_s);
+    SEGGER_RTT_printf(0, "energy current_na %u\n", summary.current_na);
+    SEGGER_RTT_printf(0, "energy charge_uc %u\n", summary.charge_uc);
+    SEGGER_RTT_printf(0, "energy bytes %u\n", summary.bytes);
+    SEGGER_RTT_printf(0, "energy nj_per_byte %u\n", summary.nj_per_byte);
+}
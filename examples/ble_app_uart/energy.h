@@ -0,0 +1,92 @@
+/** @file
+ *
+ * @defgroup energy Energy accounting
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Estimated charge and energy of the bridge, from the time the CC1101 and the nRF51 spend
+ *           in each of their states and a current per state.
+ *
+ * @details The time in every state comes from the modules that already follow the states: the
+ *          CC1101 states from @ref power_mgr, the time the application is awake or waits in
+ *          sd_app_evt_wait from @ref cpu_load, and the BLE radio events from @ref ble_timeline.
+ *          The nRF51 idle time is the wait less the BLE radio events. @ref energy_update takes the
+ *          time that passed in every state since its last call, so clearing one of those pages does
+ *          not disturb the totals here. It has to run at least every 512 s, the RTC1 wrap. The
+ *          totals are kept in 64 bits, so the estimate does not wrap with the RTC1 tick counts of
+ *          those modules after 36 h.
+ *
+ *          Every state has a current, in nA, set with @ref CTRL_CMD_ENERGY_SET and kept in
+ *          @ref kv. The defaults are datasheet figures: CC1101 RX at 250 kBaud, TX at the reset
+ *          PATABLE value, nRF51 running from flash with the DC/DC converter off. The CC1101 has no
+ *          WOR state here, the power manager uses XOFF and SLEEP instead.
+ *
+ *          The charge is the sum of time times current over all states. Its average is the
+ *          charge per hour, and with the supply voltage and the payload bytes carried over the
+ *          radio, in both directions, it gives the energy per delivered byte.
+ *
+ *          Published as @ref CTRL_STATS_PAGE_ENERGY, printed on RTT channel 0 by
+ *          @ref energy_report as "energy <name> <value>", and sent as a @ref energy_summary_t by
+ *          the BLE energy characteristic, see @ref ble_energy.
+ */
+
+#ifndef ENERGY_H__
+#define ENERGY_H__
+
+#include <stdint.h>
+
+#define ENERGY_SUPPLY_MV                3000                                        /**< Supply voltage the energy is computed at. */
+
+/**@brief States accounted, CC1101 first in the order of @ref power_mgr_state_t. */
+typedef enum
+{
+    ENERGY_CC1101_RX,                                                               /**< CC1101 receiving. */
+    ENERGY_CC1101_TX,                                                               /**< CC1101 sending. */
+    ENERGY_CC1101_IDLE,                                                             /**< CC1101 IDLE, crystal running. */
+    ENERGY_CC1101_XOFF,                                                             /**< CC1101 crystal off. */
+    ENERGY_CC1101_SLEEP,                                                            /**< CC1101 SPWD. */
+    ENERGY_NRF_ACTIVE,                                                              /**< nRF51 CPU running the application. */
+    ENERGY_NRF_BLE,                                                                 /**< nRF51 in a BLE radio event of the SoftDevice. */
+    ENERGY_NRF_IDLE,                                                                /**< nRF51 in System ON idle. */
+    ENERGY_STATE_COUNT                                                              /**< Number of states. */
+} energy_state_t;
+
+/**@brief Summary of the estimate, little endian. */
+typedef struct
+{
+    uint32_t elapsed_s;                                                             /**< Time accounted. */
+    uint32_t current_na;                                                            /**< Average current, the charge per hour in nAh. */
+    uint32_t charge_uc;                                                             /**< Charge used, stays at UINT32_MAX after 4295 C, current_na times elapsed_s goes on. */
+    uint32_t bytes;                                                                 /**< Payload bytes sent and received over the radio, low 32 bits. */
+    uint32_t nj_per_byte;                                                           /**< Energy per delivered byte, 0 before the first one. */
+} energy_summary_t;
+
+/**@brief Content of @ref CTRL_STATS_PAGE_ENERGY. */
+typedef struct
+{
+    uint32_t         ms[ENERGY_STATE_COUNT];                                        /**< Time spent in every state, in ms, wraps after 49 days. */
+    energy_summary_t summary;                                                       /**< Estimate from them. */
+} energy_stats_t;
+
+/**@brief Function for initializing the accounting, reading the currents from @ref kv and
+ *        registering @ref CTRL_CMD_ENERGY_GET, @ref CTRL_CMD_ENERGY_SET and
+ *        @ref CTRL_STATS_PAGE_ENERGY.
+ *
+ * @details The key/value store must be initialized. Time is accounted from the start of RTC1.
+ */
+void energy_init(void);
+
+/**@brief Function for adding the time since the last call to every state. */
+void energy_update(void);
+
+/**@brief Function for counting payload bytes carried over the radio. */
+void energy_on_bytes(uint32_t count);
+
+/**@brief Function for getting the estimate, up to now. */
+void energy_summary_get(energy_summary_t * p_summary);
+
+/**@brief Function for printing the time in every state and the estimate on RTT channel 0. */
+void energy_report(void);
+
+#endif // ENERGY_H__
+
+/** @} */
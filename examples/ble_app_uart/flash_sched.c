@@ -0,0 +1,161 @@
+/** @file
+ *
+ * @brief Flash scheduler implementation.
+ */
+
+#include "flash_sched.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "nrf_soc.h"
+#include "app_error.h"
+#include "app_util.h"
+#include "ctrl.h"
+
+STATIC_ASSERT(sizeof(flash_sched_stats_t) <= CTRL_RSP_DATA_MAX);
+STATIC_ASSERT((FLASH_SCHED_CHUNK_MAX % 4) == 0);
+
+static app_timer_id_t       m_timer_id;                                             /**< Timer of the refused requests. */
+static flash_sched_gate_t   m_gate;                                                 /**< Gate of the flash operations. */
+static uint32_t             m_retry_ticks;                                          /**< Delay before a refused request is tried again. */
+static bool                 m_retry_pending;                                        /**< m_timer_id is running. */
+static bool                 m_busy;                                                 /**< A flash operation is in progress. */
+static flash_sched_user_t * mp_head;                                                /**< Oldest request. */
+static flash_sched_user_t * mp_tail;                                                /**< Newest request. */
+static flash_sched_stats_t  m_stats;                                                /**< Statistics. */
+
+
+/**@brief Function for starting the waiting requests, one flash operation at a time.
+ */
+static void flash_sched_run(void)
+{
+    flash_sched_user_t * p_user;
+    uint32_t             now;
+    uint32_t             delay;
+    uint32_t             err_code;
+
+    while (!m_busy && !m_retry_pending && (mp_head != NULL))
+    {
+        if (!m_gate(mp_head->stall_us))
+        {
+            m_stats.deferrals++;
+            m_retry_pending = true;
+            err_code = app_timer_start(m_timer_id, MAX(m_retry_ticks, APP_TIMER_MIN_TIMEOUT_TICKS), NULL);
+            APP_ERROR_CHECK(err_code);
+            return;
+        }
+
+        p_user         = mp_head;
+        mp_head        = p_user->p_next;
+        p_user->queued = false;
+        if (mp_head == NULL)
+        {
+            mp_tail = NULL;
+        }
+
+        UNUSED_VARIABLE(app_timer_cnt_get(&now));
+        UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, p_user->requested, &delay));
+        m_stats.delay_max = MAX(m_stats.delay_max, delay);
+
+        if (p_user->start(p_user))
+        {
+            m_busy = true;
+            if (p_user->op == FLASH_SCHED_OP_ERASE)
+            {
+                m_stats.erases++;
+            }
+            else
+            {
+                m_stats.writes++;
+            }
+        }
+    }
+}
+
+
+/**@brief Function for handling the timeout of the retry timer.
+ */
+static void flash_sched_timeout_handler(void * p_context)
+{
+    m_retry_pending = false;
+    flash_sched_run();
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_FLASH.
+ */
+static uint8_t flash_sched_stats_get(uint8_t * p_buf)
+{
+    memcpy(p_buf, &m_stats, sizeof(m_stats));
+    return sizeof(m_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_FLASH.
+ */
+static void flash_sched_stats_clear(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+
+uint32_t flash_sched_init(app_timer_id_t timer_id, flash_sched_gate_t gate, uint32_t retry_ticks)
+{
+    uint32_t err_code;
+
+    m_gate        = gate;
+    m_retry_ticks = retry_ticks;
+    m_timer_id    = timer_id;
+
+    err_code = app_timer_create(&m_timer_id, APP_TIMER_MODE_SINGLE_SHOT, flash_sched_timeout_handler);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    return ctrl_stats_page_register(CTRL_STATS_PAGE_FLASH, flash_sched_stats_get, flash_sched_stats_clear);
+}
+
+
+void flash_sched_request(flash_sched_user_t * p_user, flash_sched_op_t op, uint16_t size)
+{
+    p_user->op       = op;
+    p_user->stall_us = (op == FLASH_SCHED_OP_ERASE) ? FLASH_SCHED_ERASE_US : FLASH_SCHED_WRITE_US(size);
+
+    if (!p_user->queued)
+    {
+        UNUSED_VARIABLE(app_timer_cnt_get(&p_user->requested));
+        p_user->queued = true;
+        p_user->p_next = NULL;
+        if (mp_tail == NULL)
+        {
+            mp_head = p_user;
+        }
+        else
+        {
+            mp_tail->p_next = p_user;
+        }
+        mp_tail = p_user;
+    }
+
+    flash_sched_run();
+}
+
+
+void flash_sched_on_sys_evt(uint32_t sys_evt)
+{
+    switch (sys_evt)
+    {
+        case NRF_EVT_FLASH_OPERATION_ERROR:
+            m_stats.errors++;
+            // Fall through.
+
+        case NRF_EVT_FLASH_OPERATION_SUCCESS:
+            m_busy = false;
+            flash_sched_run();
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,107 @@
+/** @file
+ *
+ * @defgroup flash_sched Flash scheduler
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Admission of flash operations into the idle windows of the radio.
+ *
+ * @details A flash erase or write stalls the CPU while the SoftDevice runs it: about 22 ms per page
+ *          erase and 46 us per word written on the nRF51. If that lands while the CC1101 driver has
+ *          work due, a packet can be lost.
+ *
+ *          A module that wants to touch flash calls @ref flash_sched_request with the operation it
+ *          is about to issue. The scheduler asks the gate given to @ref flash_sched_init whether the
+ *          radio can spare the stall of that operation now. Once it can, the start function of the
+ *          module runs and issues exactly one pstorage operation. Otherwise the request waits and
+ *          is tried again after a delay. Requests are served in order, one flash operation at a time. The end of
+ *          the operation is seen by @ref flash_sched_on_sys_evt, from the system event dispatcher,
+ *          after pstorage_sys_event_handler.
+ *
+ *          A write is at most @ref FLASH_SCHED_CHUNK_MAX bytes within one page, so that every
+ *          operation stays short. A user with more to write asks for one operation per chunk.
+ */
+
+#ifndef FLASH_SCHED_H__
+#define FLASH_SCHED_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "app_timer.h"
+
+#define FLASH_SCHED_PAGE_SIZE           1024                                        /**< nRF51 flash page size. */
+#define FLASH_SCHED_CHUNK_MAX           128                                         /**< Largest write per operation, about 1.5 ms of stall. */
+#define FLASH_SCHED_ERASE_US            22300                                       /**< Stall of a page erase, nRF51 worst case. */
+#define FLASH_SCHED_WRITE_US(bytes)     (((bytes) + 3) / 4 * 47)                    /**< Stall of a write, nRF51 worst case per word, rounded up. */
+
+/**@brief Flash operations. */
+typedef enum
+{
+    FLASH_SCHED_OP_WRITE,                                                           /**< Write of at most @ref FLASH_SCHED_CHUNK_MAX bytes. */
+    FLASH_SCHED_OP_ERASE                                                            /**< Erase of one page. */
+} flash_sched_op_t;
+
+typedef struct flash_sched_user_s flash_sched_user_t;
+
+/**@brief Function issuing the flash operation of a user.
+ *
+ * @return true if a pstorage operation was issued, false if the user has nothing to do after all.
+ */
+typedef bool (*flash_sched_start_t)(flash_sched_user_t * p_user);
+
+/**@brief Function deciding whether the radio can spare a CPU stall now.
+ *
+ * @param[in] stall_us  Length of the stall.
+ */
+typedef bool (*flash_sched_gate_t)(uint32_t stall_us);
+
+/**@brief User of the scheduler. */
+struct flash_sched_user_s
+{
+    flash_sched_start_t  start;                                                     /**< Issues the flash operation. */
+    uint32_t             stall_us;                                                  /**< Stall of the operation requested. */
+    flash_sched_op_t     op;                                                        /**< Operation requested. */
+    uint32_t             requested;                                                 /**< RTC1 counter when the request was made. */
+    flash_sched_user_t * p_next;                                                    /**< Next request in the queue. */
+    bool                 queued;                                                    /**< A request is waiting. */
+};
+
+/**@brief Statistics, @ref CTRL_STATS_PAGE_FLASH. */
+typedef struct
+{
+    uint32_t erases;                                                                /**< Erases started. */
+    uint32_t writes;                                                                /**< Writes started. */
+    uint32_t deferrals;                                                             /**< Times the gate refused the next request. */
+    uint32_t delay_max;                                                             /**< Longest wait of a request, in RTC1 ticks. */
+    uint32_t errors;                                                                /**< Flash operations the SoftDevice reported as failed. */
+} flash_sched_stats_t;
+
+/**@brief Function for initializing the scheduler.
+ *
+ * @details Registers @ref CTRL_STATS_PAGE_FLASH.
+ *
+ * @param[in] timer_id     Timer defined with APP_TIMER_DEF, used by this module only.
+ * @param[in] gate         Gate of the flash operations.
+ * @param[in] retry_ticks  Delay before a request refused by the gate is tried again, in RTC1 ticks.
+ *
+ * @return NRF_SUCCESS or an error code from app_timer.
+ */
+uint32_t flash_sched_init(app_timer_id_t timer_id, flash_sched_gate_t gate, uint32_t retry_ticks);
+
+/**@brief Function for asking for a flash operation.
+ *
+ * @details The start function of the user may run before this function returns. A user has at
+ *          most one request waiting, asking again replaces the operation.
+ *
+ * @param[in] p_user  User, with its start function set.
+ * @param[in] op      Operation.
+ * @param[in] size    Bytes written, ignored for an erase.
+ */
+void flash_sched_request(flash_sched_user_t * p_user, flash_sched_op_t op, uint16_t size);
+
+/**@brief Function for handling a system event, after pstorage_sys_event_handler.
+ */
+void flash_sched_on_sys_evt(uint32_t sys_evt);
+
+#endif // FLASH_SCHED_H__
+
+/** @} */
@@ -0,0 +1,63 @@
+/** @file
+ *
+ * @defgroup cc1101_hal_mock CC1101 driver HAL for host tests
+ * @{
+ * @ingroup  cc1101
+ * @brief    Pins and SPI of the @ref cc1101 driver, on a simulated chip.
+ *
+ * @details Selected with CC1101_HAL_HEADER by the host Makefile. The functions of
+ *          @ref cc1101_hal_nrf51.h are forwarded to @ref cc1101_mock, which models the SPI
+ *          protocol of the chip: the status byte, registers, strobes and FIFOs.
+ */
+
+#ifndef CC1101_HAL_MOCK_H__
+#define CC1101_HAL_MOCK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cc1101_mock.h"
+
+/**@brief Function for configuring SS as an output, high. */
+static inline void cc1101_hal_init(void)
+{
+    cc1101_mock_ss_set(true);
+}
+
+
+/**@brief Function for pulling SS low. */
+static inline void cc1101_hal_ss_low(void)
+{
+    cc1101_mock_ss_set(false);
+}
+
+
+/**@brief Function for pulling SS high. */
+static inline void cc1101_hal_ss_high(void)
+{
+    cc1101_mock_ss_set(true);
+}
+
+
+/**@brief Function for reading SO, CHIP_RDYn while no byte is exchanged. */
+static inline bool cc1101_hal_so(void)
+{
+    return cc1101_mock_so();
+}
+
+
+/**@brief Function for waiting, while the crystal starts. */
+static inline void cc1101_hal_delay_us(uint32_t us)
+{
+    cc1101_mock_delay_us(us);
+}
+
+
+/**@brief Function for a transfer, SS is already low. */
+static inline void cc1101_hal_transfer(uint8_t const * p_tx, uint8_t * p_rx, uint16_t len)
+{
+    cc1101_mock_transfer(p_tx, p_rx, len);
+}
+
+#endif // CC1101_HAL_MOCK_H__
+
+/** @} */
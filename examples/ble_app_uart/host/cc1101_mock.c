@@ -0,0 +1,361 @@
+/** @file
+ *
+ * @brief Simulated CC1101 implementation.
+ */
+
+#include "cc1101_mock.h"
+#include <assert.h>
+#include <string.h>
+#include "cc1101.h"
+
+#define MOCK_REG_COUNT                  0x2F                                        /**< Configuration registers. */
+#define MOCK_PATABLE_SIZE               8                                           /**< PATABLE entries. */
+#define MOCK_XOSC_START_US              150                                         /**< Crystal start after SXOFF or SPWD. */
+#define MOCK_RSSI                       0x40                                        /**< RSSI byte appended to a received packet. */
+#define MOCK_LQI                        0x20                                        /**< LQI byte appended to a received packet, without CRC_OK. */
+
+/**@brief Register values after a reset, the ones the tests look at. */
+static uint8_t const m_reg_defaults[MOCK_REG_COUNT] =
+{
+    [CC1101_IOCFG2]   = 0x29,
+    [CC1101_IOCFG0]   = 0x3F,
+    [CC1101_FIFOTHR]  = 0x07,
+    [CC1101_SYNC1]    = 0xD3,
+    [CC1101_SYNC0]    = 0x91,
+    [CC1101_PKTLEN]   = 0xFF,
+    [CC1101_PKTCTRL1] = 0x04,
+    [CC1101_PKTCTRL0] = 0x45,
+    [CC1101_MCSM0]    = 0x04,
+};
+
+static uint8_t  m_regs[MOCK_REG_COUNT];                                             /**< Configuration registers. */
+static uint8_t  m_patable[MOCK_PATABLE_SIZE];                                       /**< PATABLE. */
+static uint8_t  m_patable_index;                                                    /**< Next PATABLE entry, back to 0 when SS goes high. */
+static uint8_t  m_rx_fifo[CC1101_FIFO_SIZE];                                        /**< RX FIFO, oldest byte first. */
+static uint8_t  m_rx_count;                                                         /**< Bytes in the RX FIFO. */
+static uint8_t  m_tx_fifo[CC1101_FIFO_SIZE];                                        /**< TX FIFO, oldest byte first. */
+static uint8_t  m_tx_count;                                                         /**< Bytes in the TX FIFO. */
+static uint8_t  m_state;                                                            /**< State bits of the status byte. */
+static uint8_t  m_last_strobe;                                                      /**< Last strobe received. */
+static bool     m_ss_high = true;                                                   /**< Level of SS. */
+static bool     m_xosc_off;                                                         /**< SXOFF or SPWD took effect, SS low starts the crystal. */
+static bool     m_xosc_stop;                                                        /**< SXOFF or SPWD received, takes effect when SS goes high. */
+static uint32_t m_not_ready_us;                                                     /**< Time until CHIP_RDYn goes low. */
+static uint32_t m_transfers;                                                        /**< Transfers. */
+
+
+void cc1101_mock_reset(void)
+{
+    memcpy(m_regs, m_reg_defaults, sizeof(m_regs));
+    memset(m_patable, 0, sizeof(m_patable));
+    m_patable[0]    = 0xC6;
+    m_patable_index = 0;
+    m_rx_count      = 0;
+    m_tx_count      = 0;
+    m_state         = CC1101_STATE_IDLE;
+    m_last_strobe   = 0;
+    m_ss_high       = true;
+    m_xosc_off      = false;
+    m_xosc_stop     = false;
+    m_not_ready_us  = 0;
+    m_transfers     = 0;
+}
+
+
+void cc1101_mock_not_ready(uint32_t us)
+{
+    m_not_ready_us = us;
+}
+
+
+void cc1101_mock_rx_overflow(void)
+{
+    m_state = CC1101_STATE_RXFIFO_OVERFLOW;
+}
+
+
+void cc1101_mock_rx_packet(uint8_t const * p_payload, uint8_t len, bool crc_ok)
+{
+    if (m_rx_count + 1 + len + 2 > CC1101_FIFO_SIZE)
+    {
+        m_state = CC1101_STATE_RXFIFO_OVERFLOW;
+        return;
+    }
+
+    m_rx_fifo[m_rx_count++] = len;
+    memcpy(&m_rx_fifo[m_rx_count], p_payload, len);
+    m_rx_count += len;
+    m_rx_fifo[m_rx_count++] = MOCK_RSSI;
+    m_rx_fifo[m_rx_count++] = MOCK_LQI | (crc_ok ? 0x80 : 0);
+    m_state = CC1101_STATE_IDLE;
+}
+
+
+uint8_t cc1101_mock_tx_take(uint8_t * p_buf)
+{
+    uint8_t count = m_tx_count;
+
+    memcpy(p_buf, m_tx_fifo, count);
+    m_tx_count = 0;
+    return count;
+}
+
+
+uint8_t cc1101_mock_reg(uint8_t addr)
+{
+    return m_regs[addr];
+}
+
+
+uint8_t cc1101_mock_state(void)
+{
+    return m_state;
+}
+
+
+uint8_t cc1101_mock_last_strobe(void)
+{
+    return m_last_strobe;
+}
+
+
+uint32_t cc1101_mock_transfers(void)
+{
+    return m_transfers;
+}
+
+
+bool cc1101_mock_ss(void)
+{
+    return m_ss_high;
+}
+
+
+void cc1101_mock_ss_set(bool high)
+{
+    if (high && !m_ss_high)
+    {
+        m_patable_index = 0;
+        if (m_xosc_stop)
+        {
+            m_xosc_stop = false;
+            m_xosc_off  = true;
+        }
+    }
+    else if (!high && m_ss_high && m_xosc_off)
+    {
+        m_xosc_off = false;
+        if (m_not_ready_us < MOCK_XOSC_START_US)
+        {
+            m_not_ready_us = MOCK_XOSC_START_US;
+        }
+    }
+    m_ss_high = high;
+}
+
+
+bool cc1101_mock_so(void)
+{
+    if (m_ss_high || (m_not_ready_us == 0))
+    {
+        // High impedance with SS high, the tests only look at it with SS low.
+        return m_ss_high;
+    }
+    if (m_not_ready_us != UINT32_MAX)
+    {
+        m_not_ready_us--;
+    }
+    return true;
+}
+
+
+void cc1101_mock_delay_us(uint32_t us)
+{
+    if (m_not_ready_us != UINT32_MAX)
+    {
+        m_not_ready_us = (us >= m_not_ready_us) ? 0 : (m_not_ready_us - us);
+    }
+}
+
+
+/**@brief Function for executing a strobe.
+ */
+static void strobe(uint8_t cmd)
+{
+    m_last_strobe = cmd;
+
+    switch (cmd)
+    {
+        case CC1101_SRES:
+            memcpy(m_regs, m_reg_defaults, sizeof(m_regs));
+            m_rx_count = 0;
+            m_tx_count = 0;
+            m_state    = CC1101_STATE_IDLE;
+            break;
+
+        case CC1101_SRX:
+            if (m_state == CC1101_STATE_IDLE)
+            {
+                m_state = CC1101_STATE_RX;
+            }
+            break;
+
+        case CC1101_STX:
+            if ((m_state == CC1101_STATE_IDLE) || (m_state == CC1101_STATE_RX))
+            {
+                m_state = CC1101_STATE_TX;
+            }
+            break;
+
+        case CC1101_SIDLE:
+            if ((m_state != CC1101_STATE_RXFIFO_OVERFLOW) && (m_state != CC1101_STATE_TXFIFO_UNDERFLOW))
+            {
+                m_state = CC1101_STATE_IDLE;
+            }
+            break;
+
+        case CC1101_SFRX:
+            m_rx_count = 0;
+            if (m_state == CC1101_STATE_RXFIFO_OVERFLOW)
+            {
+                m_state = CC1101_STATE_IDLE;
+            }
+            break;
+
+        case CC1101_SFTX:
+            m_tx_count = 0;
+            if (m_state == CC1101_STATE_TXFIFO_UNDERFLOW)
+            {
+                m_state = CC1101_STATE_IDLE;
+            }
+            break;
+
+        case CC1101_SXOFF:
+        case CC1101_SPWD:
+            m_xosc_stop = true;
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/**@brief Function for reading a status register.
+ */
+static uint8_t status_reg(uint8_t addr)
+{
+    switch (addr)
+    {
+        case CC1101_VERSION:
+            return 0x14;
+
+        case CC1101_MARCSTATE:
+            switch (m_state)
+            {
+                case CC1101_STATE_RX:               return CC1101_MARCSTATE_RX;
+                case CC1101_STATE_TX:               return CC1101_MARCSTATE_TX;
+                case CC1101_STATE_RXFIFO_OVERFLOW:  return CC1101_MARCSTATE_RXFIFO_OVERFLOW;
+                case CC1101_STATE_TXFIFO_UNDERFLOW: return CC1101_MARCSTATE_TXFIFO_UNDERFLOW;
+                default:                            return CC1101_MARCSTATE_IDLE;
+            }
+
+        case CC1101_TXBYTES:
+            return ((m_state == CC1101_STATE_TXFIFO_UNDERFLOW) ? 0x80 : 0) | m_tx_count;
+
+        case CC1101_RXBYTES:
+            return ((m_state == CC1101_STATE_RXFIFO_OVERFLOW) ? 0x80 : 0) | m_rx_count;
+
+        default:
+            return 0;
+    }
+}
+
+
+/**@brief Function for the byte answered to, and the effect of, data byte i of an access.
+ */
+static uint8_t data_byte(uint8_t header, uint16_t i, uint8_t tx)
+{
+    uint8_t addr  = header & 0x3F;
+    bool    read  = (header & CC1101_READ_SINGLE) != 0;
+    bool    burst = (header & CC1101_WRITE_BURST) != 0;
+    uint8_t value = 0;
+
+    if (addr == CC1101_FIFO)
+    {
+        if (!read)
+        {
+            if (m_tx_count < CC1101_FIFO_SIZE)
+            {
+                m_tx_fifo[m_tx_count++] = tx;
+            }
+            return 0x0F;
+        }
+        if (m_rx_count > 0)
+        {
+            value = m_rx_fifo[0];
+            memmove(m_rx_fifo, &m_rx_fifo[1], --m_rx_count);
+        }
+        return value;
+    }
+
+    if (addr == CC1101_PATABLE)
+    {
+        value = m_patable[m_patable_index];
+        if (!read)
+        {
+            m_patable[m_patable_index] = tx;
+        }
+        m_patable_index = (m_patable_index + 1) % MOCK_PATABLE_SIZE;
+        return value;
+    }
+
+    if (addr >= CC1101_SRES)
+    {
+        // Status registers, single byte only.
+        assert(read && burst && (i == 0));
+        return status_reg(addr);
+    }
+
+    addr += burst ? i : 0;
+    assert(addr < MOCK_REG_COUNT);
+    value = m_regs[addr];
+    if (!read)
+    {
+        m_regs[addr] = tx;
+    }
+    return value;
+}
+
+
+void cc1101_mock_transfer(uint8_t const * p_tx, uint8_t * p_rx, uint16_t len)
+{
+    uint8_t  header = p_tx[0];
+    uint8_t  addr   = header & 0x3F;
+    bool     read   = (header & CC1101_READ_SINGLE) != 0;
+    uint8_t  fifo   = read ? m_rx_count : (CC1101_FIFO_SIZE - m_tx_count);
+    uint16_t i;
+    uint8_t  tx;
+
+    // The driver only talks to a ready chip.
+    assert(!m_ss_high);
+    assert(m_not_ready_us == 0);
+    assert(len >= 1);
+    m_transfers++;
+
+    p_rx[0] = m_state | ((fifo > CC1101_STATUS_FIFO_MASK) ? CC1101_STATUS_FIFO_MASK : fifo);
+
+    if ((addr >= CC1101_SRES) && (addr <= CC1101_SNOP) && ((header & CC1101_READ_BURST) != CC1101_READ_BURST))
+    {
+        assert(len == 1);
+        strobe(addr);
+        return;
+    }
+
+    for (i = 1; i < len; i++)
+    {
+        // p_tx and p_rx may be the same buffer.
+        tx        = p_tx[i];
+        p_rx[i]   = data_byte(header, i - 1, tx);
+    }
+}
@@ -0,0 +1,73 @@
+/** @file
+ *
+ * @defgroup cc1101_mock Simulated CC1101
+ * @{
+ * @ingroup  cc1101
+ * @brief    CC1101 seen from its SPI pins, for host tests of the @ref cc1101 driver.
+ *
+ * @details Models what the driver relies on: CHIP_RDYn on SO while SS is low, the chip status
+ *          byte answered to every header, configuration and status registers, the PATABLE,
+ *          strobes and both FIFOs. The radio itself is not: a test puts received packets in the
+ *          RX FIFO and reads the TX FIFO back. Every transfer checks that SS is low.
+ */
+
+#ifndef CC1101_MOCK_H__
+#define CC1101_MOCK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**@brief Function for putting the chip back to its power-on state, ready and IDLE. */
+void cc1101_mock_reset(void);
+
+/**@brief Function for keeping CHIP_RDYn high.
+ *
+ * @param[in] us  Time until the crystal runs, counted by @ref cc1101_mock_delay_us and by every
+ *                check of SO as 1 us. UINT32_MAX for a chip that never answers.
+ */
+void cc1101_mock_not_ready(uint32_t us);
+
+/**@brief Function for putting the radio in the RX FIFO overflow state. */
+void cc1101_mock_rx_overflow(void);
+
+/**@brief Function for receiving a packet: length byte, payload, RSSI and LQI into the RX FIFO.
+ *
+ * @details The radio goes back to IDLE, as with MCSM1 set to IDLE after RX.
+ *
+ * @param[in] crc_ok  CRC_OK bit of the LQI byte.
+ */
+void cc1101_mock_rx_packet(uint8_t const * p_payload, uint8_t len, bool crc_ok);
+
+/**@brief Function for taking the TX FIFO content, the bytes the driver loaded.
+ *
+ * @return Number of bytes copied.
+ */
+uint8_t cc1101_mock_tx_take(uint8_t * p_buf);
+
+/**@brief Function for reading a configuration register without SPI. */
+uint8_t cc1101_mock_reg(uint8_t addr);
+
+/**@brief Function for getting the state bits of the chip status byte. */
+uint8_t cc1101_mock_state(void);
+
+/**@brief Function for getting the last strobe received. */
+uint8_t cc1101_mock_last_strobe(void);
+
+/**@brief Function for getting the number of transfers. */
+uint32_t cc1101_mock_transfers(void);
+
+/**@brief Function for getting the level of SS. */
+bool cc1101_mock_ss(void);
+
+/** @name HAL side, see @ref cc1101_hal_mock.
+ * @{
+ */
+void cc1101_mock_ss_set(bool high);
+bool cc1101_mock_so(void);
+void cc1101_mock_delay_us(uint32_t us);
+void cc1101_mock_transfer(uint8_t const * p_tx, uint8_t * p_rx, uint16_t len);
+/** @} */
+
+#endif // CC1101_MOCK_H__
+
+/** @} */
@@ -0,0 +1,11 @@
+/** @file
+ *
+ * @brief Host stand-in for the SDK app_util.h, only what the host build uses.
+ */
+
+#ifndef APP_UTIL_H__
+#define APP_UTIL_H__
+
+#define STATIC_ASSERT(EXPR)             _Static_assert((EXPR), #EXPR)               /**< Compile time check. */
+
+#endif // APP_UTIL_H__
@@ -0,0 +1,11 @@
+/** @file
+ *
+ * @brief Host stand-in for the SDK compiler_abstraction.h, only what the host build uses.
+ */
+
+#ifndef COMPILER_ABSTRACTION_H__
+#define COMPILER_ABSTRACTION_H__
+
+#define __INLINE                        inline                                      /**< Inline functions of the headers. */
+
+#endif // COMPILER_ABSTRACTION_H__
@@ -0,0 +1,20 @@
+/** @file
+ *
+ * @brief Host stand-in for the SDK crc16 library.
+ */
+
+#ifndef CRC16_H__
+#define CRC16_H__
+
+#include <stdint.h>
+
+/**@brief Function for calculating CRC-16 (CCITT, 0x1021, initial value 0xFFFF) in blocks, as the
+ *        SDK does.
+ *
+ * @param[in] p_data  Data.
+ * @param[in] size    Number of bytes.
+ * @param[in] p_crc   CRC of the previous block, NULL for the first one.
+ */
+uint16_t crc16_compute(uint8_t const * p_data, uint32_t size, uint16_t const * p_crc);
+
+#endif // CRC16_H__
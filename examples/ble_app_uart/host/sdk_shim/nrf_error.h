@@ -0,0 +1,17 @@
+/** @file
+ *
+ * @brief Host stand-in for the SDK nrf_error.h, same values.
+ */
+
+#ifndef NRF_ERROR_H__
+#define NRF_ERROR_H__
+
+#define NRF_ERROR_BASE_NUM              (0x0)                                       /**< Global error base. */
+
+#define NRF_SUCCESS                     (NRF_ERROR_BASE_NUM + 0)                    /**< Successful command. */
+#define NRF_ERROR_NO_MEM                (NRF_ERROR_BASE_NUM + 4)                    /**< No memory for operation. */
+#define NRF_ERROR_INVALID_PARAM         (NRF_ERROR_BASE_NUM + 7)                    /**< Invalid parameter. */
+#define NRF_ERROR_INVALID_STATE         (NRF_ERROR_BASE_NUM + 8)                    /**< Invalid state, operation disallowed in this state. */
+#define NRF_ERROR_INVALID_LENGTH        (NRF_ERROR_BASE_NUM + 9)                    /**< Invalid length. */
+
+#endif // NRF_ERROR_H__
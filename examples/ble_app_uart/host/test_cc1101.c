@@ -0,0 +1,211 @@
+/** @file
+ *
+ * @brief Host tests of the @ref cc1101 driver against @ref cc1101_mock.
+ *
+ * @details Run with "make test". Prints every failed check and returns non-zero if any failed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "cc1101.h"
+#include "cc1101_mock.h"
+
+#define CHECK(cond)                                                                                \
+    do                                                                                             \
+    {                                                                                              \
+        m_checks++;                                                                                \
+        if (!(cond))                                                                               \
+        {                                                                                          \
+            m_failures++;                                                                          \
+            printf("%s:%d: %s: check failed: %s\n", __FILE__, __LINE__, m_test, #cond);            \
+        }                                                                                          \
+    } while (0)
+
+static char const * m_test;                                                         /**< Test running. */
+static unsigned     m_checks;                                                       /**< Checks done. */
+static unsigned     m_failures;                                                     /**< Checks failed. */
+static cc1101_t     m_dev;                                                          /**< Driver under test. */
+
+
+/**@brief Function for starting a test with a fresh chip and driver.
+ */
+static void setup(char const * p_name)
+{
+    m_test = p_name;
+    cc1101_mock_reset();
+    cc1101_init(&m_dev);
+}
+
+
+static void test_register_access(void)
+{
+    uint8_t const config[3] = {0x06, 0x47, 0x07};
+    uint8_t       back[3];
+
+    setup(__func__);
+
+    CHECK(cc1101_read(&m_dev, CC1101_IOCFG0) == 0x3F);
+    CHECK(cc1101_write(&m_dev, CC1101_IOCFG0, 0x06));
+    CHECK(cc1101_mock_reg(CC1101_IOCFG0) == 0x06);
+    CHECK(cc1101_read(&m_dev, CC1101_IOCFG0) == 0x06);
+
+    CHECK(cc1101_write_burst(&m_dev, CC1101_IOCFG2, config, sizeof(config)));
+    CHECK(cc1101_read_burst(&m_dev, CC1101_IOCFG2, back, sizeof(back)));
+    CHECK(memcmp(back, config, sizeof(config)) == 0);
+
+    CHECK(cc1101_read_status(&m_dev, CC1101_VERSION) == 0x14);
+    CHECK(m_dev.accesses == 6);
+    CHECK(m_dev.rdy_timeouts == 0);
+    CHECK(cc1101_mock_ss());
+}
+
+
+static void test_status_byte(void)
+{
+    setup(__func__);
+
+    CHECK(cc1101_strobe(&m_dev, CC1101_SRX));
+    CHECK(cc1101_status_read(&m_dev, true));
+    CHECK(m_dev.state == CC1101_STATE_RX);
+    CHECK(m_dev.fifo_bytes == 0);
+
+    // TX FIFO: the status byte of a write counts free bytes, 15 meaning 15 or more.
+    CHECK(cc1101_status_read(&m_dev, false));
+    CHECK(m_dev.fifo_bytes == CC1101_STATUS_FIFO_MASK);
+
+    cc1101_mock_rx_overflow();
+    CHECK(cc1101_status_read(&m_dev, true));
+    CHECK(m_dev.rx_overflow);
+    CHECK(cc1101_strobe(&m_dev, CC1101_SFRX));
+    CHECK(!m_dev.rx_overflow);
+}
+
+
+static void test_rx_short(void)
+{
+    uint8_t const payload[5] = {1, 2, 3, 4, 5};
+    uint8_t       packet[61];
+    uint8_t       len = 0;
+
+    setup(__func__);
+
+    CHECK(cc1101_rx_read(&m_dev, packet, sizeof(packet), &len) == CC1101_RX_NONE);
+
+    cc1101_mock_rx_packet(payload, sizeof(payload), true);
+    CHECK(cc1101_rx_read(&m_dev, packet, sizeof(packet), &len) == CC1101_RX_OK);
+    CHECK(len == sizeof(payload));
+    CHECK(memcmp(packet, payload, sizeof(payload)) == 0);
+    CHECK(m_dev.fifo_bytes == sizeof(payload) + 2);
+}
+
+
+static void test_rx_long(void)
+{
+    uint8_t payload[40];
+    uint8_t packet[61];
+    uint8_t len = 0;
+    uint8_t i;
+
+    setup(__func__);
+    for (i = 0; i < sizeof(payload); i++)
+    {
+        payload[i] = i;
+    }
+
+    // Longer than the status byte counts, RXBYTES tells whether it is all there.
+    cc1101_mock_rx_packet(payload, sizeof(payload), true);
+    CHECK(cc1101_rx_read(&m_dev, packet, sizeof(packet), &len) == CC1101_RX_OK);
+    CHECK(len == sizeof(payload));
+    CHECK(memcmp(packet, payload, sizeof(payload)) == 0);
+}
+
+
+static void test_rx_errors(void)
+{
+    uint8_t const payload[8] = {0};
+    uint8_t       packet[61];
+    uint8_t       len = 0;
+
+    setup(__func__);
+
+    cc1101_mock_rx_packet(payload, sizeof(payload), false);
+    CHECK(cc1101_rx_read(&m_dev, packet, sizeof(packet), &len) == CC1101_RX_CRC_ERROR);
+
+    // Longer than the caller takes: flushed.
+    cc1101_mock_rx_packet(payload, sizeof(payload), true);
+    CHECK(cc1101_rx_read(&m_dev, packet, 4, &len) == CC1101_RX_OVERFLOW);
+    CHECK(cc1101_mock_last_strobe() == CC1101_SFRX);
+
+    cc1101_mock_rx_overflow();
+    CHECK(cc1101_rx_read(&m_dev, packet, sizeof(packet), &len) == CC1101_RX_OVERFLOW);
+    CHECK(cc1101_mock_state() == CC1101_STATE_IDLE);
+    CHECK(!m_dev.rx_overflow);
+}
+
+
+static void test_tx_start(void)
+{
+    uint8_t const packet[4] = {3, 0x10, 0x20, 0x30};
+    uint8_t       fifo[CC1101_FIFO_SIZE];
+
+    setup(__func__);
+
+    CHECK(cc1101_tx_start(&m_dev, packet, sizeof(packet)));
+    CHECK(cc1101_mock_state() == CC1101_STATE_TX);
+    CHECK(cc1101_mock_tx_take(fifo) == sizeof(packet));
+    CHECK(memcmp(fifo, packet, sizeof(packet)) == 0);
+}
+
+
+static void test_not_ready(void)
+{
+    setup(__func__);
+
+    cc1101_mock_not_ready(UINT32_MAX);
+    CHECK(!cc1101_write(&m_dev, CC1101_IOCFG0, 0x06));
+    CHECK(cc1101_read(&m_dev, CC1101_IOCFG0) == 0);
+    CHECK(m_dev.rdy_timeouts == 2);
+    CHECK(m_dev.accesses == 0);
+    CHECK(cc1101_mock_transfers() == 0);
+    CHECK(cc1101_mock_ss());
+
+    // A short wait for CHIP_RDYn is within the spins.
+    cc1101_mock_not_ready(CC1101_RDY_SPINS / 2);
+    CHECK(cc1101_write(&m_dev, CC1101_IOCFG0, 0x06));
+    CHECK(m_dev.rdy_timeouts == 2);
+}
+
+
+static void test_wake(void)
+{
+    setup(__func__);
+
+    CHECK(cc1101_strobe(&m_dev, CC1101_SXOFF));
+    CHECK(!cc1101_chip_ready(&m_dev));
+    cc1101_deselect(&m_dev);
+    CHECK(cc1101_wake(&m_dev));
+    CHECK(cc1101_mock_ss());
+    CHECK(cc1101_read(&m_dev, CC1101_IOCFG0) == 0x3F);
+
+    CHECK(cc1101_strobe(&m_dev, CC1101_SPWD));
+    cc1101_mock_not_ready(UINT32_MAX);
+    CHECK(!cc1101_wake(&m_dev));
+    CHECK(m_dev.rdy_timeouts == 1);
+    CHECK(cc1101_mock_ss());
+}
+
+
+int main(void)
+{
+    test_register_access();
+    test_status_byte();
+    test_rx_short();
+    test_rx_long();
+    test_rx_errors();
+    test_tx_start();
+    test_not_ready();
+    test_wake();
+
+    printf("%u checks, %u failed\n", m_checks, m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
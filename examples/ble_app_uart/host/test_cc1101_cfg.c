@@ -0,0 +1,224 @@
+/** @file
+ *
+ * @brief Host cross-check of the @ref cc1101_cfg register generator against the datasheet
+ *        formulas in floating point.
+ *
+ * @details Every macro is swept over the range @ref CC1101_CFG_CHECK accepts. The register value it
+ *          gives must be the one the datasheet formula, evaluated in double, says is nearest to
+ *          the request, or for the RX filter the narrowest setting at least as wide. Run with
+ *          "make test".
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "cc1101_cfg.h"
+
+#define CHECK(cond)                                                                                \
+    do                                                                                             \
+    {                                                                                              \
+        m_checks++;                                                                                \
+        if (!(cond))                                                                               \
+        {                                                                                          \
+            m_failures++;                                                                          \
+            if (m_failures <= 20)                                                                  \
+            {                                                                                      \
+                printf("%s:%d: %s: check failed at %lu: %s\n",                                     \
+                       __FILE__, __LINE__, m_test, m_param, #cond);                               \
+            }                                                                                      \
+        }                                                                                          \
+    } while (0)
+
+#define XOSC                            ((double)CC1101_XOSC_HZ)                    /**< Crystal frequency. */
+#define TOLERANCE                       1e-6                                        /**< Relative slack on the errors compared, for the rounding of ties. */
+
+static char const *  m_test;                                                        /**< Test running. */
+static unsigned long m_param;                                                       /**< Parameter checked. */
+static unsigned      m_checks;                                                      /**< Checks done. */
+static unsigned      m_failures;                                                    /**< Checks failed. */
+
+
+/**@brief Function for checking that an error is the smallest possible one, ties allowed. */
+static int is_nearest(double error, double best)
+{
+    return fabs(error) <= fabs(best) * (1 + TOLERANCE) + TOLERANCE;
+}
+
+
+static void test_frequency(void)
+{
+    static unsigned long const bands[][2] =
+    {
+        {300000000, 348000000}, {387000000, 464000000}, {779000000, 928000000}
+    };
+    unsigned long f;
+    unsigned      i;
+    unsigned long word;
+
+    m_test = __func__;
+    for (i = 0; i < sizeof(bands) / sizeof(bands[0]); i++)
+    {
+        for (f = bands[i][0]; f <= bands[i][1]; f += 99991)
+        {
+            m_param = f;
+            word    = ((unsigned long)CC1101_FREQ2(f) << 16) | (CC1101_FREQ1(f) << 8) | CC1101_FREQ0(f);
+            CHECK(word == (unsigned long)llround(f * 65536.0 / XOSC));
+            CHECK(fabs(XOSC / 65536.0 * word - f) <= XOSC / 131072.0);
+        }
+    }
+}
+
+
+static void test_data_rate(void)
+{
+    unsigned long r;
+    unsigned      e;
+    unsigned      m;
+    unsigned      be;
+    unsigned      bm;
+    double        best;
+    double        error;
+
+    m_test = __func__;
+    for (r = 600; r <= 500000; r += 1 + r / 500)
+    {
+        m_param = r;
+        e       = CC1101_DRATE_E(r);
+        m       = CC1101_DRATE_M(r);
+        CHECK((e <= 14) && (m <= 255));
+        CHECK((CC1101_MDMCFG4(58000, r) & 0x0F) == e);
+        CHECK(CC1101_MDMCFG3(r) == m);
+
+        best = INFINITY;
+        for (be = 0; be <= 14; be++)
+        {
+            for (bm = 0; bm <= 255; bm++)
+            {
+                error = XOSC / 268435456.0 * (256 + bm) * (1 << be) - r;
+                best  = (fabs(error) < fabs(best)) ? error : best;
+            }
+        }
+        CHECK(is_nearest(XOSC / 268435456.0 * (256 + m) * (1 << e) - r, best));
+    }
+}
+
+
+static void test_deviation(void)
+{
+    unsigned long d;
+    unsigned      e;
+    unsigned      m;
+    unsigned      be;
+    unsigned      bm;
+    double        best;
+    double        error;
+
+    m_test = __func__;
+    for (d = 1587; d <= 380859; d += 1 + d / 1000)
+    {
+        m_param = d;
+        e       = CC1101_DEVIATN(d) >> 4;
+        m       = CC1101_DEVIATN(d) & 0x0F;
+        CHECK((e <= 7) && (m <= 7));
+
+        best = INFINITY;
+        for (be = 0; be <= 7; be++)
+        {
+            for (bm = 0; bm <= 7; bm++)
+            {
+                error = XOSC / 131072.0 * (8 + bm) * (1 << be) - d;
+                best  = (fabs(error) < fabs(best)) ? error : best;
+            }
+        }
+        CHECK(is_nearest(XOSC / 131072.0 * (8 + m) * (1 << e) - d, best));
+    }
+}
+
+
+static void test_channel_spacing(void)
+{
+    unsigned long s;
+    unsigned      e;
+    unsigned      m;
+    unsigned      be;
+    unsigned      bm;
+    double        best;
+    double        error;
+
+    m_test = __func__;
+    for (s = 25390; s <= 405456; s += 1 + s / 1000)
+    {
+        m_param = s;
+        e       = CC1101_MDMCFG1(0, 0, s) & 0x03;
+        m       = CC1101_MDMCFG0(s);
+        CHECK(CC1101_MDMCFG1(1, 7, s) == (0xF0 | e));
+
+        best = INFINITY;
+        for (be = 0; be <= 3; be++)
+        {
+            for (bm = 0; bm <= 255; bm++)
+            {
+                error = XOSC / 262144.0 * (256 + bm) * (1 << be) - s;
+                best  = (fabs(error) < fabs(best)) ? error : best;
+            }
+        }
+        CHECK(is_nearest(XOSC / 262144.0 * (256 + m) * (1 << e) - s, best));
+    }
+}
+
+
+static void test_bandwidth(void)
+{
+    unsigned long b;
+    unsigned      k;
+    unsigned      best;
+    unsigned      bk;
+    double        bw;
+
+    m_test = __func__;
+    for (b = 58000; b <= 812500; b += 1 + b / 2000)
+    {
+        m_param = b;
+        k       = CC1101_MDMCFG4(b, 1200) >> 4;
+
+        // Narrowest setting at least as wide, the macro divides in integers: 1 Hz of slack.
+        best = 0;
+        for (bk = 0; bk <= 15; bk++)
+        {
+            bw = XOSC / (8.0 * (4 + (bk & 3)) * (1 << (bk >> 2)));
+            if (bw >= b - 1.0)
+            {
+                best = bk;
+            }
+        }
+        CHECK(k == best);
+        CHECK(XOSC / (8.0 * (4 + (k & 3)) * (1 << (k >> 2))) >= b - 1.0);
+    }
+}
+
+
+static void test_if(void)
+{
+    unsigned long f_if;
+
+    m_test = __func__;
+    for (f_if = 0; f_if <= 780000; f_if += 997)
+    {
+        m_param = f_if;
+        CHECK(CC1101_FSCTRL1(f_if) == (unsigned long)lround(f_if * 1024.0 / XOSC));
+    }
+}
+
+
+int main(void)
+{
+    test_frequency();
+    test_data_rate();
+    test_deviation();
+    test_channel_spacing();
+    test_bandwidth();
+    test_if();
+
+    printf("%u checks, %u failed\n", m_checks, m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
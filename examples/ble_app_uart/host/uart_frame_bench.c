@@ -0,0 +1,170 @@
+/** @file
+ *
+ * @brief Host throughput of the @ref uart_frame encoder and decoder.
+ *
+ * @details Encodes a set of frames of random payloads, all lengths from 1 to
+ *          @ref UART_FRAME_PAYLOAD_MAX, into one stream, then decodes the stream byte by byte as
+ *          the firmware does and checks that every frame comes back. Both are repeated and timed,
+ *          and the payload rate is compared with the 1 Mbaud UART of the binary mode.
+ *
+ *          Usage: uart_frame_bench [rounds], 2000 by default. Returns non-zero if a frame did not
+ *          come back.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "uart_frame.h"
+#include "nrf_error.h"
+
+#define BENCH_FRAMES                    256                                         /**< Frames in the stream. */
+#define BENCH_ROUNDS                    2000                                        /**< Default number of rounds. */
+#define BENCH_UART_BPS                  1000000                                     /**< Baud rate of the binary mode, 10 bits per byte. */
+
+static uint8_t  m_payloads[BENCH_FRAMES][UART_FRAME_PAYLOAD_MAX];                   /**< Payloads. */
+static uint8_t  m_lengths[BENCH_FRAMES];                                            /**< Payload lengths. */
+static uint8_t  m_stream[BENCH_FRAMES * UART_FRAME_ENCODED_MAX];                    /**< Encoded frames. */
+static uint32_t m_stream_len;                                                       /**< Bytes in m_stream. */
+static uint32_t m_payload_total;                                                    /**< Payload bytes in m_stream. */
+
+
+/**@brief Function for getting a monotonic time in seconds.
+ */
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/**@brief Function for encoding every frame into m_stream.
+ */
+static void encode_all(void)
+{
+    uint32_t i;
+    uint8_t  out_len;
+
+    m_stream_len = 0;
+    for (i = 0; i < BENCH_FRAMES; i++)
+    {
+        if (uart_frame_encode(UART_FRAME_CH_BYTE(UART_FRAME_CH_DATA, i & 3),
+                              m_payloads[i],
+                              m_lengths[i],
+                              &m_stream[m_stream_len],
+                              &out_len) != NRF_SUCCESS)
+        {
+            fprintf(stderr, "encode failed, frame %u\n", (unsigned)i);
+            exit(1);
+        }
+        m_stream_len += out_len;
+    }
+}
+
+
+/**@brief Function for decoding m_stream.
+ *
+ * @param[in] check  Compare every frame with what was encoded.
+ *
+ * @return Number of frames decoded, and checked if asked.
+ */
+static uint32_t decode_all(bool check)
+{
+    static uart_frame_decoder_t dec;
+    uint32_t                    frames = 0;
+    uint32_t                    i;
+
+    uart_frame_decoder_reset(&dec);
+    for (i = 0; i < m_stream_len; i++)
+    {
+        if (!uart_frame_decoder_put(&dec, m_stream[i]))
+        {
+            continue;
+        }
+        if (check &&
+            ((frames >= BENCH_FRAMES) ||
+             (uart_frame_channel(&dec) != UART_FRAME_CH_BYTE(UART_FRAME_CH_DATA, frames & 3)) ||
+             (uart_frame_payload_len(&dec) != m_lengths[frames]) ||
+             (memcmp(uart_frame_payload(&dec), m_payloads[frames], m_lengths[frames]) != 0)))
+        {
+            fprintf(stderr, "frame %u did not decode to what was encoded\n", (unsigned)frames);
+            return frames;
+        }
+        frames++;
+    }
+    return frames;
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t rounds = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : BENCH_ROUNDS;
+    uint32_t frames = 0;
+    uint32_t i;
+    uint32_t j;
+    double   start;
+    double   encode_s;
+    double   decode_s;
+    double   payload_mb;
+    double   uart_kbps;
+
+    if (rounds == 0)
+    {
+        rounds = 1;
+    }
+
+    // Random bytes, zeros included, so that COBS has work to do.
+    srand(1);
+    for (i = 0; i < BENCH_FRAMES; i++)
+    {
+        m_lengths[i] = 1 + (i % UART_FRAME_PAYLOAD_MAX);
+        for (j = 0; j < m_lengths[i]; j++)
+        {
+            m_payloads[i][j] = ((rand() & 7) == 0) ? 0 : (uint8_t)rand();
+        }
+        m_payload_total += m_lengths[i];
+    }
+
+    encode_all();
+    if (decode_all(true) != BENCH_FRAMES)
+    {
+        return 1;
+    }
+
+    start = now_s();
+    for (i = 0; i < rounds; i++)
+    {
+        encode_all();
+    }
+    encode_s = now_s() - start;
+
+    start = now_s();
+    for (i = 0; i < rounds; i++)
+    {
+        frames += decode_all(false);
+    }
+    decode_s = now_s() - start;
+
+    if (frames != rounds * BENCH_FRAMES)
+    {
+        fprintf(stderr, "decoded %u frames of %u\n", (unsigned)frames, (unsigned)(rounds * BENCH_FRAMES));
+        return 1;
+    }
+
+    payload_mb = (double)m_payload_total * rounds / 1e6;
+    uart_kbps  = (BENCH_UART_BPS / 10.0) * m_payload_total / m_stream_len / 1e3;
+
+    printf("frames %u, payload %u bytes, on the wire %u bytes (%.1f%% overhead)\n",
+           BENCH_FRAMES, (unsigned)m_payload_total, (unsigned)m_stream_len,
+           100.0 * (m_stream_len - m_payload_total) / m_payload_total);
+    printf("encode %.1f MB/s payload, %.0f ns per frame\n",
+           payload_mb / encode_s, encode_s * 1e9 / ((double)rounds * BENCH_FRAMES));
+    printf("decode %.1f MB/s payload, %.0f ns per frame\n",
+           payload_mb / decode_s, decode_s * 1e9 / ((double)rounds * BENCH_FRAMES));
+    printf("UART at %u baud carries %.1f kB/s payload\n", BENCH_UART_BPS, uart_kbps);
+    return 0;
+}
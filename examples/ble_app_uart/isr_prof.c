@@ -0,0 +1,118 @@
+/** @file
+ *
+ * @brief Handler timing implementation.
+ */
+
+#include "isr_prof.h"
+
+#ifdef ISR_PROF_ENABLED
+
+#include <string.h>
+#include "nrf.h"
+#include "nordic_common.h"
+#include "app_error.h"
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "ctrl.h"
+
+#define ISR_PROF_PRESCALER              4                                           /**< TIMER2 at 16 MHz / 2^4, 1 us per count. */
+
+STATIC_ASSERT(ISR_PROF_COUNT * sizeof(isr_prof_stats_t) <= CTRL_RSP_DATA_MAX);
+
+/**@brief Timing of one handler. */
+typedef struct
+{
+    uint32_t count;                                                                 /**< Runs. */
+    uint32_t total_us;                                                              /**< Time spent in the handler. */
+    uint16_t max_us;                                                                /**< Longest run. */
+} isr_prof_entry_t;
+
+/**@brief TIMER2 CC register of every handler: one per priority level. */
+static uint8_t const m_cc[ISR_PROF_COUNT] =
+{
+    [ISR_PROF_SPI]                = 1,
+    [ISR_PROF_GPIOTE]             = 0,
+    [ISR_PROF_UART]               = 0,
+    [ISR_PROF_RADIO_NOTIFICATION] = 0,
+    [ISR_PROF_BLE_EVT]            = 2,
+    [ISR_PROF_SYS_EVT]            = 2,
+};
+
+static isr_prof_entry_t m_entries[ISR_PROF_COUNT];                                  /**< Timing per handler. */
+
+
+/**@brief Function for reading TIMER2 through a CC register.
+ */
+static __INLINE uint16_t isr_prof_now(isr_prof_id_t id)
+{
+    NRF_TIMER2->TASKS_CAPTURE[m_cc[id]] = 1;
+    return (uint16_t)NRF_TIMER2->CC[m_cc[id]];
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_ISR.
+ */
+static uint8_t isr_prof_stats_get(uint8_t * p_buf)
+{
+    isr_prof_stats_t stats;
+    isr_prof_entry_t entry;
+    uint8_t          i;
+
+    for (i = 0; i < ISR_PROF_COUNT; i++)
+    {
+        CRITICAL_REGION_ENTER();
+        entry = m_entries[i];
+        CRITICAL_REGION_EXIT();
+
+        stats.count  = entry.count;
+        stats.max_us = entry.max_us;
+        stats.avg_us = (entry.count == 0) ? 0 : (uint16_t)(entry.total_us / entry.count);
+        memcpy(&p_buf[i * sizeof(stats)], &stats, sizeof(stats));
+    }
+    return ISR_PROF_COUNT * sizeof(stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_ISR.
+ */
+static void isr_prof_stats_clear(void)
+{
+    CRITICAL_REGION_ENTER();
+    memset(m_entries, 0, sizeof(m_entries));
+    CRITICAL_REGION_EXIT();
+}
+
+
+void isr_prof_init(void)
+{
+    uint32_t err_code;
+
+    NRF_TIMER2->MODE      = TIMER_MODE_MODE_Timer;
+    NRF_TIMER2->BITMODE   = TIMER_BITMODE_BITMODE_16Bit;
+    NRF_TIMER2->PRESCALER = ISR_PROF_PRESCALER;
+    NRF_TIMER2->TASKS_CLEAR = 1;
+    NRF_TIMER2->TASKS_START = 1;
+
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_ISR, isr_prof_stats_get, isr_prof_stats_clear);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+uint16_t isr_prof_enter(isr_prof_id_t id)
+{
+    return isr_prof_now(id);
+}
+
+
+void isr_prof_exit(isr_prof_id_t id, uint16_t start)
+{
+    uint16_t           time    = (uint16_t)(isr_prof_now(id) - start);
+    isr_prof_entry_t * p_entry = &m_entries[id];
+
+    // Only handlers of the same priority write the same entry, the reader copies it atomically.
+    p_entry->count++;
+    p_entry->total_us += time;
+    p_entry->max_us    = MAX(p_entry->max_us, time);
+}
+
+#endif // ISR_PROF_ENABLED
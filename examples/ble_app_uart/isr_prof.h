@@ -0,0 +1,80 @@
+/** @file
+ *
+ * @defgroup isr_prof Handler timing
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Execution time of the interrupt handlers and of the SoftDevice event dispatch.
+ *
+ * @details Every handler calls @ref isr_prof_enter first and @ref isr_prof_exit last. Both capture
+ *          TIMER2, which counts microseconds, and the difference is accumulated per handler. A
+ *          handler preempted by a higher priority one is charged the time of that one too.
+ *
+ *          Each priority level captures into its own TIMER2 CC register, so that a handler
+ *          preempting another does not overwrite its start time. Handlers of the same priority do
+ *          not preempt each other.
+ *
+ *          TIMER2 keeps the 16 MHz clock running, so the timing is only built with
+ *          ISR_PROF_ENABLED defined in the project settings. Without it both functions are empty
+ *          and @ref CTRL_STATS_PAGE_ISR is not registered. Times longer than 65 ms wrap.
+ */
+
+#ifndef ISR_PROF_H__
+#define ISR_PROF_H__
+
+#include <stdint.h>
+#include "compiler_abstraction.h"
+
+/**@brief Handlers timed, in the order of @ref CTRL_STATS_PAGE_ISR. */
+typedef enum
+{
+    ISR_PROF_SPI,                                                                   /**< SPI master, APP_IRQ_PRIORITY_HIGH. */
+    ISR_PROF_GPIOTE,                                                                /**< CC1101 GDO0 pin, APP_IRQ_PRIORITY_LOW. */
+    ISR_PROF_UART,                                                                  /**< app_uart, APP_IRQ_PRIORITY_LOW. */
+    ISR_PROF_RADIO_NOTIFICATION,                                                    /**< SoftDevice radio notification, APP_IRQ_PRIORITY_LOW. */
+    ISR_PROF_BLE_EVT,                                                               /**< BLE event dispatch, from the scheduler. */
+    ISR_PROF_SYS_EVT,                                                               /**< System event dispatch, from the scheduler. */
+    ISR_PROF_COUNT                                                                  /**< Number of handlers timed. */
+} isr_prof_id_t;
+
+/**@brief Timing of one handler, as read from @ref CTRL_STATS_PAGE_ISR. */
+typedef struct
+{
+    uint32_t count;                                                                 /**< Runs. */
+    uint16_t max_us;                                                                /**< Longest run. */
+    uint16_t avg_us;                                                                /**< Average run. Computed when read. */
+} isr_prof_stats_t;
+
+#ifdef ISR_PROF_ENABLED
+
+/**@brief Function for starting TIMER2 and registering @ref CTRL_STATS_PAGE_ISR. */
+void isr_prof_init(void);
+
+/**@brief Function for marking the start of a handler.
+ *
+ * @return Start time, for @ref isr_prof_exit.
+ */
+uint16_t isr_prof_enter(isr_prof_id_t id);
+
+/**@brief Function for marking the end of a handler. */
+void isr_prof_exit(isr_prof_id_t id, uint16_t start);
+
+#else
+
+static __INLINE void isr_prof_init(void)
+{
+}
+
+static __INLINE uint16_t isr_prof_enter(isr_prof_id_t id)
+{
+    return 0;
+}
+
+static __INLINE void isr_prof_exit(isr_prof_id_t id, uint16_t start)
+{
+}
+
+#endif // ISR_PROF_ENABLED
+
+#endif // ISR_PROF_H__
+
+/** @} */
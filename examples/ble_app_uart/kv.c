@@ -0,0 +1,507 @@
+/** @file
+ *
+ * @brief Key/value store implementation.
+ */
+
+#include "kv.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "app_error.h"
+#include "app_util.h"
+#include "pstorage.h"
+#include "crc16.h"
+#include "ctrl.h"
+#include "flash_sched.h"
+
+#define KV_MAGIC                        0x3153564B                                  /**< "KVS1", first word of the header of a page in use. */
+#define KV_HEADER_LEN                   8                                           /**< Page header: sequence number (4), magic (4). The magic is written last. */
+#define KV_RECORD_HEADER_LEN            4                                           /**< Record header: key (1), length (1), CRC16 (2). */
+#define KV_RECORD_MAX                   (KV_RECORD_HEADER_LEN + KV_VALUE_MAX)       /**< Largest record. */
+#define KV_RECORD_SIZE(length)          (KV_RECORD_HEADER_LEN + (((length) + 3) & ~3)) /**< Size of a record in flash, padded to a word. */
+#define KV_PAGE_NONE                    0xFF                                        /**< No page. */
+
+STATIC_ASSERT((KV_VALUE_MAX % 4) == 0);
+STATIC_ASSERT(KV_PAGE_COUNT <= PSTORAGE_NUM_OF_PAGES);
+STATIC_ASSERT(KV_HEADER_LEN + (KV_KEY_COUNT + 1) * KV_RECORD_MAX <= KV_PAGE_SIZE);  // A compacted page has room for a new record.
+STATIC_ASSERT(sizeof(kv_stats_t) <= CTRL_RSP_DATA_MAX);
+STATIC_ASSERT(KV_RECORD_MAX <= FLASH_SCHED_CHUNK_MAX);                              // A record is written in one operation.
+STATIC_ASSERT(KV_PAGE_SIZE == FLASH_SCHED_PAGE_SIZE);
+
+/**@brief Steps of the flash work. */
+typedef enum
+{
+    KV_PHASE_IDLE,                                                                  /**< Writing queued records to the active page. */
+    KV_PHASE_ERASE,                                                                 /**< Erasing the next page of the rotation. */
+    KV_PHASE_COPY,                                                                  /**< Copying the last value of every key to it. */
+    KV_PHASE_HEADER                                                                 /**< Writing its header, which makes it the active page. */
+} kv_phase_t;
+
+/**@brief Value waiting to be written. */
+typedef struct
+{
+    uint8_t key;                                                                    /**< Key. */
+    uint8_t length;                                                                 /**< Length of the value, 0 deletes the key. */
+    uint8_t data[KV_VALUE_MAX];                                                     /**< Value. */
+} kv_pending_t;
+
+static pstorage_handle_t  m_base;                                                   /**< pstorage handle of the first page. */
+static flash_sched_user_t m_flash_user;                                             /**< Requests to @ref flash_sched. */
+static bool               m_busy;                                                   /**< A flash operation is in progress. */
+static uint8_t            m_active = KV_PAGE_NONE;                                  /**< Page holding the values. */
+static uint32_t           m_seq;                                                    /**< Sequence number of the active page. */
+static uint16_t           m_offset;                                                 /**< End of the log in the active page. */
+static kv_phase_t         m_phase = KV_PHASE_IDLE;                                  /**< Step of the flash work. */
+static uint8_t            m_target;                                                 /**< Page being compacted into. */
+static uint16_t           m_target_offset;                                          /**< End of the log in the target page. */
+static uint16_t           m_copy_offset;                                            /**< Next record of the active page to look at while compacting. */
+static uint16_t           m_copy_record;                                            /**< Record of the active page being copied. */
+static uint16_t           m_op_size;                                                /**< Size of the flash write in progress. */
+static uint32_t           m_buf[KV_RECORD_MAX / 4];                                 /**< Source of the flash write in progress, word aligned. */
+static kv_pending_t       m_queue[KV_QUEUE_SIZE];                                   /**< Values waiting to be written, oldest first. */
+static uint8_t            m_queue_len;                                              /**< Number of values in m_queue. */
+static kv_stats_t         m_stats;                                                  /**< Statistics. */
+
+
+/**@brief Function for getting the address of a page. */
+static uint8_t const * page_addr(uint8_t page)
+{
+    return (uint8_t const *)(m_base.block_id + page * KV_PAGE_SIZE);
+}
+
+
+/**@brief Function for parsing the record at an offset of a page.
+ *
+ * @param[in]  p_page    Page.
+ * @param[in]  offset    Offset of the record.
+ * @param[out] p_valid   The CRC of the record is correct.
+ *
+ * @return Size of the record, or 0 at the end of the log.
+ */
+static uint16_t record_parse(uint8_t const * p_page, uint16_t offset, bool * p_valid)
+{
+    uint8_t const * p_rec = &p_page[offset];
+    uint16_t        crc;
+
+    if ((offset + KV_RECORD_HEADER_LEN > KV_PAGE_SIZE) ||
+        (p_rec[0] >= KV_KEY_COUNT) ||
+        (p_rec[1] > KV_VALUE_MAX) ||
+        (offset + KV_RECORD_SIZE(p_rec[1]) > KV_PAGE_SIZE))
+    {
+        // Erased, or not a record.
+        return 0;
+    }
+
+    crc      = crc16_compute(p_rec, 2, NULL);
+    crc      = crc16_compute(&p_rec[KV_RECORD_HEADER_LEN], p_rec[1], &crc);
+    *p_valid = (crc == uint16_decode(&p_rec[2]));
+    return KV_RECORD_SIZE(p_rec[1]);
+}
+
+
+/**@brief Function for finding the last valid record of a key in a page, after an offset.
+ *
+ * @return Offset of the record, or 0 if there is none.
+ */
+static uint16_t record_find(uint8_t page, uint8_t key, uint16_t offset)
+{
+    uint8_t const * p_page = page_addr(page);
+    uint16_t        found  = 0;
+    uint16_t        size;
+    bool            valid;
+
+    while ((size = record_parse(p_page, offset, &valid)) != 0)
+    {
+        if (valid && (p_page[offset] == key))
+        {
+            found = offset;
+        }
+        offset += size;
+    }
+    return found;
+}
+
+
+/**@brief Function for finding the next record of the active page to keep in the compacted page.
+ *
+ * @details A record is kept if it is valid, is the last one of its key and is not a delete.
+ *
+ * @return true and m_copy_record set, or false once every record was looked at.
+ */
+static bool copy_find(void)
+{
+    uint8_t const * p_page = page_addr(m_active);
+    uint16_t        size;
+    bool            valid;
+
+    while ((size = record_parse(p_page, m_copy_offset, &valid)) != 0)
+    {
+        if (valid &&
+            (p_page[m_copy_offset + 1] != 0) &&
+            (record_find(m_active, p_page[m_copy_offset], m_copy_offset + size) == 0))
+        {
+            m_copy_record = m_copy_offset;
+            m_op_size     = size;
+            return true;
+        }
+        m_copy_offset += size;
+    }
+    return false;
+}
+
+
+/**@brief Function for moving to the next step of the flash work and sizing its operation.
+ *
+ * @return false if there is nothing to write.
+ */
+static bool kv_prepare(void)
+{
+    if (m_phase == KV_PHASE_IDLE)
+    {
+        if (m_queue_len == 0)
+        {
+            return false;
+        }
+        if ((m_active == KV_PAGE_NONE) || (m_offset + KV_RECORD_SIZE(m_queue[0].length) > KV_PAGE_SIZE))
+        {
+            m_target = (m_active == KV_PAGE_NONE) ? 0 : ((m_active + 1) % KV_PAGE_COUNT);
+            m_phase  = KV_PHASE_ERASE;
+        }
+    }
+    if ((m_phase == KV_PHASE_COPY) && !copy_find())
+    {
+        m_phase = KV_PHASE_HEADER;
+    }
+
+    switch (m_phase)
+    {
+        case KV_PHASE_ERASE:
+            m_op_size = KV_PAGE_SIZE;
+            break;
+
+        case KV_PHASE_COPY:
+            // Set by copy_find.
+            break;
+
+        case KV_PHASE_HEADER:
+            m_op_size = KV_HEADER_LEN;
+            break;
+
+        default:
+            m_op_size = KV_RECORD_SIZE(m_queue[0].length);
+            break;
+    }
+    return true;
+}
+
+
+/**@brief Function for asking @ref flash_sched for the next flash operation, if any.
+ */
+static void kv_run(void)
+{
+    if (!m_busy && kv_prepare())
+    {
+        flash_sched_request(&m_flash_user,
+                            (m_phase == KV_PHASE_ERASE) ? FLASH_SCHED_OP_ERASE : FLASH_SCHED_OP_WRITE,
+                            m_op_size);
+    }
+}
+
+
+/**@brief Function for issuing the next flash operation, once @ref flash_sched allows it.
+ *
+ * @details The queue may have changed since the request, so the step is worked out again.
+ */
+static bool kv_start(flash_sched_user_t * p_user)
+{
+    pstorage_handle_t handle;
+    uint8_t           page;
+    uint16_t          offset;
+    uint16_t          crc;
+    uint8_t         * p_buf = (uint8_t *)m_buf;
+    uint32_t          err_code;
+
+    if (m_busy || !kv_prepare())
+    {
+        return false;
+    }
+
+    switch (m_phase)
+    {
+        case KV_PHASE_ERASE:
+            page   = m_target;
+            offset = 0;
+            break;
+
+        case KV_PHASE_COPY:
+            memcpy(m_buf, &page_addr(m_active)[m_copy_record], m_op_size);
+            page   = m_target;
+            offset = m_target_offset;
+            break;
+
+        case KV_PHASE_HEADER:
+            m_buf[0] = m_seq + 1;
+            m_buf[1] = KV_MAGIC;
+            page     = m_target;
+            offset   = 0;
+            break;
+
+        default:
+            // Record of the oldest queued value, padded with 0xFF.
+            memset(m_buf, 0xFF, sizeof(m_buf));
+            p_buf[0] = m_queue[0].key;
+            p_buf[1] = m_queue[0].length;
+            memcpy(&p_buf[KV_RECORD_HEADER_LEN], m_queue[0].data, m_queue[0].length);
+            crc = crc16_compute(p_buf, 2, NULL);
+            crc = crc16_compute(&p_buf[KV_RECORD_HEADER_LEN], m_queue[0].length, &crc);
+            UNUSED_VARIABLE(uint16_encode(crc, &p_buf[2]));
+            page   = m_active;
+            offset = m_offset;
+            break;
+    }
+
+    err_code = pstorage_block_identifier_get(&m_base, page, &handle);
+    APP_ERROR_CHECK(err_code);
+    if (m_phase == KV_PHASE_ERASE)
+    {
+        err_code = pstorage_clear(&handle, KV_PAGE_SIZE);
+    }
+    else
+    {
+        err_code = pstorage_store(&handle, p_buf, m_op_size, offset);
+    }
+    APP_ERROR_CHECK(err_code);
+
+    m_busy = true;
+    return true;
+}
+
+
+/**@brief Function for handling the end of a pstorage operation.
+ */
+static void kv_pstorage_cb(pstorage_handle_t * p_handle,
+                           uint8_t             op_code,
+                           uint32_t            result,
+                           uint8_t           * p_data,
+                           uint32_t            data_len)
+{
+    m_busy = false;
+
+    if (result != NRF_SUCCESS)
+    {
+        // The SoftDevice found no time for the operation, it is issued again.
+        m_stats.errors++;
+        kv_run();
+        return;
+    }
+
+    switch (m_phase)
+    {
+        case KV_PHASE_ERASE:
+            m_stats.erases++;
+            m_target_offset = KV_HEADER_LEN;
+            m_copy_offset   = KV_HEADER_LEN;
+            m_phase         = (m_active == KV_PAGE_NONE) ? KV_PHASE_HEADER : KV_PHASE_COPY;
+            break;
+
+        case KV_PHASE_COPY:
+            m_copy_offset    = m_copy_record + m_op_size;
+            m_target_offset += m_op_size;
+            break;
+
+        case KV_PHASE_HEADER:
+            m_active = m_target;
+            m_offset = m_target_offset;
+            m_seq++;
+            m_phase  = KV_PHASE_IDLE;
+            break;
+
+        default:
+            m_stats.records++;
+            m_offset += m_op_size;
+            m_queue_len--;
+            memmove(&m_queue[0], &m_queue[1], m_queue_len * sizeof(m_queue[0]));
+            break;
+    }
+
+    kv_run();
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_KV.
+ */
+static uint8_t kv_stats_get(uint8_t * p_buf)
+{
+    memcpy(p_buf, &m_stats, sizeof(m_stats));
+    return sizeof(m_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_KV.
+ */
+static void kv_stats_clear(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+
+uint32_t kv_init(void)
+{
+    pstorage_module_param_t param;
+    uint32_t const *        p_header;
+    uint8_t const *         p_page;
+    uint16_t                size;
+    uint8_t                 page;
+    bool                    valid;
+    uint32_t                err_code;
+
+    m_flash_user.start = kv_start;
+
+    param.block_size  = KV_PAGE_SIZE;
+    param.block_count = KV_PAGE_COUNT;
+    param.cb          = kv_pstorage_cb;
+    err_code = pstorage_register(&param, &m_base);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // The active page is the page with a header and the highest sequence number.
+    for (page = 0; page < KV_PAGE_COUNT; page++)
+    {
+        p_header = (uint32_t const *)page_addr(page);
+        if ((p_header[1] == KV_MAGIC) && ((m_active == KV_PAGE_NONE) || (p_header[0] > m_seq)))
+        {
+            m_active = page;
+            m_seq    = p_header[0];
+        }
+    }
+
+    if (m_active != KV_PAGE_NONE)
+    {
+        p_page   = page_addr(m_active);
+        m_offset = KV_HEADER_LEN;
+        while ((size = record_parse(p_page, m_offset, &valid)) != 0)
+        {
+            m_offset += size;
+        }
+        if ((m_offset + 4 <= KV_PAGE_SIZE) && (uint32_decode(&p_page[m_offset]) != 0xFFFFFFFF))
+        {
+            // Not erased, nothing more can be written to this page.
+            m_offset = KV_PAGE_SIZE;
+        }
+    }
+
+    return ctrl_stats_page_register(CTRL_STATS_PAGE_KV, kv_stats_get, kv_stats_clear);
+}
+
+
+uint32_t kv_read(uint8_t key, uint8_t * p_data, uint8_t * p_length)
+{
+    uint8_t const * p_value = NULL;
+    uint8_t         length  = 0;
+    uint16_t        offset;
+    int             i;
+
+    if (key >= KV_KEY_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    for (i = m_queue_len - 1; i >= 0; i--)
+    {
+        if (m_queue[i].key == key)
+        {
+            p_value = m_queue[i].data;
+            length  = m_queue[i].length;
+            break;
+        }
+    }
+
+    if ((p_value == NULL) && (m_active != KV_PAGE_NONE))
+    {
+        offset = record_find(m_active, key, KV_HEADER_LEN);
+        if (offset != 0)
+        {
+            p_value = &page_addr(m_active)[offset + KV_RECORD_HEADER_LEN];
+            length  = page_addr(m_active)[offset + 1];
+        }
+    }
+
+    if ((p_value == NULL) || (length == 0))
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    if (length > *p_length)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    memcpy(p_data, p_value, length);
+    *p_length = length;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t kv_write(uint8_t key, uint8_t const * p_data, uint8_t length)
+{
+    uint8_t  current[KV_VALUE_MAX];
+    uint8_t  current_len = sizeof(current);
+    uint32_t err_code;
+    int      first;
+    int      i;
+
+    if (key >= KV_KEY_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (length > KV_VALUE_MAX)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    err_code = kv_read(key, current, &current_len);
+    if ((err_code == NRF_SUCCESS) ? ((current_len == length) && (memcmp(current, p_data, length) == 0))
+                                  : (length == 0))
+    {
+        m_stats.unchanged++;
+        return NRF_SUCCESS;
+    }
+
+    // The oldest value may be in flight, it is not changed.
+    first = (m_busy && (m_phase == KV_PHASE_IDLE)) ? 1 : 0;
+    for (i = m_queue_len - 1; i >= first; i--)
+    {
+        if (m_queue[i].key == key)
+        {
+            m_queue[i].length = length;
+            memcpy(m_queue[i].data, p_data, length);
+            m_stats.coalesced++;
+            return NRF_SUCCESS;
+        }
+    }
+
+    if (m_queue_len == KV_QUEUE_SIZE)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    m_queue[m_queue_len].key    = key;
+    m_queue[m_queue_len].length = length;
+    memcpy(m_queue[m_queue_len].data, p_data, length);
+    m_queue_len++;
+
+    kv_run();
+    return NRF_SUCCESS;
+}
+
+
+uint32_t kv_delete(uint8_t key)
+{
+    return kv_write(key, NULL, 0);
+}
+
+
+bool kv_is_busy(void)
+{
+    return (m_queue_len > 0) || (m_phase != KV_PHASE_IDLE);
+}
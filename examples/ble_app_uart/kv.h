@@ -0,0 +1,99 @@
+/** @file
+ *
+ * @defgroup kv Key/value store
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Small values kept across resets in a log of records in flash, over pstorage.
+ *
+ * @details The store uses @ref KV_PAGE_COUNT flash pages, one of them active at a time. A value is
+ *          written by appending a record | key (1) | length (1) | CRC16 (2) | value, padded to a
+ *          word | to the active page, and the last valid record of a key is its value. An update is
+ *          atomic: a record cut short by a reset fails its CRC and the previous value is kept.
+ *
+ *          When the active page is full, the last value of every key is copied to the next page of
+ *          the rotation, which was erased first, and the header of that page is written last. A
+ *          reset during this compaction leaves a page without a header, which is ignored, so the
+ *          old page stays the active one. Pages are used in turn, which spreads the erase cycles.
+ *
+ *          Writes are queued in RAM, the same key written again before its record reached flash
+ *          only costs one record, and writing the value a key already has costs nothing. Every
+ *          flash operation goes through @ref flash_sched, which holds it back while the radio
+ *          cannot afford the CPU stall.
+ *
+ *          All functions run in thread mode, pstorage reports through the system event handler.
+ */
+
+#ifndef KV_H__
+#define KV_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define KV_PAGE_COUNT                   3                                           /**< Flash pages of the store, PSTORAGE_NUM_OF_PAGES must allow for them. */
+#define KV_PAGE_SIZE                    1024                                        /**< nRF51 flash page size. */
+#define KV_VALUE_MAX                    32                                          /**< Largest value. */
+#define KV_QUEUE_SIZE                   4                                           /**< Number of keys that can wait to be written. */
+
+/**@brief Keys. */
+typedef enum
+{
+    KV_KEY_RADIO_PROFILE = 0x00,                                                    /**< Radio profile used at boot, see @ref radio_profile. */
+    KV_KEY_POWER_BUDGET  = 0x01,                                                    /**< Wake latency budget used at boot, see @ref power_mgr. */
+    KV_KEY_SLOT_PERIOD   = 0x02,                                                    /**< Longest slot period used at boot, see @ref slot_sync. */
+    KV_KEY_ENERGY_CURRENT = 0x03,                                                   /**< Current of every state, see @ref energy. */
+    KV_KEY_COUNT         = 16                                                       /**< Number of keys. */
+} kv_key_t;
+
+/**@brief Statistics, @ref CTRL_STATS_PAGE_KV. */
+typedef struct
+{
+    uint32_t records;                                                               /**< Records written. */
+    uint32_t erases;                                                                /**< Pages erased. */
+    uint32_t coalesced;                                                             /**< Writes that replaced a value still waiting in the queue. */
+    uint32_t unchanged;                                                             /**< Writes skipped because the key already had the value. */
+    uint32_t errors;                                                                /**< Flash operations that failed and were tried again. */
+} kv_stats_t;
+
+/**@brief Function for initializing the store and finding the active page.
+ *
+ * @details Registers @ref CTRL_STATS_PAGE_KV. pstorage_init and @ref flash_sched_init must have
+ *          been called.
+ *
+ * @return NRF_SUCCESS or an error code from pstorage.
+ */
+uint32_t kv_init(void);
+
+/**@brief Function for reading a value.
+ *
+ * @param[in]    key       Key.
+ * @param[out]   p_data    Value.
+ * @param[inout] p_length  In: size of p_data. Out: length of the value.
+ *
+ * @retval NRF_SUCCESS              Value read.
+ * @retval NRF_ERROR_NOT_FOUND      The key has no value.
+ * @retval NRF_ERROR_INVALID_PARAM  Unknown key.
+ * @retval NRF_ERROR_INVALID_LENGTH The value does not fit in p_data.
+ */
+uint32_t kv_read(uint8_t key, uint8_t * p_data, uint8_t * p_length);
+
+/**@brief Function for writing a value. The write completes in the background.
+ *
+ * @retval NRF_SUCCESS              Value queued, or already stored.
+ * @retval NRF_ERROR_INVALID_PARAM  Unknown key.
+ * @retval NRF_ERROR_INVALID_LENGTH Value longer than @ref KV_VALUE_MAX.
+ * @retval NRF_ERROR_NO_MEM         The queue is full.
+ */
+uint32_t kv_write(uint8_t key, uint8_t const * p_data, uint8_t length);
+
+/**@brief Function for deleting a value. The delete completes in the background.
+ *
+ * @return See @ref kv_write.
+ */
+uint32_t kv_delete(uint8_t key);
+
+/**@brief Function for checking whether writes are waiting for flash. */
+bool kv_is_busy(void);
+
+#endif // KV_H__
+
+/** @} */
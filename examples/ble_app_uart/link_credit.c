@@ -0,0 +1,139 @@
+/** @file
+ *
+ * @brief Radio link credits implementation.
+ */
+
+#include "link_credit.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+
+
+void link_credit_init(link_credit_t * p_link)
+{
+    memset(p_link, 0, sizeof(*p_link));
+}
+
+
+bool link_credit_tx_allowed(link_credit_t * p_link)
+{
+    if (p_link->tx_limit_valid && ((int8_t)(p_link->tx_limit - p_link->tx_seq) > 0))
+    {
+        return true;
+    }
+
+    p_link->stats.stalls++;
+    return false;
+}
+
+
+uint8_t link_credit_tx_seq_take(link_credit_t * p_link)
+{
+    return p_link->tx_seq++;
+}
+
+
+uint32_t link_credit_on_frame(link_credit_t * p_link, uint8_t const * p_frame, uint8_t length)
+{
+    uint8_t flags;
+    uint8_t ack;
+    uint8_t space;
+
+    if (length < LINK_CREDIT_FRAME_LEN)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    flags = p_frame[1];
+    ack   = p_frame[2];
+    space = MIN(p_frame[3], LINK_CREDIT_SPACE_MAX);
+    p_link->stats.credit_rx++;
+
+    if ((flags & LINK_CREDIT_FLAG_ACK_VALID) == 0)
+    {
+        // The peer has lost track of our packets, everything in flight is gone.
+        p_link->tx_limit = p_link->tx_seq + space;
+    }
+    else
+    {
+        if ((int8_t)(ack - p_link->tx_seq) >= 0)
+        {
+            // Acknowledged a packet we did not send (yet), we were reset. Continue after it.
+            p_link->tx_seq = ack + 1;
+            p_link->stats.resyncs++;
+        }
+        p_link->tx_limit = ack + 1 + space;
+    }
+    p_link->tx_limit_valid = true;
+
+    return NRF_SUCCESS;
+}
+
+
+void link_credit_on_data(link_credit_t * p_link, uint8_t seq)
+{
+    int8_t gap;
+
+    if (p_link->rx_ack_valid)
+    {
+        gap = (int8_t)(seq - p_link->rx_ack - 1);
+        if (gap > 0)
+        {
+            p_link->stats.lost += gap;
+        }
+    }
+
+    p_link->rx_ack       = seq;
+    p_link->rx_ack_valid = true;
+}
+
+
+/**@brief Function for computing the limit advertised for a given space. */
+static uint8_t rx_limit(link_credit_t const * p_link, uint8_t space)
+{
+    return p_link->rx_ack + 1 + MIN(space, LINK_CREDIT_SPACE_MAX);
+}
+
+
+bool link_credit_update_needed(link_credit_t const * p_link, uint8_t space)
+{
+    uint8_t limit = rx_limit(p_link, space);
+    int8_t  left;
+
+    if (!p_link->rx_advertised_valid || ((int8_t)(limit - p_link->rx_advertised) < 0))
+    {
+        // Nothing advertised yet, or less space than advertised: packets would be dropped.
+        return true;
+    }
+    if (limit == p_link->rx_advertised)
+    {
+        return false;
+    }
+
+    // The peer still has credits left from the last frame, wait until it used half the window.
+    left = (int8_t)(p_link->rx_advertised - p_link->rx_ack - 1);
+    return (2 * left <= MIN(space, LINK_CREDIT_SPACE_MAX));
+}
+
+
+void link_credit_update_force(link_credit_t * p_link)
+{
+    p_link->rx_advertised_valid = false;
+}
+
+
+uint8_t link_credit_frame_build(link_credit_t * p_link, uint8_t space, uint8_t * p_frame)
+{
+    space = MIN(space, LINK_CREDIT_SPACE_MAX);
+
+    p_frame[0] = LINK_CREDIT_FRAME;
+    p_frame[1] = p_link->rx_ack_valid ? LINK_CREDIT_FLAG_ACK_VALID : 0;
+    p_frame[2] = p_link->rx_ack;
+    p_frame[3] = space;
+
+    p_link->rx_advertised       = rx_limit(p_link, space);
+    p_link->rx_advertised_valid = true;
+    p_link->stats.credit_tx++;
+
+    return LINK_CREDIT_FRAME_LEN;
+}
@@ -0,0 +1,110 @@
+/** @file
+ *
+ * @defgroup link_credit Radio link credits
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Credit based flow control between two extenders over the CC1101 link.
+ *
+ * @details Every data packet sent over the radio carries an 8 bit sequence number. The receiver
+ *          answers with credit frames
+ *
+ *          | LINK_CREDIT_FRAME (1) | flags (1) | ack (1) | space (1) |
+ *
+ *          where ack is the sequence number of the last data packet received and space the number of
+ *          packets the receiver can still queue. The sender may send up to sequence number
+ *          ack + space. Both values are absolute, so a lost credit frame is repaired by the next one
+ *          and a lost data packet does not leak credits.
+ *
+ *          A receiver that has not received anything yet (after a reset) clears
+ *          @ref LINK_CREDIT_FLAG_ACK_VALID, the sender then counts from its own sequence number. A
+ *          sender that is acknowledged a sequence number it did not send yet (after its own reset)
+ *          continues after that number.
+ */
+
+#ifndef LINK_CREDIT_H__
+#define LINK_CREDIT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LINK_CREDIT_FRAME               0x01                                        /**< Type byte of a credit frame. */
+#define LINK_CREDIT_FRAME_LEN           4                                           /**< Length of a credit frame. */
+#define LINK_CREDIT_FLAG_ACK_VALID      0x01                                        /**< The ack field of a credit frame is valid. */
+#define LINK_CREDIT_SPACE_MAX           64                                          /**< Largest space advertised, keeps the window well inside the sequence space. */
+
+/**@brief Statistics of the link flow control. */
+typedef struct
+{
+    uint32_t credit_tx;                                                             /**< Credit frames sent. */
+    uint32_t credit_rx;                                                             /**< Credit frames received. */
+    uint32_t stalls;                                                                /**< Times a data packet waited because the peer had no space. */
+    uint32_t resyncs;                                                               /**< Times the sequence numbers were realigned after a reset. */
+    uint32_t lost;                                                                  /**< Data packets missing in the received sequence. */
+} link_credit_stats_t;
+
+/**@brief Flow control state of one end of the link. */
+typedef struct
+{
+    uint8_t             tx_seq;                                                     /**< Sequence number of the next data packet to send. */
+    uint8_t             tx_limit;                                                   /**< First sequence number the peer has no space for. */
+    bool                tx_limit_valid;                                             /**< A credit frame was received. */
+    uint8_t             rx_ack;                                                     /**< Sequence number of the last data packet received. */
+    bool                rx_ack_valid;                                               /**< A data packet was received. */
+    uint8_t             rx_advertised;                                              /**< Limit sent in the last credit frame. */
+    bool                rx_advertised_valid;                                        /**< A credit frame was sent. */
+    link_credit_stats_t stats;                                                      /**< Statistics. */
+} link_credit_t;
+
+/**@brief Function for initializing the flow control state. */
+void link_credit_init(link_credit_t * p_link);
+
+/**@brief Function for checking whether the peer has space for a data packet.
+ *
+ * @details Counts a stall when it has not.
+ */
+bool link_credit_tx_allowed(link_credit_t * p_link);
+
+/**@brief Function for taking the sequence number of the next data packet. */
+uint8_t link_credit_tx_seq_take(link_credit_t * p_link);
+
+/**@brief Function for handling a received credit frame.
+ *
+ * @retval NRF_SUCCESS              Frame handled.
+ * @retval NRF_ERROR_INVALID_LENGTH Frame too short.
+ */
+uint32_t link_credit_on_frame(link_credit_t * p_link, uint8_t const * p_frame, uint8_t length);
+
+/**@brief Function for recording the sequence number of a received data packet. */
+void link_credit_on_data(link_credit_t * p_link, uint8_t seq);
+
+/**@brief Function for checking whether the peer should be sent a credit frame.
+ *
+ * @param[in] p_link  Flow control state.
+ * @param[in] space   Packets that can currently be queued for the peer.
+ *
+ * @details Updates are coalesced, a data packet received does not call for a frame on its own. A
+ *          frame is due when the peer has used at least half of the window, or when the limit has
+ *          to shrink. A limit that only grew otherwise waits for the keepalive.
+ *
+ * @return true if a credit frame should be sent now.
+ */
+bool link_credit_update_needed(link_credit_t const * p_link, uint8_t space);
+
+/**@brief Function for asking for a credit frame whatever the limit, e.g. to tell the peer this end
+ *        is back.
+ */
+void link_credit_update_force(link_credit_t * p_link);
+
+/**@brief Function for building a credit frame.
+ *
+ * @param[in]  p_link   Flow control state.
+ * @param[in]  space    Packets that can currently be queued for the peer.
+ * @param[out] p_frame  Buffer of @ref LINK_CREDIT_FRAME_LEN bytes.
+ *
+ * @return Length of the frame.
+ */
+uint8_t link_credit_frame_build(link_credit_t * p_link, uint8_t space, uint8_t * p_frame);
+
+#endif // LINK_CREDIT_H__
+
+/** @} */
@@ -20,6 +20,8 @@
  SCK =  29 -------- 29
  SS =   24 -------- 24
  
+ CC1101 GDO0 -> 30
+ 
  
  
  */
@@ -45,7 +47,10 @@
 #include "ble_advertising.h"
 #include "ble_conn_params.h"
 #include "softdevice_handler.h"
+#include "softdevice_handler_appsh.h"
 #include "app_timer.h"
+#include "app_timer_appsh.h"
+#include "app_scheduler.h"
 #include "app_button.h"
 #include "ble_nus.h"
 #include "app_uart.h"
@@ -55,13 +60,40 @@
 #include "nrf_gpio.h"
 #include "nrf_gpiote.h"
 #include "nrf_drv_gpiote.h"
+#include "nrf_delay.h"
 
 #include <stdio.h>
 #include <stdbool.h>
 #include "app_error.h"
-#include "nrf_delay.h"
+#include "nrf_soc.h"
 #include "nrf_drv_spi.h"
 #include "SEGGER_RTT.h"
+#include "pkt_queue.h"
+#include "uart_frame.h"
+#include "ctrl.h"
+#include "router.h"
+#include "pkt_sched.h"
+#include "link_credit.h"
+#include "ble_credit.h"
+#include "cpu_load.h"
+#include "seq.h"
+#include "cc1101.h"
+#include "cc1101_hal_nrf51.h"
+#include "cc1101_shadow.h"
+#include "power_mgr.h"
+#include "standby.h"
+#include "radio_profile.h"
+#include "pstorage.h"
+#include "kv.h"
+#include "flash_sched.h"
+#include "ble_timeline.h"
+#include "isr_prof.h"
+#include "boot_prof.h"
+#include "energy.h"
+#include "ble_energy.h"
+#include "recovery.h"
+#include "radio_ts.h"
+#include "slot_sync.h"
 
 #define IS_SRVC_CHANGED_CHARACT_PRESENT 0                                           /**< Include the service_changed characteristic. If not enabled, the server's database cannot be changed for the lifetime of the device. */
 
@@ -72,7 +104,10 @@
 #define APP_ADV_TIMEOUT_IN_SECONDS      180                                         /**< The advertising timeout (in units of seconds). */
 
 #define APP_TIMER_PRESCALER             0                                           /**< Value of the RTC1 PRESCALER register. */
-#define APP_TIMER_OP_QUEUE_SIZE         4                                           /**< Size of timer operation queues. */
+#define APP_TIMER_OP_QUEUE_SIZE         8                                           /**< Size of timer operation queues. */
+
+#define SCHED_MAX_EVENT_DATA_SIZE       MAX(APP_TIMER_SCHED_EVT_SIZE, BLE_STACK_HANDLER_SCHED_EVT_SIZE) /**< Maximum size of scheduler events. */
+#define SCHED_QUEUE_SIZE                16                                          /**< Maximum number of events in the scheduler queue. */
 
 #define MIN_CONN_INTERVAL               MSEC_TO_UNITS(20, UNIT_1_25_MS)             /**< Minimum acceptable connection interval (20 ms), Connection interval uses 1.25 ms units. */
 #define MAX_CONN_INTERVAL               MSEC_TO_UNITS(75, UNIT_1_25_MS)             /**< Maximum acceptable connection interval (75 ms), Connection interval uses 1.25 ms units. */
@@ -89,9 +124,71 @@
 #define UART_TX_BUF_SIZE                256                                         /**< UART TX buffer size. */
 #define UART_RX_BUF_SIZE                256                                         /**< UART RX buffer size. */
 
+#define UART_FRAMING_LINE               0                                           /**< Text mode, a line ends at '\n' or after BLE_NUS_MAX_DATA_LEN characters. The command channel is on RTT, see @ref rtt_ctrl_poll. */
+#define UART_FRAMING_COBS               1                                           /**< Binary mode, COBS frames with CRC and a command channel (see @ref uart_frame). */
+
+#ifndef UART_FRAMING
+#define UART_FRAMING                    UART_FRAMING_LINE                           /**< UART framing mode, can be overridden from the project settings. */
+#endif
+
+#if (UART_FRAMING == UART_FRAMING_COBS)
+#define UART_BAUDRATE                   UART_BAUDRATE_BAUDRATE_Baud1M               /**< Binary mode relies on RTS/CTS to run at the highest rate of the UART. */
+#define UART_BAUDRATE_BPS               1000000                                     /**< UART_BAUDRATE in bits per second. */
+#else
+#define UART_BAUDRATE                   UART_BAUDRATE_BAUDRATE_Baud38400            /**< UART baud rate of the text mode. */
+#define UART_BAUDRATE_BPS               38400                                       /**< UART_BAUDRATE in bits per second. */
+#endif
+
+#define UART_IDLE_CHARS                 2                                           /**< Character times of UART silence after which a partial line is sent (text mode). */
+#define UART_IDLE_TIMEOUT               MAX(APP_TIMER_MIN_TIMEOUT_TICKS, \
+                                            CEIL_DIV(UART_IDLE_CHARS * 10 * APP_TIMER_CLOCK_FREQ, \
+                                                     (APP_TIMER_PRESCALER + 1) * UART_BAUDRATE_BPS)) /**< UART_IDLE_CHARS of 8N1 characters, in app_timer ticks. */
+
+#define NUS_TX_QUEUE_SIZE               8                                           /**< Number of packets that can wait for a SoftDevice TX buffer (power of two). */
+#define UART_TX_QUEUE_SIZE              8                                           /**< Number of packets that can wait for the UART (power of two). */
+#define RADIO_PRIORITY_QUEUE_SIZE       2                                           /**< Number of priority packets that can wait for the radio (power of two). */
+#define RADIO_INTERACTIVE_QUEUE_SIZE    4                                           /**< Number of interactive packets that can wait for the radio (power of two). */
+#define RADIO_BULK_QUEUE_SIZE           4                                           /**< Number of bulk packets that can wait for the radio (power of two). */
+#define RADIO_INTERACTIVE_WEIGHT        3                                           /**< Interactive packets sent per turn of the radio round robin. */
+#define RADIO_BULK_WEIGHT               1                                           /**< Bulk packets sent per turn of the radio round robin. */
+#define RTT_TX_QUEUE_SIZE               4                                           /**< Number of packets that can wait for RTT (power of two). */
+#define RTT_POLL_INTERVAL               APP_TIMER_TICKS(100, APP_TIMER_PRESCALER)   /**< Interval at which RTT input is polled, RTT has no interrupt (100 ms). */
+#define RTT_CTRL_CHANNEL                1                                           /**< RTT channel of the control channel, in every UART framing mode. */
+#define RTT_CTRL_BUF_SIZE               64                                          /**< Size of each RTT control channel buffer, holds a whole response. */
+#define RTT_CTRL_REQ_MAX                (1 + CTRL_RSP_DATA_MAX)                     /**< Longest control request taken from RTT, a ping echoing a full response. */
+#define ENERGY_REPORT_INTERVAL          APP_TIMER_TICKS(60000, APP_TIMER_PRESCALER) /**< Interval at which the energy estimate is printed on RTT and updated in its characteristic, also keeps the accounting within the RTC1 wrap (60 seconds). */
+
+#define RADIO_PACKET_MAX                61                                          /**< Largest CC1101 packet, so that it fits in the 64 byte FIFO with its length and status bytes. */
+#define RADIO_HEADER_LEN                2                                           /**< Port and sequence number in front of the payload of a radio data packet. */
+#define RADIO_PAYLOAD_MAX               (RADIO_PACKET_MAX - RADIO_HEADER_LEN)       /**< Largest payload of a radio data packet. */
+#define RADIO_PROFILE_UICR_INDEX        0                                           /**< UICR CUSTOMER register holding the radio profile used at boot, see @ref radio_profile. Erased (0xFFFFFFFF) selects RADIO_PROFILE_DEFAULT. */
+#define RADIO_GDO0_PIN                  30                                          /**< Pin wired to CC1101 GDO0, which rises at the sync word and falls at the end of every packet (IOCFG0 = 0x06). */
+#define RADIO_TX_POLL_INTERVAL          APP_TIMER_TICKS(5, APP_TIMER_PRESCALER)     /**< Interval at which MARCSTATE is checked while a packet is sent (5 ms). */
+#define RADIO_TX_TIMEOUT                APP_TIMER_TICKS(1000, APP_TIMER_PRESCALER)  /**< Longest time a packet may take to send, the longest packet takes about 480 ms at 1.2 kBaud (1 second). */
+#define RADIO_RESET_PULSE               APP_TIMER_TICKS(1, APP_TIMER_PRESCALER)     /**< Length of the SS pulses of the manual power-on reset (1 ms). */
+#define RADIO_RDY_POLL_INTERVAL         APP_TIMER_MIN_TIMEOUT_TICKS                 /**< Interval at which CHIP_RDYn is checked while the crystal starts. */
+#define RADIO_RDY_TIMEOUT               APP_TIMER_TICKS(10, APP_TIMER_PRESCALER)    /**< Longest wait for CHIP_RDYn after a reset (10 ms). */
+#define RADIO_WAKE_TIMEOUT              APP_TIMER_TICKS(1, APP_TIMER_PRESCALER)     /**< Longest wait for CHIP_RDYn after XOFF or SLEEP, 150 us typical (1 ms). */
+#define RADIO_INIT_RETRY_INTERVAL       APP_TIMER_TICKS(1000, APP_TIMER_PRESCALER)  /**< Delay before a failed CC1101 reset is tried again (1 second). */
+#define RADIO_BURST_TIMEOUT             APP_TIMER_TICKS(10, APP_TIMER_PRESCALER)    /**< Longest interrupt driven SPI burst, BLE radio events included (10 ms). */
+#define RADIO_FIFO_ERRORS_MAX           3                                           /**< RX FIFO errors in a row before the CC1101 is reset, see @ref recovery. */
+#define RADIO_TX_TIMEOUTS_MAX           2                                           /**< Sends abandoned in a row before the CC1101 is reset. */
+#define RADIO_CCA_ATTEMPTS_MAX          4                                           /**< STX refused by the clear channel assessment before a packet is dropped. */
+#define LINK_KEEPALIVE_INTERVAL         APP_TIMER_TICKS(1000, APP_TIMER_PRESCALER)  /**< Interval of the credit frames sent even when the credits did not change (1 second). */
+#define FLASH_RETRY_INTERVAL            APP_TIMER_TICKS(20, APP_TIMER_PRESCALER)    /**< Delay before a flash operation held back by the radio is tried again (20 ms). */
+#define RADIO_FLASH_QUIET               APP_TIMER_TICKS(100, APP_TIMER_PRESCALER)   /**< Radio silence after which any flash stall is allowed (100 ms). */
+#define RADIO_PACKET_AIR_BITS           ((4 + 4 + 1 + RADIO_PACKET_MAX + 2) * 8)    /**< Preamble, sync word, length, longest packet and CRC. */
+#define LED_RCV_INTERVAL                APP_TIMER_TICKS(100, APP_TIMER_PRESCALER)   /**< Shortest time between two indications of received radio data (100 ms). */
+#define LFCLK_XTAL_TIMEOUT_MS           1000                                        /**< Longest start of the 32.768 kHz crystal before the RC oscillator is used instead, a few hundred ms typical. */
+#define RADIO_RUN_TIME                  APP_TIMER_TICKS(1, APP_TIMER_PRESCALER)     /**< Longest radio work run, an RX FIFO drain and a TX FIFO load at 4 MHz SPI (1 ms). */
+#define CONN_INTERVAL_TICKS(interval)   ROUNDED_DIV((uint64_t)(interval) * 1250 * APP_TIMER_CLOCK_FREQ, \
+                                                    1000000 * (APP_TIMER_PRESCALER + 1)) /**< Connection interval, in 1.25 ms units, in RTC1 ticks. */
+
 
 #define DELAY_MS                 1000                /**< Timer Delay in milli-seconds. */
-#define TX_RX_BUF_LENGTH         16u                 /**< SPI transaction buffer length. */
+#define SPI_FREQUENCY            NRF_DRV_SPI_FREQ_4M /**< Highest nRF51 SPI clock within the CC1101 burst limit (6.5 MHz without delay between bytes). */
+#define SPI_BENCH_RUNS           64                  /**< Transactions per measurement of CTRL_CMD_SPI_BENCH. */
+#define SPI_BENCH_BURST          48u                 /**< Length of the burst measured by CTRL_CMD_SPI_BENCH: address and the 47 configuration registers. */
 
 
 
@@ -108,20 +205,141 @@
 
 
 
+/**@brief States of the radio driver. */
+typedef enum
+{
+    RADIO_STATE_INIT,                                                               /**< Reset sequence in progress. */
+    RADIO_STATE_RX,                                                                 /**< Receiving, packets may be sent. */
+    RADIO_STATE_TX,                                                                 /**< Sending a packet. */
+    RADIO_STATE_DOWN,                                                               /**< In a low power state, see @ref power_mgr. */
+    RADIO_STATE_WAKE                                                                /**< Crystal starting after XOFF or SLEEP. */
+} radio_state_t;
+
+/**@brief Radio driver statistics, see @ref CTRL_STATS_PAGE_RADIO. */
+typedef struct
+{
+    uint32_t rx_packets;                                                            /**< Packets received with a valid CRC. */
+    uint32_t rx_crc_errors;                                                         /**< Packets received with a bad CRC. */
+    uint32_t rx_overflows;                                                          /**< RX FIFO overflows and bad length bytes. */
+    uint32_t tx_packets;                                                            /**< Packets sent. */
+    uint32_t tx_timeouts;                                                           /**< Packets that were still being sent after RADIO_TX_TIMEOUT. */
+    uint32_t rdy_timeouts;                                                          /**< SPI accesses or resets abandoned because CHIP_RDYn stayed high. */
+    uint32_t tx_underflows;                                                         /**< TX FIFO underflows seen in the chip status byte. */
+    uint32_t spi_accesses;                                                          /**< CC1101 SPI accesses, strobes included. */
+    uint32_t cca_busy;                                                              /**< STX refused because the channel was busy. */
+    uint32_t cca_drops;                                                             /**< Packets dropped after RADIO_CCA_ATTEMPTS_MAX refusals, beacons after one. */
+} radio_stats_t;
+
+/**@brief Traffic classes of the radio sink, in priority order (see @ref pkt_sched).
+ *
+ * @details The link control frames (credits and beacons) do not go through these queues, see
+ *          @ref radio_link_poll and @ref radio_sync_poll. The priority class is empty unless a
+ *          port is moved to it with @ref CTRL_CMD_CLASS_SET.
+ */
+typedef enum
+{
+    RADIO_CLASS_PRIORITY    = 0,                                                    /**< Always sent first, no port by default. */
+    RADIO_CLASS_INTERACTIVE = 1,                                                    /**< Short interactive traffic, port 0 by default. */
+    RADIO_CLASS_BULK        = 2,                                                    /**< Transfers, ports 1 and up by default. */
+    RADIO_CLASS_COUNT
+} radio_class_t;
+
 static ble_nus_t                        m_nus;                                      /**< Structure to identify the Nordic UART Service. */
 static uint16_t                         m_conn_handle = BLE_CONN_HANDLE_INVALID;    /**< Handle of the current connection. */
 
 static ble_uuid_t                       m_adv_uuids[] = {{BLE_UUID_NUS_SERVICE, NUS_SERVICE_UUID_TYPE}};  /**< Universally unique service identifier. */
 
+static pkt_t                            m_nus_tx_buf[NUS_TX_QUEUE_SIZE];            /**< Storage for the NUS sink queue. */
+static pkt_queue_t                      m_nus_tx_queue;                             /**< Packets waiting to be notified over NUS. */
+static uint8_t                          m_nus_tx_offset = 0;                        /**< Bytes of the oldest NUS packet already notified. */
+static pkt_t                            m_uart_tx_buf[UART_TX_QUEUE_SIZE];          /**< Storage for the UART sink queue. */
+static pkt_queue_t                      m_uart_tx_queue;                            /**< Packets waiting to be written to the UART. */
+static uint8_t                          m_uart_tx_frame[MAX(UART_FRAME_ENCODED_MAX, PKT_QUEUE_DATA_MAX + 1)]; /**< Line or encoded frame being written to the UART. */
+static uint8_t                          m_uart_tx_len = 0;                          /**< Number of bytes in m_uart_tx_frame. */
+static uint8_t                          m_uart_tx_offset = 0;                       /**< Bytes of m_uart_tx_frame already in the app_uart TX FIFO. */
+static pkt_t                            m_radio_priority_buf[RADIO_PRIORITY_QUEUE_SIZE]; /**< Storage for the radio priority class queue. */
+static pkt_t                            m_radio_interactive_buf[RADIO_INTERACTIVE_QUEUE_SIZE]; /**< Storage for the radio interactive class queue. */
+static pkt_t                            m_radio_bulk_buf[RADIO_BULK_QUEUE_SIZE];    /**< Storage for the radio bulk class queue. */
+static pkt_queue_t                      m_radio_tx_queues[RADIO_CLASS_COUNT];       /**< Packets waiting to be sent over the radio, per traffic class. */
+static pkt_sched_t                      m_radio_sched;                              /**< Order in which the radio serves its classes. */
+static link_credit_t                    m_link;                                     /**< Flow control with the extender at the other end of the radio link. */
+static volatile bool                    m_link_keepalive_due = true;                /**< A credit frame is sent even if the credits did not change. */
+APP_TIMER_DEF(m_link_keepalive_timer_id);                                           /**< Sets m_link_keepalive_due. */
+static ble_credit_t                     m_ble_credit;                               /**< Write limit characteristic of the NUS client. */
+static ble_energy_t                     m_ble_energy;                               /**< Energy estimate characteristic of the NUS client. */
+APP_TIMER_DEF(m_energy_timer_id);                                                   /**< Reports the energy estimate. */
+static uint16_t                         m_nus_rx_count = 0;                         /**< Writes received from the NUS client during this connection. */
+static uint32_t                         m_nus_overruns = 0;                         /**< Writes received beyond the write limit. */
+static volatile bool                    m_radio_evt_pending = false;                /**< radio_evt_handler is in the scheduler queue. */
+static pkt_t                            m_rtt_tx_buf[RTT_TX_QUEUE_SIZE];            /**< Storage for the RTT sink queue. */
+static pkt_queue_t                      m_rtt_tx_queue;                             /**< Packets waiting to be printed on RTT. */
+APP_TIMER_DEF(m_rtt_poll_timer_id);                                                 /**< Polls RTT input. */
+static uint8_t                          m_rtt_ctrl_up_buf[RTT_CTRL_BUF_SIZE];       /**< Control responses waiting for the debugger. */
+static uint8_t                          m_rtt_ctrl_down_buf[RTT_CTRL_BUF_SIZE];     /**< Control requests written by the debugger. */
+static uint8_t                          m_rtt_ctrl_req[RTT_CTRL_REQ_MAX];           /**< Control request being received from RTT. */
+static uint8_t                          m_rtt_ctrl_len = 0;                         /**< Length of the request being received, 0 while waiting for the length byte. */
+static uint8_t                          m_rtt_ctrl_pos = 0;                         /**< Bytes of the request received so far. */
+static bool                             m_uart_rx_held = false;                     /**< UART receiver stopped (RTS deasserted) because a sink of the UART is full. */
+static volatile bool                    m_uart_rx_evt_pending = false;              /**< uart_rx_evt_handler is in the scheduler queue. */
+static volatile bool                    m_uart_tx_evt_pending = false;              /**< uart_tx_evt_handler is in the scheduler queue. */
+
+#if (UART_FRAMING == UART_FRAMING_COBS)
+static uart_frame_decoder_t             m_uart_decoder;                             /**< Decoder of the frames received on the UART. */
+#else
+static uint8_t                          m_uart_line[BLE_NUS_MAX_DATA_LEN];          /**< Line being received on the UART. */
+static uint8_t                          m_uart_line_len = 0;                        /**< Number of characters in m_uart_line. */
+static uint32_t                         m_uart_last_rx_ticks;                       /**< RTC1 counter when the last character was received. */
+static bool                             m_uart_idle_timer_running = false;          /**< The UART idle timer is started. */
+APP_TIMER_DEF(m_uart_idle_timer_id);                                                /**< Flushes a partial line after UART_IDLE_CHARS of silence. */
+#endif
 
-// Data buffers.
-static uint8_t m_tx_data[TX_RX_BUF_LENGTH] = {0}; /**< A buffer with data to transfer. */
-static uint8_t txt_data[TX_RX_BUF_LENGTH] = {0}; /**< A buffer with data to transfer. */
-static uint8_t m_rx_data[TX_RX_BUF_LENGTH] = {0}; /**< A buffer for incoming data. */
-static bool newData = false;
-static volatile bool sendPacket = false;
-static volatile bool receivePacket = false;
-static volatile bool pinToggle = false;
+/**@brief Counters of the UART side of the bridge, published as @ref CTRL_STATS_PAGE_UART. */
+typedef struct
+{
+    uint32_t rx_frames;                                                             /**< Frames with a valid CRC received (binary mode). */
+    uint32_t rx_crc_errors;                                                         /**< Frames dropped because of a bad CRC (binary mode). */
+    uint32_t rx_format_errors;                                                      /**< Frames dropped because of bad encoding or length (binary mode). */
+    uint32_t tx_frames;                                                             /**< Frames sent to the UART (binary mode). */
+    uint32_t tx_dropped;                                                            /**< Control responses dropped because the UART sink queue was full (binary mode). */
+    uint32_t uplink_dropped;                                                        /**< Packets discarded by the NUS sink because no peer had notifications enabled. */
+    uint32_t uplink_holds;                                                          /**< Number of times the UART peer was held off with RTS. */
+    uint32_t flush_full;                                                            /**< Lines sent because they reached BLE_NUS_MAX_DATA_LEN (text mode). */
+    uint32_t flush_delimiter;                                                       /**< Lines sent because of a '\n' (text mode). */
+    uint32_t flush_idle;                                                            /**< Partial lines sent after UART_IDLE_CHARS of silence (text mode). */
+} uart_stats_t;
+
+static uart_stats_t                     m_uart_stats;                               /**< UART statistics. */
+
+
+static cc1101_t                         m_radio;                                    /**< CC1101 driver context. */
+static radio_state_t                    m_radio_state = RADIO_STATE_INIT;           /**< State of the radio driver. */
+static seq_t                            m_radio_seq;                                /**< Non-blocking sequences of the radio driver. */
+APP_TIMER_DEF(m_radio_seq_timer_id);                                                /**< Timer of m_radio_seq. */
+static radio_stats_t                    m_radio_stats;                              /**< Radio driver statistics. */
+static cc1101_shadow_t                  m_radio_shadow;                             /**< Configuration the CC1101 holds. */
+static uint8_t                          m_radio_profile = RADIO_PROFILE_DEFAULT;    /**< Radio profile the CC1101 is configured with. */
+static uint8_t                          m_radio_profile_next = RADIO_PROFILE_DEFAULT; /**< Radio profile requested, applied between two packets. */
+static uint32_t                         m_radio_last_activity;                      /**< RTC1 counter at the end of the last packet sent or received. */
+static power_mgr_state_t                m_radio_wake_next;                          /**< State entered once the wake in progress is done, IDLE to go on receiving. */
+APP_TIMER_DEF(m_flash_sched_timer_id);                                              /**< Timer of the flash scheduler. */
+APP_TIMER_DEF(m_radio_power_timer_id);                                              /**< Posts the radio work when a deeper low power state is allowed or a slot changes. */
+static slot_sync_slot_t                 m_radio_slot = SLOT_SYNC_FREE;              /**< What the radio may do, see @ref slot_sync. */
+static uint32_t                         m_radio_slot_next;                          /**< RTC1 ticks until m_radio_slot changes, 0 if it does not by itself. */
+static radio_ts_frame_t                 m_radio_rx_ts;                              /**< Timestamps of the last packet received. */
+static bool                             m_radio_rx_ts_valid = false;                /**< m_radio_rx_ts has the sync word of the last packet received. */
+static bool                             m_radio_rx_end_valid = false;               /**< m_radio_rx_ts has the end of the last packet received. */
+static bool                             m_radio_tx_beacon = false;                  /**< The packet being sent is a beacon of @ref slot_sync. */
+static uint8_t                          m_radio_cca_attempts;                       /**< STX refused for the packet in the TX FIFO. */
+static uint32_t                         m_radio_airtime;                            /**< Air time of the longest packet at the data rate in use, in RTC1 ticks. */
+static bool                             m_radio_spi_fault = false;                  /**< An SPI burst failed since the last recovery. */
+static bool                             m_spi_ready = false;                        /**< The SPI master of the CC1101 is initialized. */
+static uint8_t                          m_radio_fifo_errors = 0;                    /**< RX FIFO errors since the last packet received. */
+static uint8_t                          m_radio_tx_timeouts = 0;                    /**< Sends abandoned since the last packet sent. */
+static uint32_t                         m_radio_rdy_timeouts_seen = 0;              /**< m_radio.rdy_timeouts when the CC1101 was last configured. */
+static volatile bool                    m_radio_check_due = false;                  /**< The configuration of the CC1101 is checked on the next radio run. */
+static volatile bool                    m_led_evt_pending = false;                  /**< led_evt_handler is in the scheduler queue. */
+static uint32_t                         m_led_rcv_last;                             /**< RTC1 counter when received radio data was last indicated. */
+static nrf_clock_lfclksrc_t             m_lfclk_src = NRF_CLOCK_LFCLKSRC_XTAL_20_PPM; /**< LFCLK source started by lfclk_start, given to the SoftDevice. */
 static volatile bool m_transfer_completed = true; /**< A flag to inform about completed transfer. */
 
 /*
@@ -135,7 +353,11 @@ static volatile bool m_transfer_completed = true; /**< A flag to inform about co
 #
 */
 void CC1101_Init(void);
+static void CC1101_Recover(recovery_cause_t cause);
+static bool CC1101_ChipReady(void);
 void CC1101_Calibrate(void);
+static void radio_evt_handler(void * p_event_data, uint16_t event_size);
+static void spi_start(void);
 
 
 
@@ -171,113 +393,145 @@ void app_error_handler(uint32_t error_code, uint32_t line_num, const uint8_t * p
 {
     UNUSED_VARIABLE(bsp_indication_set(BSP_INDICATE_FATAL_ERROR));
 
-    for (;;)
-    {
-        // No implementation needed.
-    }
+    // Only SoftDevice asserts and errors of the nRF51 side come here. Errors of the SPI master and
+    // of the CC1101 start a radio recovery instead, see radio_fault_poll.
+    recovery_crash(error_code, line_num, p_file_name);
 }
-/**@brief Function for checking if data coming from a SPI slave are valid.
+/**@brief Function for SPI master event callback.
  *
- * @param[in] p_buf     A pointer to a data buffer.
- * @param[in] len       A length of the data buffer.
- * 
- * @note Expected ASCII characters from: 'a' to: ('a' + len - 1).
+ * @details Runs at APP_IRQ_PRIORITY_HIGH for every transfer, down to 2 byte register accesses, so
+ *          it only records the completion. @ref cc1101_hal_burst waits for it.
  *
- * @retval true     Data are valid.
- * @retval false    Data are invalid.
+ * @param[in] spi_master_evt    SPI master driver event.
  */
-static __INLINE bool buf_check(uint8_t * p_buf, uint16_t len)
+static void spi_master_event_handler(nrf_drv_spi_event_t event)
 {
+    uint16_t start = isr_prof_enter(ISR_PROF_SPI);
 
-    return true;
+    if (event == NRF_DRV_SPI_EVENT_DONE)
+    {
+        m_transfer_completed = true;
+    }
+
+    isr_prof_exit(ISR_PROF_SPI, start);
 }
 
 
-/**@brief Function for SPI master event callback.
- *
- * Upon receiving an SPI transaction complete event, checks if received data are valid.
+/**@brief Function for an interrupt driven transfer on the SPI master, for the long bursts of
+ *        @ref cc1101.
  *
- * @param[in] spi_master_evt    SPI master driver event.
+ * @details The SPI interrupt runs at APP_IRQ_PRIORITY_HIGH, so a burst keeps its pace while the
+ *          UART or GPIOTE handlers preempt the main loop. Strobes and register accesses, most of
+ *          the traffic, are polled by the driver HAL instead: at SPI_FREQUENCY a byte takes less
+ *          time than entering the interrupt handler.
  */
-static void spi_master_event_handler(nrf_drv_spi_event_t event)
+void cc1101_hal_burst(uint8_t const * p_tx_data, uint8_t * p_rx_data, uint16_t len)
 {
-    uint32_t err_code = NRF_SUCCESS;
-    bool result = false;
+    uint32_t start;
+    uint32_t now;
+    uint32_t elapsed = 0;
 
-    switch (event)
+    m_transfer_completed = false;
+    if (!m_spi_ready ||
+        (nrf_drv_spi_transfer(&m_spi_master, p_tx_data, len, p_rx_data, len) != NRF_SUCCESS))
     {
-        case NRF_DRV_SPI_EVENT_DONE:
-            // Check if data are valid.
-            result = buf_check(m_rx_data, TX_RX_BUF_LENGTH);
-            APP_ERROR_CHECK_BOOL(result);
-
-            err_code = bsp_indication_set(BSP_INDICATE_RCV_OK);
-            APP_ERROR_CHECK(err_code);
+        // The radio work starts a recovery, see radio_fault_poll.
+        m_radio_spi_fault = true;
+        return;
+    }
 
-            // Inform application that transfer is completed.
-            m_transfer_completed = true;
-            break;
+    // The driver reads p_rx_data right away, wait for spi_master_event_handler.
+    UNUSED_VARIABLE(app_timer_cnt_get(&start));
+    while (!m_transfer_completed && (elapsed < RADIO_BURST_TIMEOUT))
+    {
+        UNUSED_VARIABLE(app_timer_cnt_get(&now));
+        UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, start, &elapsed));
+    }
 
-        default:
-            // No implementation needed.
-            break;
+    if (!m_transfer_completed)
+    {
+        // Start the SPI master over, the driver still waits for this transfer.
+        spi_start();
+        m_transfer_completed = true;
+        m_radio_spi_fault    = true;
     }
 }
 
 
-/**@brief The function initializes TX buffer to values to be sent and clears RX buffer.
+
+
+//SPI functions end ------------------------------------------------------------------------------------------------------------
+
+
+/**@brief Function for posting a handler to the scheduler, unless it is already waiting there.
  *
- * @note Function initializes TX buffer to values from 'A' to ('A' + len - 1)
- *       and clears RX buffer (fill by 0).
+ * @details Interrupts that fire in bursts (every UART byte, every packet routed to the radio) post
+ *          the same handler over and over, so the scheduler queue only ever holds one copy of it.
+ *          The handler clears its flag before doing its work, so an event arriving while it runs
+ *          posts it again.
  *
- * @param[in] p_tx_data     A pointer to a buffer TX.
- * @param[in] p_rx_data     A pointer to a buffer RX.
- * @param[in] len           A length of the data buffers.
+ * @param[inout] p_pending  Flag of the handler.
+ * @param[in]    handler    Handler to run from the main loop.
  */
-static void init_buffers(uint8_t * const p_tx_data, uint8_t * const p_rx_data, const uint16_t  len)
+static void sched_post(volatile bool * p_pending, app_sched_event_handler_t handler)
 {
-    uint16_t i;
-    
-    for (i = 0; i < len; i++)
+    uint32_t err_code;
+    bool     post;
+
+    CRITICAL_REGION_ENTER();
+    post       = !*p_pending;
+    *p_pending = true;
+    CRITICAL_REGION_EXIT();
+
+    if (post)
     {
-        p_tx_data[i] = m_tx_data[i];
-        p_rx_data[i] = 0;
+        err_code = app_sched_event_put(NULL, 0, handler);
+        APP_ERROR_CHECK(err_code);
     }
-        
-        
 }
 
 
-/**@brief Functions prepares buffers and starts data transfer.
+/**@brief Function for scheduling the radio work: receive, send credits, send the next packet.
  *
- * @param[in] p_tx_data     A pointer to a buffer TX.
- * @param[in] p_rx_data     A pointer to a buffer RX.
- * @param[in] len           A length of the data buffers.
+ * @details Used as the kick of the radio sink and as the resume callback of the radio source.
  */
-static void spi_send_recv(uint8_t * const p_tx_data,
-                          uint8_t * const p_rx_data,
-                          const uint16_t  len)
+static void radio_evt_post(void)
 {
-    // Initalize buffers.
-    init_buffers(p_tx_data, p_rx_data, len);
-        
-    
-    // Start transfer.
-    
-    uint32_t err_code = nrf_drv_spi_transfer(&m_spi_master,
-        p_tx_data, len, p_rx_data, len);
-    //m_tx_data
-    //SEGGER_RTT_printf(0, "\nSent: %s\n", p_tx_data);
-    //SEGGER_RTT_printf(0, "\nRecieved: %s\n", p_rx_data);
-    
-    APP_ERROR_CHECK(err_code);
-    //nrf_delay_us(10);
+    sched_post(&m_radio_evt_pending, radio_evt_handler);
 }
 
 
+/**@brief Function for showing received radio data on the LEDs, from the main loop.
+ */
+static void led_evt_handler(void * p_event_data, uint16_t event_size)
+{
+    uint32_t err_code;
+
+    m_led_evt_pending = false;
+    UNUSED_VARIABLE(app_timer_cnt_get(&m_led_rcv_last));
+
+    err_code = bsp_indication_set(BSP_INDICATE_RCV_OK);
+    APP_ERROR_CHECK(err_code);
+}
 
 
-//SPI functions end ------------------------------------------------------------------------------------------------------------
+/**@brief Function for indicating received radio data, at most once per LED_RCV_INTERVAL.
+ *
+ * @details bsp_indication_set reprograms the LED timers, which takes far longer than the radio
+ *          work itself. It runs later from the scheduler, and a burst of packets blinks once.
+ */
+static void led_rcv_indicate(void)
+{
+    uint32_t now;
+    uint32_t elapsed;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_led_rcv_last, &elapsed));
+    if (elapsed >= LED_RCV_INTERVAL)
+    {
+        sched_post(&m_led_evt_pending, led_evt_handler);
+    }
+}
 
 
 
@@ -311,535 +565,2302 @@ static void gap_params_init(void)
 }
 
 
+#if (UART_FRAMING == UART_FRAMING_COBS)
+/**@brief Function for sending a control channel response to the UART.
+ */
+static void uart_ctrl_send(uint8_t const * p_data, uint8_t length)
+{
+    if (router_sink_put(ROUTER_EP_UART, ROUTER_PORT_CTRL, p_data, length) != NRF_SUCCESS)
+    {
+        m_uart_stats.tx_dropped++;
+    }
+}
+#endif // UART_FRAMING_COBS
+
+
+/**@brief Function for updating the write limit of the NUS client.
+ *
+ * @details The client may write as many packets as the sinks of NUS can still queue. Called after
+ *          every write and by the @ref router every time a sink frees a slot.
+ */
+static void nus_credit_update(void)
+{
+    ble_credit_limit_set(&m_ble_credit, m_nus_rx_count + MIN(router_space(ROUTER_EP_NUS), LINK_CREDIT_SPACE_MAX));
+}
+
+
 /**@brief Function for handling the data from the Nordic UART Service.
  *
- * @details This function will process the data received from the Nordic UART BLE Service and send
- *          it to the UART module.
+ * @details This function will process the data received from the Nordic UART BLE Service and
+ *          hand it to the @ref router as a packet on port 0. A client that ignores the write limit
+ *          of @ref ble_credit is counted in @ref CTRL_STATS_PAGE_LINK.
  *
  * @param[in] p_nus    Nordic UART Service structure.
- * @param[in] p_data   Data to be send to UART module.
+ * @param[in] p_data   Data written by the peer.
  * @param[in] length   Length of the data.
  */
 /**@snippet [Handling the data received over BLE] */
-
-
 static void nus_data_handler(ble_nus_t * p_nus, uint8_t * p_data, uint16_t length)
-{        SEGGER_RTT_WriteString(0, "received data \n");
-        newData = true;
-        memset(txt_data,0,sizeof(txt_data));
-    for (uint32_t i = 0; i < length; i++)
+{
+    if (router_is_blocked(ROUTER_EP_NUS))
     {
-                //m_tx_data[i] = p_data[i];
-                txt_data[i] = p_data[i];
-                SEGGER_RTT_printf(0,"%c", p_data[i]);
-        while(app_uart_put(p_data[i]) != NRF_SUCCESS);
+        m_nus_overruns++;
     }
-      SEGGER_RTT_printf(0, "to send: %s\n", txt_data);
-        SEGGER_RTT_WriteString(0, "\n");
-    while(app_uart_put('\n') != NRF_SUCCESS);
-        
+
+    m_nus_rx_count++;
+    UNUSED_VARIABLE(router_put(ROUTER_EP_NUS, 0, p_data, (uint8_t)length));
+    nus_credit_update();
 }
 /**@snippet [Handling the data received over BLE] */
 
 
-
-/**@brief Function for initializing services that will be used by the application.
+/**@brief Function for holding off the UART peer.
+ *
+ * @details Stopping the receiver makes the UART deassert RTS (hardware flow control is enabled in
+ *          @ref uart_init). Bytes already on the wire still land in the app_uart RX FIFO.
  */
-static void services_init(void)
+static void uart_rx_hold(void)
 {
-    uint32_t       err_code;
-    ble_nus_init_t nus_init;
-    
-    memset(&nus_init, 0, sizeof(nus_init));
+    NRF_UART0->TASKS_STOPRX = 1;
+    m_uart_rx_held          = true;
+    m_uart_stats.uplink_holds++;
+}
 
-    nus_init.data_handler = nus_data_handler;
-    
-    err_code = ble_nus_init(&m_nus, &nus_init);
-    APP_ERROR_CHECK(err_code);
+
+/**@brief Function for letting the UART peer send again after @ref uart_rx_hold.
+ */
+static void uart_rx_release(void)
+{
+    m_uart_rx_held          = false;
+    NRF_UART0->TASKS_STARTRX = 1;
 }
 
 
-/**@brief Function for handling an event from the Connection Parameters Module.
+/**@brief Function for routing a complete line or data frame received on the UART.
  *
- * @details This function will be called for all events in the Connection Parameters Module
- *          which are passed to the application.
+ * @details The UART is held as soon as a sink of the UART is full, so a slot is always available
+ *          for the next packet.
+ */
+static void uart_rx_put(uint8_t port, uint8_t const * p_data, uint8_t length)
+{
+    UNUSED_VARIABLE(router_put(ROUTER_EP_UART, port, p_data, length));
+
+    if (router_is_blocked(ROUTER_EP_UART))
+    {
+        uart_rx_hold();
+    }
+}
+
+
+/**@brief Function for routing received UART bytes.
  *
- * @note All this function does is to disconnect. This could have been done by simply setting
- *       the disconnect_on_fail config parameter, but instead we use the event handler
- *       mechanism to demonstrate its use.
+ * @details In text mode bytes are appended to a line which is routed when the last character
+ *          received was a 'new line' i.e '\n' (hex 0x0A) or when the line has reached a length of
+ *          @ref BLE_NUS_MAX_DATA_LEN. In binary mode data frames are routed on the port of their
+ *          channel byte and control frames are executed by @ref ctrl_on_request.
  *
- * @param[in] p_evt  Event received from the Connection Parameters Module.
+ *          As soon as a sink is full the UART is held, and the remaining bytes stay in the
+ *          app_uart FIFO until @ref uart_rx_resume is called.
  */
-static void on_conn_params_evt(ble_conn_params_evt_t * p_evt)
+static void uart_rx_drain(void)
 {
+#if (UART_FRAMING == UART_FRAMING_COBS)
+    uint8_t byte;
+    uint8_t channel;
+
+    while (!m_uart_rx_held && (app_uart_get(&byte) == NRF_SUCCESS))
+    {
+        if (!uart_frame_decoder_put(&m_uart_decoder, byte))
+        {
+            continue;
+        }
+
+        channel = uart_frame_channel(&m_uart_decoder);
+        switch (UART_FRAME_CH(channel))
+        {
+            case UART_FRAME_CH_DATA:
+                if (uart_frame_payload_len(&m_uart_decoder) > 0)
+                {
+                    uart_rx_put(UART_FRAME_PORT(channel),
+                                uart_frame_payload(&m_uart_decoder),
+                                uart_frame_payload_len(&m_uart_decoder));
+                }
+                break;
+
+            case UART_FRAME_CH_CTRL:
+                ctrl_on_request(uart_frame_payload(&m_uart_decoder),
+                                uart_frame_payload_len(&m_uart_decoder),
+                                uart_ctrl_send);
+                break;
+
+            default:
+                m_uart_decoder.stats.format_errors++;
+                break;
+        }
+    }
+#else
     uint32_t err_code;
-    
-    if(p_evt->evt_type == BLE_CONN_PARAMS_EVT_FAILED)
+    bool     received = false;
+
+    while (!m_uart_rx_held && (app_uart_get(&m_uart_line[m_uart_line_len]) == NRF_SUCCESS))
     {
-        err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_CONN_INTERVAL_UNACCEPTABLE);
+        received = true;
+        m_uart_line_len++;
+
+        if (m_uart_line[m_uart_line_len - 1] == '\n')
+        {
+            m_uart_stats.flush_delimiter++;
+        }
+        else if (m_uart_line_len >= (BLE_NUS_MAX_DATA_LEN))
+        {
+            m_uart_stats.flush_full++;
+        }
+        else
+        {
+            continue;
+        }
+
+        uart_rx_put(0, m_uart_line, m_uart_line_len);
+        m_uart_line_len = 0;
+    }
+
+    if (received)
+    {
+        UNUSED_VARIABLE(app_timer_cnt_get(&m_uart_last_rx_ticks));
+    }
+
+    // Bound the latency of a partial line. The timer is started once per line, not per character.
+    if ((m_uart_line_len > 0) && !m_uart_idle_timer_running)
+    {
+        err_code = app_timer_start(m_uart_idle_timer_id, UART_IDLE_TIMEOUT, NULL);
         APP_ERROR_CHECK(err_code);
+        m_uart_idle_timer_running = true;
     }
+#endif
 }
 
 
-/**@brief Function for handling errors from the Connection Parameters module.
+/**@brief Function for releasing the UART once its sinks have room again.
  *
- * @param[in] nrf_error  Error code containing information about what went wrong.
+ * @details Called by the @ref router every time a sink frees a slot.
  */
-static void conn_params_error_handler(uint32_t nrf_error)
+static void uart_rx_resume(void)
 {
-    APP_ERROR_HANDLER(nrf_error);
+    if (m_uart_rx_held && !router_is_blocked(ROUTER_EP_UART))
+    {
+        uart_rx_release();
+        uart_rx_drain();
+    }
 }
 
 
-/**@brief Function for initializing the Connection Parameters module.
+#if (UART_FRAMING == UART_FRAMING_LINE)
+/**@brief Function for handling the UART idle timer timeout.
+ *
+ * @details Sends the partial line if nothing was received for @ref UART_IDLE_CHARS character
+ *          times, otherwise waits for the rest of that time. A held UART is left alone, the line is
+ *          handled once @ref uart_rx_resume releases it.
+ *
+ * @param[in] p_context  Not used.
  */
-static void conn_params_init(void)
+static void uart_idle_timeout_handler(void * p_context)
 {
-    uint32_t               err_code;
-    ble_conn_params_init_t cp_init;
-    
-    memset(&cp_init, 0, sizeof(cp_init));
+    uint32_t now;
+    uint32_t idle;
+    uint32_t err_code;
 
-    cp_init.p_conn_params                  = NULL;
-    cp_init.first_conn_params_update_delay = FIRST_CONN_PARAMS_UPDATE_DELAY;
-    cp_init.next_conn_params_update_delay  = NEXT_CONN_PARAMS_UPDATE_DELAY;
-    cp_init.max_conn_params_update_count   = MAX_CONN_PARAMS_UPDATE_COUNT;
-    cp_init.start_on_notify_cccd_handle    = BLE_GATT_HANDLE_INVALID;
-    cp_init.disconnect_on_fail             = false;
-    cp_init.evt_handler                    = on_conn_params_evt;
-    cp_init.error_handler                  = conn_params_error_handler;
-    
-    err_code = ble_conn_params_init(&cp_init);
-    APP_ERROR_CHECK(err_code);
-}
+    UNUSED_PARAMETER(p_context);
+    m_uart_idle_timer_running = false;
 
+    if (m_uart_rx_held || (m_uart_line_len == 0))
+    {
+        return;
+    }
 
-/**@brief Function for putting the chip into sleep mode.
- *
- * @note This function will not return.
- */
-static void sleep_mode_enter(void)
-{
-    uint32_t err_code = bsp_indication_set(BSP_INDICATE_IDLE);
-    APP_ERROR_CHECK(err_code);
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_uart_last_rx_ticks, &idle));
 
-    // Prepare wakeup buttons.
-    err_code = bsp_btn_ble_sleep_mode_prepare();
-    APP_ERROR_CHECK(err_code);
+    if (idle < UART_IDLE_TIMEOUT)
+    {
+        err_code = app_timer_start(m_uart_idle_timer_id,
+                                   MAX(UART_IDLE_TIMEOUT - idle, APP_TIMER_MIN_TIMEOUT_TICKS),
+                                   NULL);
+        APP_ERROR_CHECK(err_code);
+        m_uart_idle_timer_running = true;
+        return;
+    }
 
-    // Go to system-off mode (this function will not return; wakeup will cause a reset).
-    err_code = sd_power_system_off();
-    APP_ERROR_CHECK(err_code);
+    m_uart_stats.flush_idle++;
+    uart_rx_put(0, m_uart_line, m_uart_line_len);
+    m_uart_line_len = 0;
 }
+#endif // UART_FRAMING_LINE
 
 
-/**@brief Function for handling advertising events.
+/**@brief Function for writing queued packets to the UART.
  *
- * @details This function will be called for advertising events which are passed to the application.
- *
- * @param[in] ble_adv_evt  Advertising event.
+ * @details Every packet is written as a line in text mode or as a frame in binary mode. What does
+ *          not fit in the app_uart TX FIFO is written from APP_UART_TX_EMPTY, so frames are never
+ *          cut short or interleaved.
  */
-static void on_adv_evt(ble_adv_evt_t ble_adv_evt)
+static void uart_tx_pump(void)
 {
-    uint32_t err_code;
+    pkt_t * p_pkt;
 
-    switch (ble_adv_evt)
+    for (;;)
     {
-        case BLE_ADV_EVT_FAST:
-            err_code = bsp_indication_set(BSP_INDICATE_ADVERTISING);
-            APP_ERROR_CHECK(err_code);
-            break;
-        case BLE_ADV_EVT_IDLE:
-            sleep_mode_enter();
-            break;
-        default:
-            break;
+        while (m_uart_tx_offset < m_uart_tx_len)
+        {
+            if (app_uart_put(m_uart_tx_frame[m_uart_tx_offset]) != NRF_SUCCESS)
+            {
+                return;
+            }
+            m_uart_tx_offset++;
+        }
+
+        p_pkt = pkt_queue_peek(&m_uart_tx_queue);
+        if (p_pkt == NULL)
+        {
+            return;
+        }
+
+#if (UART_FRAMING == UART_FRAMING_COBS)
+        UNUSED_VARIABLE(uart_frame_encode((p_pkt->port == ROUTER_PORT_CTRL) ?
+                                              UART_FRAME_CH_BYTE(UART_FRAME_CH_CTRL, 0) :
+                                              UART_FRAME_CH_BYTE(UART_FRAME_CH_DATA, p_pkt->port),
+                                          p_pkt->data,
+                                          p_pkt->length,
+                                          m_uart_tx_frame,
+                                          &m_uart_tx_len));
+        m_uart_stats.tx_frames++;
+#else
+        memcpy(m_uart_tx_frame, p_pkt->data, p_pkt->length);
+        m_uart_tx_frame[p_pkt->length] = '\n';
+        m_uart_tx_len                  = p_pkt->length + 1;
+#endif
+        m_uart_tx_offset = 0;
+        router_sink_pop(ROUTER_EP_UART, 0);
     }
 }
 
 
-/**@brief Function for the Application's S110 SoftDevice event handler.
+/**@brief Function for sending queued packets as NUS notifications.
  *
- * @param[in] p_ble_evt S110 SoftDevice event.
+ * @details Notifications are sent until the SoftDevice runs out of TX buffers, so every buffer
+ *          available in a connection event is used. The pump is restarted from
+ *          BLE_EVT_TX_COMPLETE. Packets longer than @ref BLE_NUS_MAX_DATA_LEN are split over
+ *          several notifications. A packet is only removed from the queue once the SoftDevice has
+ *          accepted all of it.
  */
-static void on_ble_evt(ble_evt_t * p_ble_evt)
+static void nus_tx_pump(void)
 {
-    uint32_t                         err_code;
-    
-    switch (p_ble_evt->header.evt_id)
+    pkt_t  * p_pkt;
+    uint16_t length;
+    uint32_t err_code;
+
+    while ((p_pkt = pkt_queue_peek(&m_nus_tx_queue)) != NULL)
     {
-        case BLE_GAP_EVT_CONNECTED:
-                    SEGGER_RTT_WriteString(0, "CONNECTED\n");
-            err_code = bsp_indication_set(BSP_INDICATE_CONNECTED);
-            APP_ERROR_CHECK(err_code);
-            m_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
-            break;
-            
-        case BLE_GAP_EVT_DISCONNECTED:
-                    SEGGER_RTT_WriteString(0, "DISCONNECTED\n");
-            err_code = bsp_indication_set(BSP_INDICATE_IDLE);
-            APP_ERROR_CHECK(err_code);
-            m_conn_handle = BLE_CONN_HANDLE_INVALID;
+        length   = MIN(p_pkt->length - m_nus_tx_offset, BLE_NUS_MAX_DATA_LEN);
+        err_code = ble_nus_string_send(&m_nus, &p_pkt->data[m_nus_tx_offset], length);
+        if (err_code == BLE_ERROR_NO_TX_BUFFERS)
+        {
             break;
-
-        case BLE_GAP_EVT_SEC_PARAMS_REQUEST:
-            // Pairing not supported
-            err_code = sd_ble_gap_sec_params_reply(m_conn_handle, BLE_GAP_SEC_STATUS_PAIRING_NOT_SUPP, NULL, NULL);
+        }
+
+        if (err_code == NRF_ERROR_INVALID_STATE)
+        {
+            // Not connected or notifications disabled, the packet is discarded.
+            m_uart_stats.uplink_dropped++;
+            m_nus_tx_offset = p_pkt->length;
+        }
+        else
+        {
             APP_ERROR_CHECK(err_code);
-            break;
+            m_nus_tx_offset += length;
+        }
 
-        case BLE_GATTS_EVT_SYS_ATTR_MISSING:
-            // No system attributes have been stored.
-            err_code = sd_ble_gatts_sys_attr_set(m_conn_handle, NULL, 0, 0);
-            APP_ERROR_CHECK(err_code);
-            break;
+        if (m_nus_tx_offset < p_pkt->length)
+        {
+            continue;
+        }
 
-        default:
-                    SEGGER_RTT_WriteString(0, "BLE IDLE...\n");
-            // No implementation needed.
-            break;
+        m_nus_tx_offset = 0;
+        router_sink_pop(ROUTER_EP_NUS, 0);
     }
 }
 
 
-/**@brief Function for dispatching a S110 SoftDevice event to all modules with a S110 SoftDevice 
- *        event handler.
- *
- * @details This function is called from the S110 SoftDevice event interrupt handler after a S110 
- *          SoftDevice event has been received.
- *
- * @param[in] p_ble_evt  S110 SoftDevice event.
+/**@brief Function for printing queued packets on RTT channel 0, prefixed with their port.
  */
-static void ble_evt_dispatch(ble_evt_t * p_ble_evt)
+static void rtt_tx_pump(void)
 {
-    ble_conn_params_on_ble_evt(p_ble_evt);
-    ble_nus_on_ble_evt(&m_nus, p_ble_evt);
-    on_ble_evt(p_ble_evt);
-    ble_advertising_on_ble_evt(p_ble_evt);
-    bsp_btn_ble_on_ble_evt(p_ble_evt);
-    
+    pkt_t * p_pkt;
+
+    while ((p_pkt = pkt_queue_peek(&m_rtt_tx_queue)) != NULL)
+    {
+        SEGGER_RTT_printf(0, "[%u] ", p_pkt->port);
+        SEGGER_RTT_Write(0, p_pkt->data, p_pkt->length);
+        SEGGER_RTT_WriteString(0, "\n");
+        router_sink_pop(ROUTER_EP_RTT, 0);
+    }
 }
 
 
-/**@brief Function for the S110 SoftDevice initialization.
+/**@brief Function for routing the input of RTT channel 0 on port 0.
  *
- * @details This function initializes the S110 SoftDevice and the BLE event interrupt.
+ * @details Called from the main loop, RTT has no receive interrupt.
  */
-static void ble_stack_init(void)
+static void rtt_rx_poll(void)
+{
+    uint8_t  data[PKT_QUEUE_DATA_MAX];
+    unsigned length;
+
+    length = SEGGER_RTT_Read(0, data, sizeof(data));
+    if (length > 0)
+    {
+        UNUSED_VARIABLE(router_put(ROUTER_EP_RTT, 0, data, (uint8_t)length));
+    }
+}
+
+
+/**@brief Function for sending a control channel response to RTT, prefixed with its length.
+ */
+static void rtt_ctrl_send(uint8_t const * p_data, uint8_t length)
+{
+    uint8_t frame[RTT_CTRL_BUF_SIZE];
+
+    if (length >= sizeof(frame))
+    {
+        return;
+    }
+
+    // One write, the up buffer skips it as a whole when the debugger is not reading.
+    frame[0] = length;
+    memcpy(&frame[1], p_data, length);
+    UNUSED_VARIABLE(SEGGER_RTT_Write(RTT_CTRL_CHANNEL, frame, 1 + length));
+}
+
+
+/**@brief Function for executing the control requests written to RTT channel @ref RTT_CTRL_CHANNEL.
+ *
+ * @details A request is | length (1) | request |, its response | length (1) | response |. This is
+ *          the control channel of the text mode of the UART, and works with the debugger attached
+ *          in binary mode too. Requests longer than @ref RTT_CTRL_REQ_MAX are skipped.
+ */
+static void rtt_ctrl_poll(void)
+{
+    uint8_t byte;
+
+    while (SEGGER_RTT_Read(RTT_CTRL_CHANNEL, &byte, 1) == 1)
+    {
+        if (m_rtt_ctrl_len == 0)
+        {
+            m_rtt_ctrl_len = byte;
+            m_rtt_ctrl_pos = 0;
+            continue;
+        }
+
+        if (m_rtt_ctrl_pos < sizeof(m_rtt_ctrl_req))
+        {
+            m_rtt_ctrl_req[m_rtt_ctrl_pos] = byte;
+        }
+        m_rtt_ctrl_pos++;
+
+        if (m_rtt_ctrl_pos == m_rtt_ctrl_len)
+        {
+            if (m_rtt_ctrl_len <= sizeof(m_rtt_ctrl_req))
+            {
+                ctrl_on_request(m_rtt_ctrl_req, m_rtt_ctrl_len, rtt_ctrl_send);
+            }
+            m_rtt_ctrl_len = 0;
+        }
+    }
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_RADIO_SCHED.
+ */
+static uint8_t radio_sched_stats_get(uint8_t * p_buf)
+{
+    memcpy(p_buf, m_radio_sched.stats, sizeof(m_radio_sched.stats));
+    return sizeof(m_radio_sched.stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_RADIO_SCHED.
+ */
+static void radio_sched_stats_clear(void)
+{
+    memset(m_radio_sched.stats, 0, sizeof(m_radio_sched.stats));
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_LINK.
+ */
+static uint8_t link_stats_get(uint8_t * p_buf)
+{
+    memcpy(p_buf, &m_link.stats, sizeof(m_link.stats));
+    memcpy(&p_buf[sizeof(m_link.stats)], &m_nus_overruns, sizeof(m_nus_overruns));
+    return sizeof(m_link.stats) + sizeof(m_nus_overruns);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_LINK.
+ */
+static void link_stats_clear(void)
+{
+    memset(&m_link.stats, 0, sizeof(m_link.stats));
+    m_nus_overruns = 0;
+}
+
+
+/**@brief Function for handling the link keepalive timer timeout.
+ *
+ * @param[in] p_context  Not used.
+ */
+static void link_keepalive_timeout_handler(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+    m_link_keepalive_due = true;
+    m_radio_check_due    = true;
+    radio_evt_post();
+}
+
+
+/**@brief Function for handling the RTT poll timer timeout.
+ *
+ * @param[in] p_context  Not used.
+ */
+static void rtt_poll_timeout_handler(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+    rtt_rx_poll();
+    rtt_ctrl_poll();
+}
+
+
+/**@brief Function for initializing the endpoint queues and the default routes.
+ *
+ * @details By default NUS writes go to the UART and the radio, UART input goes to NUS, radio
+ *          packets go to NUS and RTT, and RTT input is sent over the radio. Every port of a source
+ *          starts with the same sinks. Port 0 is interactive on the radio, the other ports are bulk,
+ *          and no port uses the priority class.
+ */
+static void bridge_init(void)
 {
+    static uint8_t const radio_weights[RADIO_CLASS_COUNT] =
+    {
+        0, RADIO_INTERACTIVE_WEIGHT, RADIO_BULK_WEIGHT
+    };
     uint32_t err_code;
-    
-    // Initialize SoftDevice.
-    SOFTDEVICE_HANDLER_INIT(NRF_CLOCK_LFCLKSRC_XTAL_20_PPM, NULL);
+    uint8_t  port;
 
-    // Enable BLE stack.
-    ble_enable_params_t ble_enable_params;
-    memset(&ble_enable_params, 0, sizeof(ble_enable_params));
-#if (defined(S130) || defined(S132))
-    ble_enable_params.gatts_enable_params.attr_tab_size   = BLE_GATTS_ATTR_TAB_SIZE_DEFAULT;
+    err_code = pkt_queue_init(&m_nus_tx_queue, m_nus_tx_buf, NUS_TX_QUEUE_SIZE);
+    APP_ERROR_CHECK(err_code);
+    err_code = pkt_queue_init(&m_uart_tx_queue, m_uart_tx_buf, UART_TX_QUEUE_SIZE);
+    APP_ERROR_CHECK(err_code);
+    err_code = pkt_queue_init(&m_radio_tx_queues[RADIO_CLASS_PRIORITY], m_radio_priority_buf, RADIO_PRIORITY_QUEUE_SIZE);
+    APP_ERROR_CHECK(err_code);
+    err_code = pkt_queue_init(&m_radio_tx_queues[RADIO_CLASS_INTERACTIVE],
+                              m_radio_interactive_buf,
+                              RADIO_INTERACTIVE_QUEUE_SIZE);
+    APP_ERROR_CHECK(err_code);
+    err_code = pkt_queue_init(&m_radio_tx_queues[RADIO_CLASS_BULK], m_radio_bulk_buf, RADIO_BULK_QUEUE_SIZE);
+    APP_ERROR_CHECK(err_code);
+    err_code = pkt_sched_init(&m_radio_sched, m_radio_tx_queues, RADIO_CLASS_COUNT, radio_weights);
+    APP_ERROR_CHECK(err_code);
+    err_code = pkt_queue_init(&m_rtt_tx_queue, m_rtt_tx_buf, RTT_TX_QUEUE_SIZE);
+    APP_ERROR_CHECK(err_code);
+
+    router_init();
+
+    err_code = router_sink_register(ROUTER_EP_NUS, &m_nus_tx_queue, 1, PKT_QUEUE_DATA_MAX, nus_tx_pump);
+    APP_ERROR_CHECK(err_code);
+#if (UART_FRAMING == UART_FRAMING_COBS)
+    err_code = router_sink_register(ROUTER_EP_UART, &m_uart_tx_queue, 1, UART_FRAME_PAYLOAD_MAX, uart_tx_pump);
+#else
+    err_code = router_sink_register(ROUTER_EP_UART, &m_uart_tx_queue, 1, PKT_QUEUE_DATA_MAX, uart_tx_pump);
 #endif
-    ble_enable_params.gatts_enable_params.service_changed = IS_SRVC_CHANGED_CHARACT_PRESENT;
-    err_code = sd_ble_enable(&ble_enable_params);
     APP_ERROR_CHECK(err_code);
+    err_code = router_sink_register(ROUTER_EP_RADIO, m_radio_tx_queues, RADIO_CLASS_COUNT, RADIO_PAYLOAD_MAX, radio_evt_post);
+    APP_ERROR_CHECK(err_code);
+    err_code = router_sink_register(ROUTER_EP_RTT, &m_rtt_tx_queue, 1, PKT_QUEUE_DATA_MAX, rtt_tx_pump);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = router_source_register(ROUTER_EP_UART, uart_rx_resume);
+    APP_ERROR_CHECK(err_code);
+    err_code = router_source_register(ROUTER_EP_NUS, nus_credit_update);
+    APP_ERROR_CHECK(err_code);
+    err_code = router_source_register(ROUTER_EP_RADIO, radio_evt_post);
+    APP_ERROR_CHECK(err_code);
+
+    for (port = 0; port < ROUTER_PORT_COUNT; port++)
+    {
+        err_code = router_route_set(ROUTER_EP_NUS, port,
+                                    ROUTER_EP_MASK(ROUTER_EP_UART) | ROUTER_EP_MASK(ROUTER_EP_RADIO));
+        APP_ERROR_CHECK(err_code);
+        err_code = router_route_set(ROUTER_EP_UART, port, ROUTER_EP_MASK(ROUTER_EP_NUS));
+        APP_ERROR_CHECK(err_code);
+        err_code = router_route_set(ROUTER_EP_RADIO, port,
+                                    ROUTER_EP_MASK(ROUTER_EP_NUS) | ROUTER_EP_MASK(ROUTER_EP_RTT));
+        APP_ERROR_CHECK(err_code);
+        err_code = router_route_set(ROUTER_EP_RTT, port, ROUTER_EP_MASK(ROUTER_EP_RADIO));
+        APP_ERROR_CHECK(err_code);
+        err_code = router_class_set(ROUTER_EP_RADIO, port,
+                                    (port == 0) ? RADIO_CLASS_INTERACTIVE : RADIO_CLASS_BULK);
+        APP_ERROR_CHECK(err_code);
+    }
+
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_RADIO_SCHED, radio_sched_stats_get, radio_sched_stats_clear);
+    APP_ERROR_CHECK(err_code);
+
+    link_credit_init(&m_link);
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_LINK, link_stats_get, link_stats_clear);
+    APP_ERROR_CHECK(err_code);
+    err_code = app_timer_create(&m_link_keepalive_timer_id,
+                                APP_TIMER_MODE_REPEATED,
+                                link_keepalive_timeout_handler);
+    APP_ERROR_CHECK(err_code);
+    err_code = app_timer_start(m_link_keepalive_timer_id, LINK_KEEPALIVE_INTERVAL, NULL);
+    APP_ERROR_CHECK(err_code);
+
+    UNUSED_VARIABLE(SEGGER_RTT_ConfigUpBuffer(RTT_CTRL_CHANNEL, "ctrl", m_rtt_ctrl_up_buf, sizeof(m_rtt_ctrl_up_buf),
+                                              SEGGER_RTT_MODE_NO_BLOCK_SKIP));
+    UNUSED_VARIABLE(SEGGER_RTT_ConfigDownBuffer(RTT_CTRL_CHANNEL, "ctrl", m_rtt_ctrl_down_buf, sizeof(m_rtt_ctrl_down_buf),
+                                                SEGGER_RTT_MODE_NO_BLOCK_SKIP));
+    err_code = app_timer_create(&m_rtt_poll_timer_id, APP_TIMER_MODE_REPEATED, rtt_poll_timeout_handler);
+    APP_ERROR_CHECK(err_code);
+    err_code = app_timer_start(m_rtt_poll_timer_id, RTT_POLL_INTERVAL, NULL);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_UART.
+ */
+static uint8_t uart_stats_get(uint8_t * p_buf)
+{
+#if (UART_FRAMING == UART_FRAMING_COBS)
+    m_uart_stats.rx_frames        = m_uart_decoder.stats.frames;
+    m_uart_stats.rx_crc_errors    = m_uart_decoder.stats.crc_errors;
+    m_uart_stats.rx_format_errors = m_uart_decoder.stats.format_errors;
+#endif
+    memcpy(p_buf, &m_uart_stats, sizeof(m_uart_stats));
+    return sizeof(m_uart_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_UART.
+ */
+static void uart_stats_clear(void)
+{
+    memset(&m_uart_stats, 0, sizeof(m_uart_stats));
+#if (UART_FRAMING == UART_FRAMING_COBS)
+    memset(&m_uart_decoder.stats, 0, sizeof(m_uart_decoder.stats));
+#endif
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_UART_CFG_GET.
+ */
+static uint32_t uart_cfg_get(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    uint32_t baudrate = UART_BAUDRATE;
+
+    p_rsp[0] = UART_FRAMING;
+    memcpy(&p_rsp[1], &baudrate, sizeof(baudrate));
+    p_rsp[5] = APP_UART_FLOW_CONTROL_ENABLED;
+    *p_rsp_len = 6;
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for initializing the control channel commands and statistics of this file.
+ */
+static void ctrl_init(void)
+{
+    uint32_t err_code;
+
+    err_code = ctrl_cmd_register(CTRL_CMD_UART_CFG_GET, uart_cfg_get);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_UART, uart_stats_get, uart_stats_clear);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for printing the energy estimate on RTT and updating its characteristic.
+ */
+static void energy_timeout_handler(void * p_context)
+{
+    energy_summary_t summary;
+
+    UNUSED_PARAMETER(p_context);
+    energy_report();
+    energy_summary_get(&summary);
+    ble_energy_update(&m_ble_energy, &summary);
+}
+
+
+/**@brief Function for initializing services that will be used by the application.
+ *
+ * @details Also starts the periodic energy report, which feeds the energy characteristic.
+ */
+static void services_init(void)
+{
+    uint32_t       err_code;
+    ble_nus_init_t nus_init;
     
-    // Subscribe for BLE events.
-    err_code = softdevice_ble_evt_handler_set(ble_evt_dispatch);
+    memset(&nus_init, 0, sizeof(nus_init));
+
+    nus_init.data_handler = nus_data_handler;
+    
+    err_code = ble_nus_init(&m_nus, &nus_init);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = ble_credit_init(&m_ble_credit, m_nus.service_handle, m_nus.uuid_type);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = ble_energy_init(&m_ble_energy, m_nus.service_handle, m_nus.uuid_type);
+    APP_ERROR_CHECK(err_code);
+    err_code = app_timer_create(&m_energy_timer_id, APP_TIMER_MODE_REPEATED, energy_timeout_handler);
+    APP_ERROR_CHECK(err_code);
+    err_code = app_timer_start(m_energy_timer_id, ENERGY_REPORT_INTERVAL, NULL);
     APP_ERROR_CHECK(err_code);
 }
 
 
-/**@brief Function for handling events from the BSP module.
+/**@brief Function for handling an event from the Connection Parameters Module.
  *
- * @param[in]   event   Event generated by button press.
+ * @details This function will be called for all events in the Connection Parameters Module
+ *          which are passed to the application.
+ *
+ * @note All this function does is to disconnect. This could have been done by simply setting
+ *       the disconnect_on_fail config parameter, but instead we use the event handler
+ *       mechanism to demonstrate its use.
+ *
+ * @param[in] p_evt  Event received from the Connection Parameters Module.
  */
-void bsp_event_handler(bsp_event_t event)
+static void on_conn_params_evt(ble_conn_params_evt_t * p_evt)
 {
     uint32_t err_code;
-    switch (event)
+    
+    if(p_evt->evt_type == BLE_CONN_PARAMS_EVT_FAILED)
     {
-        case BSP_EVENT_SLEEP:
-            sleep_mode_enter();
-            break;
+        err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_CONN_INTERVAL_UNACCEPTABLE);
+        APP_ERROR_CHECK(err_code);
+    }
+}
 
-        case BSP_EVENT_DISCONNECT:
-            err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
-            if (err_code != NRF_ERROR_INVALID_STATE)
-            {
-                APP_ERROR_CHECK(err_code);
-            }
-            break;
 
-        case BSP_EVENT_WHITELIST_OFF:
-            err_code = ble_advertising_restart_without_whitelist();
-            if (err_code != NRF_ERROR_INVALID_STATE)
-            {
-                APP_ERROR_CHECK(err_code);
-            }
-            break;
+/**@brief Function for handling errors from the Connection Parameters module.
+ *
+ * @param[in] nrf_error  Error code containing information about what went wrong.
+ */
+static void conn_params_error_handler(uint32_t nrf_error)
+{
+    APP_ERROR_HANDLER(nrf_error);
+}
 
-        default:
-            break;
-    }
+
+/**@brief Function for initializing the Connection Parameters module.
+ */
+static void conn_params_init(void)
+{
+    uint32_t               err_code;
+    ble_conn_params_init_t cp_init;
+    
+    memset(&cp_init, 0, sizeof(cp_init));
+
+    cp_init.p_conn_params                  = NULL;
+    cp_init.first_conn_params_update_delay = FIRST_CONN_PARAMS_UPDATE_DELAY;
+    cp_init.next_conn_params_update_delay  = NEXT_CONN_PARAMS_UPDATE_DELAY;
+    cp_init.max_conn_params_update_count   = MAX_CONN_PARAMS_UPDATE_COUNT;
+    cp_init.start_on_notify_cccd_handle    = BLE_GATT_HANDLE_INVALID;
+    cp_init.disconnect_on_fail             = false;
+    cp_init.evt_handler                    = on_conn_params_evt;
+    cp_init.error_handler                  = conn_params_error_handler;
+    
+    err_code = ble_conn_params_init(&cp_init);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for putting the chip into sleep mode.
+ *
+ * @note This function will not return.
+ */
+static void sleep_mode_enter(void)
+{
+    uint32_t err_code = bsp_indication_set(BSP_INDICATE_IDLE);
+    APP_ERROR_CHECK(err_code);
+
+    // Prepare wakeup buttons.
+    err_code = bsp_btn_ble_sleep_mode_prepare();
+    APP_ERROR_CHECK(err_code);
+
+    // The CC1101 would keep receiving otherwise.
+    power_mgr_enter(POWER_MGR_SLEEP);
+
+    // Go to system-off mode (this function will not return; wakeup will cause a reset).
+    err_code = sd_power_system_off();
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for handling advertising events.
+ *
+ * @details This function will be called for advertising events which are passed to the application.
+ *
+ * @param[in] ble_adv_evt  Advertising event.
+ */
+static void on_adv_evt(ble_adv_evt_t ble_adv_evt)
+{
+    uint32_t err_code;
+
+    switch (ble_adv_evt)
+    {
+        case BLE_ADV_EVT_FAST:
+            err_code = bsp_indication_set(BSP_INDICATE_ADVERTISING);
+            APP_ERROR_CHECK(err_code);
+            break;
+        case BLE_ADV_EVT_IDLE:
+            // System ON standby rather than System OFF, a wake then resumes in a few ms.
+            err_code = bsp_indication_set(BSP_INDICATE_IDLE);
+            APP_ERROR_CHECK(err_code);
+            standby_enter();
+            // No keepalive in standby, it would wake a peer in standby every interval.
+            err_code = app_timer_stop(m_link_keepalive_timer_id);
+            APP_ERROR_CHECK(err_code);
+            m_link_keepalive_due = false;
+            break;
+        default:
+            break;
+    }
+}
+
+
+/**@brief Function for the Application's S110 SoftDevice event handler.
+ *
+ * @param[in] p_ble_evt S110 SoftDevice event.
+ */
+static void on_ble_evt(ble_evt_t * p_ble_evt)
+{
+    uint32_t                         err_code;
+    
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+                    SEGGER_RTT_WriteString(0, "CONNECTED\n");
+            boot_prof_mark(BOOT_PROF_CONNECTED);
+            boot_prof_report();
+            err_code = bsp_indication_set(BSP_INDICATE_CONNECTED);
+            APP_ERROR_CHECK(err_code);
+            m_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+            ble_timeline_interval_set(CONN_INTERVAL_TICKS(p_ble_evt->evt.gap_evt.params.connected.conn_params.max_conn_interval));
+
+            // The client counts its writes from here.
+            m_nus_rx_count = 0;
+            nus_credit_update();
+            break;
+            
+        case BLE_GAP_EVT_DISCONNECTED:
+                    SEGGER_RTT_WriteString(0, "DISCONNECTED\n");
+            err_code = bsp_indication_set(BSP_INDICATE_IDLE);
+            APP_ERROR_CHECK(err_code);
+            m_conn_handle = BLE_CONN_HANDLE_INVALID;
+            ble_timeline_interval_set(0);
+
+            // Discard what the peer can no longer receive and let the sources run again.
+            router_sink_kick(ROUTER_EP_NUS);
+            break;
+
+        case BLE_GAP_EVT_CONN_PARAM_UPDATE:
+            ble_timeline_interval_set(CONN_INTERVAL_TICKS(p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params.max_conn_interval));
+            break;
+
+        case BLE_EVT_TX_COMPLETE:
+            // SoftDevice TX buffers were freed, refill them.
+            router_sink_kick(ROUTER_EP_NUS);
+            break;
+
+        case BLE_GAP_EVT_SEC_PARAMS_REQUEST:
+            // Pairing not supported
+            err_code = sd_ble_gap_sec_params_reply(m_conn_handle, BLE_GAP_SEC_STATUS_PAIRING_NOT_SUPP, NULL, NULL);
+            APP_ERROR_CHECK(err_code);
+            break;
+
+        case BLE_GATTS_EVT_SYS_ATTR_MISSING:
+            // No system attributes have been stored.
+            err_code = sd_ble_gatts_sys_attr_set(m_conn_handle, NULL, 0, 0);
+            APP_ERROR_CHECK(err_code);
+            break;
+
+        default:
+                    SEGGER_RTT_WriteString(0, "BLE IDLE...\n");
+            // No implementation needed.
+            break;
+    }
+}
+
+
+/**@brief Function for dispatching a S110 SoftDevice event to all modules with a S110 SoftDevice 
+ *        event handler.
+ *
+ * @details This function is called from the S110 SoftDevice event interrupt handler after a S110 
+ *          SoftDevice event has been received.
+ *
+ * @param[in] p_ble_evt  S110 SoftDevice event.
+ */
+static void ble_evt_dispatch(ble_evt_t * p_ble_evt)
+{
+    uint16_t start = isr_prof_enter(ISR_PROF_BLE_EVT);
+
+    ble_conn_params_on_ble_evt(p_ble_evt);
+    ble_nus_on_ble_evt(&m_nus, p_ble_evt);
+    ble_credit_on_ble_evt(&m_ble_credit, p_ble_evt);
+    ble_energy_on_ble_evt(&m_ble_energy, p_ble_evt);
+    on_ble_evt(p_ble_evt);
+    ble_advertising_on_ble_evt(p_ble_evt);
+    bsp_btn_ble_on_ble_evt(p_ble_evt);
+    isr_prof_exit(ISR_PROF_BLE_EVT, start);
+}
+
+
+/**@brief Function for dispatching a system event to interested modules.
+ *
+ * @details This function is called from the System event interrupt handler after a system
+ *          event has been received.
+ *
+ * @param[in] sys_evt  System stack event.
+ */
+static void sys_evt_dispatch(uint32_t sys_evt)
+{
+    uint16_t start = isr_prof_enter(ISR_PROF_SYS_EVT);
+
+    pstorage_sys_event_handler(sys_evt); // Handles Flash Access Result Events
+    flash_sched_on_sys_evt(sys_evt);     // Starts the next flash operation, after pstorage is done with this one
+    isr_prof_exit(ISR_PROF_SYS_EVT, start);
+}
+
+
+/**@brief Function for the S110 SoftDevice initialization.
+ *
+ * @details This function initializes the S110 SoftDevice and the BLE event interrupt.
+ */
+static void ble_stack_init(void)
+{
+    uint32_t err_code;
+    
+    // Initialize SoftDevice.
+    SOFTDEVICE_HANDLER_APPSH_INIT(m_lfclk_src, true);
+
+    // Enable BLE stack.
+    ble_enable_params_t ble_enable_params;
+    memset(&ble_enable_params, 0, sizeof(ble_enable_params));
+#if (defined(S130) || defined(S132))
+    ble_enable_params.gatts_enable_params.attr_tab_size   = BLE_GATTS_ATTR_TAB_SIZE_DEFAULT;
+#endif
+    ble_enable_params.gatts_enable_params.service_changed = IS_SRVC_CHANGED_CHARACT_PRESENT;
+    err_code = sd_ble_enable(&ble_enable_params);
+    APP_ERROR_CHECK(err_code);
+    
+    // Subscribe for BLE events.
+    err_code = softdevice_ble_evt_handler_set(ble_evt_dispatch);
+    APP_ERROR_CHECK(err_code);
+
+    // Subscribe for system events, pstorage reports the end of flash operations with them.
+    err_code = softdevice_sys_evt_handler_set(sys_evt_dispatch);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for handling events from the BSP module.
+ *
+ * @param[in]   event   Event generated by button press.
+ */
+void bsp_event_handler(bsp_event_t event)
+{
+    uint32_t err_code;
+    switch (event)
+    {
+        case BSP_EVENT_SLEEP:
+            sleep_mode_enter();
+            break;
+
+        case BSP_EVENT_DISCONNECT:
+            err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+            if (err_code != NRF_ERROR_INVALID_STATE)
+            {
+                APP_ERROR_CHECK(err_code);
+            }
+            break;
+
+        case BSP_EVENT_WHITELIST_OFF:
+            err_code = ble_advertising_restart_without_whitelist();
+            if (err_code != NRF_ERROR_INVALID_STATE)
+            {
+                APP_ERROR_CHECK(err_code);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/**@brief Function for draining the UART RX FIFO from the main loop.
+ */
+static void uart_rx_evt_handler(void * p_event_data, uint16_t event_size)
+{
+    m_uart_rx_evt_pending = false;
+    uart_rx_drain();
+}
+
+
+/**@brief Function for continuing to write to the UART from the main loop.
+ */
+static void uart_tx_evt_handler(void * p_event_data, uint16_t event_size)
+{
+    m_uart_tx_evt_pending = false;
+    router_sink_kick(ROUTER_EP_UART);
+}
+
+
+/**@brief   Function for handling app_uart events.
+ *
+ * @details Received characters are framed into lines or frames by @ref uart_rx_drain and handed
+ *          to the @ref router. The UART sink continues writing when the TX FIFO has drained. Both
+ *          run from the main loop, the interrupt only posts them to the scheduler.
+ */
+/**@snippet [Handling the data received over UART] */
+void uart_event_handle(app_uart_evt_t * p_event)
+{
+    uint16_t start = isr_prof_enter(ISR_PROF_UART);
+
+    switch (p_event->evt_type)
+    {
+        case APP_UART_DATA_READY:
+            sched_post(&m_uart_rx_evt_pending, uart_rx_evt_handler);
+            break;
+
+        case APP_UART_TX_EMPTY:
+            sched_post(&m_uart_tx_evt_pending, uart_tx_evt_handler);
+            break;
+
+        case APP_UART_COMMUNICATION_ERROR:
+            APP_ERROR_HANDLER(p_event->data.error_communication);
+            break;
+
+        case APP_UART_FIFO_ERROR:
+            APP_ERROR_HANDLER(p_event->data.error_code);
+            break;
+
+        default:
+            break;
+    }
+
+    isr_prof_exit(ISR_PROF_UART, start);
+}
+/**@snippet [Handling the data received over UART] */
+
+
+/**@brief  Function for initializing the UART module.
+ */
+/**@snippet [UART Initialization] */
+static void uart_init(void)
+{
+    uint32_t                     err_code;
+    const app_uart_comm_params_t comm_params =
+    {
+        RX_PIN_NUMBER,
+        TX_PIN_NUMBER,
+        RTS_PIN_NUMBER,
+        CTS_PIN_NUMBER,
+        APP_UART_FLOW_CONTROL_ENABLED,
+        false,
+        UART_BAUDRATE
+    };
+
+    APP_UART_FIFO_INIT( &comm_params,
+                       UART_RX_BUF_SIZE,
+                       UART_TX_BUF_SIZE,
+                       uart_event_handle,
+                       APP_IRQ_PRIORITY_LOW,
+                       err_code);
+    APP_ERROR_CHECK(err_code);
+
+#if (UART_FRAMING == UART_FRAMING_LINE)
+    err_code = app_timer_create(&m_uart_idle_timer_id,
+                                APP_TIMER_MODE_SINGLE_SHOT,
+                                uart_idle_timeout_handler);
+    APP_ERROR_CHECK(err_code);
+#endif
+}
+/**@snippet [UART Initialization] */
+
+
+/**@brief Function for initializing the Advertising functionality.
+ */
+static void advertising_init(void)
+{
+    uint32_t      err_code;
+    ble_advdata_t advdata;
+    ble_advdata_t scanrsp;
+
+    // Build advertising data struct to pass into @ref ble_advertising_init.
+    memset(&advdata, 0, sizeof(advdata));
+    advdata.name_type          = BLE_ADVDATA_FULL_NAME;
+    advdata.include_appearance = false;
+    advdata.flags              = BLE_GAP_ADV_FLAGS_LE_ONLY_LIMITED_DISC_MODE;
+
+    memset(&scanrsp, 0, sizeof(scanrsp));
+    scanrsp.uuids_complete.uuid_cnt = sizeof(m_adv_uuids) / sizeof(m_adv_uuids[0]);
+    scanrsp.uuids_complete.p_uuids  = m_adv_uuids;
+
+    ble_adv_modes_config_t options = {0};
+    options.ble_adv_fast_enabled  = BLE_ADV_FAST_ENABLED;
+    options.ble_adv_fast_interval = APP_ADV_INTERVAL;
+    options.ble_adv_fast_timeout  = APP_ADV_TIMEOUT_IN_SECONDS;
+
+    err_code = ble_advertising_init(&advdata, &scanrsp, &options, on_adv_evt, NULL);
+    APP_ERROR_CHECK(err_code);
+}
+
+/**@brief Function for placing the application in low power state while waiting for events.
+ *
+ * @details The time spent waiting is accounted in @ref cpu_load.
+ */
+static void power_manage(void)
+{
+    uint32_t err_code;
+
+    cpu_load_sleep_enter();
+    err_code = sd_app_evt_wait();
+    cpu_load_sleep_exit();
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for the Event Scheduler initialization.
+ */
+static void scheduler_init(void)
+{
+    APP_SCHED_INIT(SCHED_MAX_EVENT_DATA_SIZE, SCHED_QUEUE_SIZE);
+}
+
+
+/**@brief Function for starting the LFCLK from the crystal, or the RC oscillator without one, before
+ *        app_timer.
+ *
+ * @details RTC1 only counts once the LFCLK runs, which the SoftDevice would start only in
+ *          @ref ble_stack_init: the boot marks before it would read 0 and the waits of the CC1101
+ *          reset would not pass. The source is the one given to the SoftDevice, which keeps the
+ *          clock running. The crystal start, a few hundred ms, is waited for here instead of in
+ *          sd_softdevice_enable, for at most @ref LFCLK_XTAL_TIMEOUT_MS.
+ */
+static void lfclk_start(void)
+{
+    uint32_t ms;
+
+    NRF_CLOCK->LFCLKSRC            = (CLOCK_LFCLKSRC_SRC_Xtal << CLOCK_LFCLKSRC_SRC_Pos);
+    NRF_CLOCK->EVENTS_LFCLKSTARTED = 0;
+    NRF_CLOCK->TASKS_LFCLKSTART    = 1;
+
+    // Bounded, the watchdog is not running yet.
+    for (ms = 0; (ms < LFCLK_XTAL_TIMEOUT_MS) && (NRF_CLOCK->EVENTS_LFCLKSTARTED == 0); ms++)
+    {
+        nrf_delay_us(1000);
+    }
+
+    if (NRF_CLOCK->EVENTS_LFCLKSTARTED == 0)
+    {
+        // A missing or broken crystal: the RC oscillator, calibrated by the SoftDevice, starts
+        // within a millisecond.
+        NRF_CLOCK->TASKS_LFCLKSTOP     = 1;
+        NRF_CLOCK->LFCLKSRC            = (CLOCK_LFCLKSRC_SRC_RC << CLOCK_LFCLKSRC_SRC_Pos);
+        NRF_CLOCK->EVENTS_LFCLKSTARTED = 0;
+        NRF_CLOCK->TASKS_LFCLKSTART    = 1;
+        m_lfclk_src                    = NRF_CLOCK_LFCLKSRC_RC_250_PPM_4000MS_CALIBRATION;
+
+        while (NRF_CLOCK->EVENTS_LFCLKSTARTED == 0)
+        {
+            // Wait for the RC oscillator.
+        }
+    }
+    NRF_CLOCK->EVENTS_LFCLKSTARTED = 0;
+}
+
+/**
+
+	Beginning of CC1101 specific functions followed by the main()
+
+
+*/
+
+
+
+/**@brief Function for putting the CC1101 back in RX.
+ *
+ * @details MCSM1 returns the radio to IDLE after every packet sent or received. SRX has no effect
+ *          while the radio is already receiving.
+ */
+static void radio_rx_start(void)
+{
+    UNUSED_VARIABLE(cc1101_strobe(&m_radio, CC1101_SRX));
+    power_mgr_state_set(POWER_MGR_RX);
+    m_radio_state = RADIO_STATE_RX;
+}
+
+
+/**@brief Function for checking whether the CC1101 is done sending.
+ */
+static bool radio_tx_is_done(void)
+{
+    // A single byte SNOP, the status byte has the state.
+    if (!cc1101_status_read(&m_radio, false))
+    {
+        return false;
+    }
+    return (m_radio.state == CC1101_STATE_IDLE) || m_radio.tx_underflow;
+}
+
+
+/**@brief Function for going back to RX once a packet was sent.
+ */
+static void radio_tx_done(seq_t * p_seq)
+{
+    radio_ts_frame_t frame;
+
+    standby_on_packet();
+    if (radio_ts_tx_done(&frame) && m_radio_tx_beacon && frame.sync_valid)
+    {
+        slot_sync_on_beacon_sent(radio_ts_rtc_ticks(frame.sync));
+    }
+    m_radio_tx_beacon = false;
+    if (m_radio.tx_underflow)
+    {
+        UNUSED_VARIABLE(cc1101_strobe(&m_radio, CC1101_SFTX));
+        m_radio_stats.tx_underflows++;
+    }
+    m_radio_stats.tx_packets++;
+    m_radio_tx_timeouts = 0;
+    UNUSED_VARIABLE(app_timer_cnt_get(&m_radio_last_activity));
+    radio_rx_start();
+    radio_evt_post();
+}
+
+
+/**@brief Function for abandoning a packet that did not go out in time.
+ */
+static void radio_tx_timeout(seq_t * p_seq)
+{
+    UNUSED_VARIABLE(cc1101_strobe(&m_radio, CC1101_SIDLE));
+    UNUSED_VARIABLE(cc1101_strobe(&m_radio, CC1101_SFTX));
+    m_radio_stats.tx_timeouts++;
+    m_radio_tx_timeouts++;
+    m_radio_tx_beacon = false;
+    radio_rx_start();
+    radio_evt_post();
+}
+
+/**@brief Function for dropping the packet in the TX FIFO, the channel stayed busy.
+ */
+static void radio_tx_drop(void)
+{
+    UNUSED_VARIABLE(cc1101_strobe(&m_radio, CC1101_SIDLE));
+    UNUSED_VARIABLE(cc1101_strobe(&m_radio, CC1101_SFTX));
+    m_radio_stats.cca_drops++;
+    m_radio_tx_beacon = false;
+    radio_rx_start();
+    radio_evt_post();
+}
+
+
+/**@brief Function for getting a random backoff after a busy channel, up to the air time of the
+ *        longest packet.
+ */
+static uint32_t radio_cca_backoff(void)
+{
+    uint8_t random = 0;
+
+    // An empty pool leaves 0, the shortest backoff.
+    UNUSED_VARIABLE(sd_rand_application_vector_get(&random, 1));
+    return APP_TIMER_MIN_TIMEOUT_TICKS + ((m_radio_airtime * random) >> 8);
+}
+
+
+/**@brief Function for strobing STX, once the packet is in the TX FIFO.
+ *
+ * @details With the clear channel assessment of MCSM1, STX leaves the CC1101 in RX while the
+ *          channel is busy or a packet is coming in. MARCSTATE tells, and the send is tried again
+ *          after a random backoff. A packet received meanwhile leaves the radio in IDLE, where STX
+ *          sends without a check, and stays in the RX FIFO for the run after the send.
+ *
+ *          A beacon is not tried again, it describes the window from when it was built.
+ */
+static void radio_tx_attempt(seq_t * p_seq)
+{
+    uint8_t marcstate;
+
+    UNUSED_VARIABLE(cc1101_strobe(&m_radio, CC1101_STX));
+    radio_ts_tx_started();
+    marcstate = cc1101_read_status(&m_radio, CC1101_MARCSTATE) & CC1101_MARCSTATE_MASK;
+    if (marcstate == CC1101_MARCSTATE_RX)
+    {
+        m_radio_stats.cca_busy++;
+        m_radio_cca_attempts++;
+        if (m_radio_tx_beacon || (m_radio_cca_attempts >= RADIO_CCA_ATTEMPTS_MAX))
+        {
+            radio_tx_drop();
+        }
+        else
+        {
+            seq_delay(p_seq, radio_cca_backoff(), radio_tx_attempt);
+        }
+        return;
+    }
+
+    power_mgr_state_set(POWER_MGR_TX);
+    seq_wait(p_seq,
+             radio_tx_is_done,
+             RADIO_TX_POLL_INTERVAL,
+             RADIO_TX_TIMEOUT,
+             radio_tx_done,
+             radio_tx_timeout);
+}
+
+//
+// function for writing a packet to the TXFIFO and putting the cc1101 in transmit mode
+//
+// returns right away, radio_tx_done runs once the radio is back in IDLE and posts the radio work
+//
+void SendDataPacket(uint8_t * TX_data,uint16_t TXFIFO_Address_Size)
+{
+    UNUSED_VARIABLE(cc1101_write_burst(&m_radio, CC1101_FIFO, TX_data, TXFIFO_Address_Size));
+
+    m_radio_state        = RADIO_STATE_TX;
+    m_radio_cca_attempts = 0;
+    radio_tx_attempt(&m_radio_seq);
+}
+
+//
+// function for reading a packet from the RXFIFO, once GDO0 has signalled the end of a packet
+//
+// returns the length of the packet copied to p_packet, 0 if nothing valid was received
+//
+uint8_t RecvDataPacket(uint8_t * p_packet)
+{
+    uint8_t size = 0;
+
+    switch (cc1101_rx_read(&m_radio, p_packet, RADIO_PACKET_MAX, &size))
+    {
+        case CC1101_RX_OK:
+            m_radio_stats.rx_packets++;
+            m_radio_fifo_errors = 0;
+            m_radio_rx_end_valid = radio_ts_rx_done(&m_radio_rx_ts);
+            m_radio_rx_ts_valid  = m_radio_rx_end_valid && m_radio_rx_ts.sync_valid;
+            return size;                                //returns number of bytes received
+
+        case CC1101_RX_OVERFLOW:
+            m_radio_stats.rx_overflows++;
+            m_radio_fifo_errors++;
+            return 0;
+
+        case CC1101_RX_CRC_ERROR:
+            m_radio_stats.rx_crc_errors++;
+            return 0;
+
+        default:
+            return 0;
+    }
+}
+
+
+/**@brief Function for handling a link control frame received on the radio.
+ */
+static void radio_link_on_frame(uint8_t const * p_frame, uint8_t length)
+{
+    if ((length > 0) && (p_frame[0] == LINK_CREDIT_FRAME))
+    {
+        UNUSED_VARIABLE(link_credit_on_frame(&m_link, p_frame, length));
+    }
+    else if ((length > 0) && (p_frame[0] == SLOT_SYNC_FRAME) && m_radio_rx_ts_valid)
+    {
+        slot_sync_on_beacon(p_frame, length, radio_ts_rtc_ticks(m_radio_rx_ts.sync));
+        if (slot_sync_role_get() == SLOT_SYNC_FOLLOWER)
+        {
+            // Answered within the window, so that the master knows this end is there.
+            m_link_keepalive_due = true;
+        }
+    }
+}
+
+
+/**@brief Function for routing a packet received on the radio.
+ *
+ * @details A radio data packet is | port (1) | sequence number (1) | payload |, after the CC1101
+ *          length byte. Port @ref ROUTER_PORT_CTRL carries link control frames instead, see
+ *          @ref link_credit. Data packets are stamped with the captured end of the frame rather
+ *          than the time this poll ran, so latency measured downstream excludes the polling delay.
+ */
+static void radio_rx_poll(void)
+{
+    uint8_t packet[RADIO_PACKET_MAX];
+    uint8_t length;
+
+    length = RecvDataPacket(packet);
+    if (length < 2)
+    {
+        return;
+    }
+    UNUSED_VARIABLE(app_timer_cnt_get(&m_radio_last_activity));
+    led_rcv_indicate();
+    slot_sync_on_peer();
+
+    if (packet[0] == ROUTER_PORT_CTRL)
+    {
+        // Credit keepalives and beacons of a peer in standby too, they do not wake this end.
+        radio_link_on_frame(&packet[1], length - 1);
+    }
+    else if (length > RADIO_HEADER_LEN)
+    {
+        standby_wake(STANDBY_WAKE_RF);
+        link_credit_on_data(&m_link, packet[1]);
+        slot_sync_on_traffic(m_radio_last_activity);
+        energy_on_bytes(length - RADIO_HEADER_LEN);
+        UNUSED_VARIABLE(router_put_at(ROUTER_EP_RADIO,
+                                      packet[0],
+                                      &packet[RADIO_HEADER_LEN],
+                                      length - RADIO_HEADER_LEN,
+                                      m_radio_rx_end_valid ? radio_ts_rtc_ticks(m_radio_rx_ts.end)
+                                                           : m_radio_last_activity));
+    }
+}
+
+
+/**@brief Function for checking whether packets wait in the radio sink queues.
+ */
+static bool radio_tx_backlog(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < RADIO_CLASS_COUNT; i++)
+    {
+        if (pkt_queue_count(&m_radio_tx_queues[i]) > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**@brief Function for asking @ref slot_sync what the radio may do now.
+ */
+static void radio_slot_poll(void)
+{
+    uint32_t now;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    m_radio_slot = slot_sync_poll(now, &m_radio_slot_next);
+}
+
+
+/**@brief Function for sizing the windows of @ref slot_sync and the CCA backoff to the air time of
+ *        the longest packet at the data rate of the profile in use.
+ */
+static void radio_slot_airtime_update(void)
+{
+    m_radio_airtime = (uint32_t)(((uint64_t)RADIO_PACKET_AIR_BITS * APP_TIMER_CLOCK_FREQ) /
+                                 radio_profile_get(m_radio_profile)->drate_baud);
+    slot_sync_airtime_set(m_radio_airtime);
+}
+
+
+/**@brief Function for sending the beacon of a window that just opened, before any other packet of
+ *        the window. Master of @ref slot_sync only.
+ *
+ * @details Sent directly, like the credit frames. The beacon describes the window from the moment
+ *          it is built, it must not wait in a queue.
+ */
+static void radio_sync_poll(void)
+{
+    uint8_t packet[2 + SLOT_SYNC_FRAME_LEN];
+    uint8_t length;
+
+    length = slot_sync_beacon_build(radio_tx_backlog(), &packet[2]);
+    if (length == 0)
+    {
+        return;
+    }
+
+    packet[0]         = length + 1;                     // CC1101 variable packet length.
+    packet[1]         = ROUTER_PORT_CTRL;
+    m_radio_tx_beacon = true;
+    SendDataPacket(packet, length + 2);
+}
+
+
+/**@brief Function for sending a credit frame when the peer is running short of credits, and at
+ *        least every @ref LINK_KEEPALIVE_INTERVAL.
+ *
+ * @details Credit frames are sent directly rather than through the radio queues, the priority
+ *          class included. Everything in those queues is held back while the peer has no credits
+ *          left and carries a sequence number, so a credit frame queued there could wait for the
+ *          credits it brings. A queued frame would also advertise the space of when it was built.
+ */
+static void radio_link_poll(void)
+{
+    uint8_t packet[2 + LINK_CREDIT_FRAME_LEN];
+    uint8_t space;
+    uint8_t length;
+
+    space = router_space(ROUTER_EP_RADIO);
+    if (!m_link_keepalive_due && !link_credit_update_needed(&m_link, space))
+    {
+        return;
+    }
+    m_link_keepalive_due = false;
+
+    length    = link_credit_frame_build(&m_link, space, &packet[2]);
+    packet[0] = length + 1;                             // CC1101 variable packet length.
+    packet[1] = ROUTER_PORT_CTRL;
+
+    SendDataPacket(packet, length + 2);
+}
+
+
+/**@brief Function for sending the next packet of the radio sink queues.
+ *
+ * @details The class is chosen by @ref pkt_sched right before the packet is loaded into the TX FIFO,
+ *          so a control packet never waits behind bulk packets that are still queued. Nothing is
+ *          sent while the peer has no space, the packets then stay queued and the NUS client
+ *          sees its write limit stop growing.
+ */
+static void radio_tx_poll(void)
+{
+    uint8_t   packet[1 + RADIO_PACKET_MAX];
+    uint8_t   length;
+    uint8_t   queue;
+    uint32_t  now;
+    pkt_t   * p_pkt;
+
+    p_pkt = pkt_sched_next(&m_radio_sched, &queue);
+    if ((p_pkt == NULL) || !link_credit_tx_allowed(&m_link))
+    {
+        return;
+    }
+
+    length    = p_pkt->length + RADIO_HEADER_LEN;
+    packet[0] = length;                                 // CC1101 variable packet length.
+    packet[1] = p_pkt->port;
+    packet[2] = link_credit_tx_seq_take(&m_link);
+    memcpy(&packet[1 + RADIO_HEADER_LEN], p_pkt->data, p_pkt->length);
+    energy_on_bytes(p_pkt->length);
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    CRITICAL_REGION_ENTER();
+    pkt_sched_sent(&m_radio_sched, queue, now);
+    CRITICAL_REGION_EXIT();
+    router_sink_pop(ROUTER_EP_RADIO, queue);
+    slot_sync_on_traffic(now);
+
+    SendDataPacket(packet, length + 1);
+}
+
+
+/**@brief Function for writing m_radio_profile into the shadow of the CC1101.
+ *
+ * @details A profile this build does not know falls back to @ref RADIO_PROFILE_DEFAULT, the radio
+ *          keeps working rather than the nRF51 being reset.
+ */
+static void radio_profile_write(void)
+{
+    if (radio_profile_apply(&m_radio_shadow, m_radio_profile) != NRF_SUCCESS)
+    {
+        m_radio_profile      = RADIO_PROFILE_DEFAULT;
+        m_radio_profile_next = RADIO_PROFILE_DEFAULT;
+        UNUSED_VARIABLE(radio_profile_apply(&m_radio_shadow, m_radio_profile));
+    }
+}
+
+
+/**@brief Function for switching to the radio profile requested with @ref CTRL_CMD_RADIO_PROFILE_SET.
+ *
+ * @details Only the registers that differ between the two profiles are written. A packet still in
+ *          the RX FIFO was received with the old profile and is dropped. The synthesizer is
+ *          calibrated again by the next SRX or STX (MCSM0.FS_AUTOCAL).
+ */
+static void radio_profile_poll(void)
+{
+    if (m_radio_profile_next == m_radio_profile)
+    {
+        return;
+    }
+
+    UNUSED_VARIABLE(cc1101_strobe(&m_radio, CC1101_SIDLE));
+    UNUSED_VARIABLE(cc1101_strobe(&m_radio, CC1101_SFRX));
+    m_radio_profile = m_radio_profile_next;
+    radio_profile_write();
+    UNUSED_VARIABLE(cc1101_shadow_flush(&m_radio_shadow));
+    radio_slot_airtime_update();
+}
+
+
+/**@brief Function for checking whether the radio has to be woken up.
+ *
+ * @details With slots, only for a window, anything else waits for it. Without, a credit frame or a
+ *          queued packet is sent right away, its credits may only come with the answer. A change
+ *          of budget or profile is applied awake.
+ *
+ *          The keepalive does not wake the radio: with a budget the peer is usually down as well,
+ *          and a wake every interval would cap the deepest state at about 500 ms. It goes out with
+ *          the next credit frame or packet that does, credits are sent when the window changes.
+ */
+static bool radio_has_work(void)
+{
+    if (m_radio_slot != SLOT_SYNC_FREE)
+    {
+        return (m_radio_slot != SLOT_SYNC_CLOSED);
+    }
+
+    return (m_radio_profile_next != m_radio_profile) ||
+           (power_mgr_budget_get() == 0) ||
+           link_credit_update_needed(&m_link, router_space(ROUTER_EP_RADIO)) ||
+           radio_tx_backlog();
+}
+
+
+/**@brief Function for ending a wake: receiving again, or the deeper state it was woken for.
+ */
+static void radio_wake_done(seq_t * p_seq)
+{
+    UNUSED_VARIABLE(power_mgr_wake_end(true));
+
+    if (m_radio_wake_next != POWER_MGR_IDLE)
+    {
+        power_mgr_enter(m_radio_wake_next);
+        m_radio_state = RADIO_STATE_DOWN;
+    }
+    else
+    {
+        m_radio_state = RADIO_STATE_RX;
+    }
+    // Work that came in meanwhile was held back.
+    radio_evt_post();
+}
+
+
+/**@brief Function for handling a CC1101 that did not wake.
+ */
+static void radio_wake_timeout(seq_t * p_seq)
+{
+    UNUSED_VARIABLE(power_mgr_wake_end(false));
+    CC1101_Recover(RECOVERY_CAUSE_WAKE);
+}
+
+
+/**@brief Function for waking the CC1101 from XOFF or SLEEP without waiting for the crystal.
+ *
+ * @param[in] next  State entered once it is awake, POWER_MGR_IDLE to receive and send.
+ */
+static void radio_wake_start(power_mgr_state_t next)
+{
+    m_radio_state     = RADIO_STATE_WAKE;
+    m_radio_wake_next = next;
+    if (next == POWER_MGR_IDLE)
+    {
+        radio_ts_start();
+    }
+
+    power_mgr_wake_start();
+    seq_wait(&m_radio_seq, CC1101_ChipReady, RADIO_RDY_POLL_INTERVAL, RADIO_WAKE_TIMEOUT,
+             radio_wake_done, radio_wake_timeout);
+}
+
+
+/**@brief Function for putting an idle radio in the state @ref power_mgr chooses, back in RX when
+ *        it has to keep listening.
+ *
+ * @details The idle time counts from the last packet sent or received. While a deeper state is
+ *          not allowed yet, a timer posts the radio work again once it is. With slots, the radio
+ *          listens in the windows and sleeps between them whatever the budget, and the timer
+ *          posts the radio work for the next window.
+ */
+static void radio_power_poll(void)
+{
+    uint32_t          err_code;
+    uint32_t          now;
+    uint32_t          idle;
+    uint32_t          next_ms;
+    uint32_t          next;
+    power_mgr_state_t state;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_radio_last_activity, &idle));
+    idle  = (uint32_t)(((uint64_t)idle * 1000 * (APP_TIMER_PRESCALER + 1)) / APP_TIMER_CLOCK_FREQ);
+    state = power_mgr_select(idle, &next_ms);
+    if (m_radio_slot == SLOT_SYNC_CLOSED)
+    {
+        state   = POWER_MGR_SLEEP;
+        next_ms = 0;
+    }
+    else if (m_radio_slot != SLOT_SYNC_FREE)
+    {
+        state   = POWER_MGR_RX;
+        next_ms = 0;
+    }
+
+    if (m_radio_state == RADIO_STATE_RX)
+    {
+        if (state == POWER_MGR_RX)
+        {
+            radio_rx_start();
+        }
+        else
+        {
+            power_mgr_enter(state);
+            radio_ts_stop();
+            m_radio_state = RADIO_STATE_DOWN;
+        }
+    }
+    else if (state > power_mgr_state_get())
+    {
+        // Only ever deeper while down, the idle time wraps with the RTC1 counter after 512 s.
+        radio_wake_start(state);
+    }
+
+    next = (next_ms > 0) ? APP_TIMER_TICKS(next_ms, APP_TIMER_PRESCALER) : 0;
+    if ((m_radio_slot_next > 0) && ((next == 0) || (m_radio_slot_next < next)))
+    {
+        next = m_radio_slot_next;
+    }
+    if (next > 0)
+    {
+        UNUSED_VARIABLE(app_timer_stop(m_radio_power_timer_id));
+        err_code = app_timer_start(m_radio_power_timer_id, MAX(next, APP_TIMER_MIN_TIMEOUT_TICKS), NULL);
+        APP_ERROR_CHECK(err_code);
+    }
+}
+
+
+/**@brief Function for handling the timeout of m_radio_power_timer_id.
+ */
+static void radio_power_timeout_handler(void * p_context)
+{
+    radio_evt_post();
+}
+
+
+/**@brief Function for checking the CC1101 for a fault and starting its recovery.
+ *
+ * @details The configuration is read back once per keepalive interval: a chip that was reset
+ *          behind the driver, by a brownout or a glitch on its supply, holds the reset value of
+ *          IOCFG0 instead of the shadowed one.
+ *
+ * @return true if a recovery was started.
+ */
+static bool radio_fault_poll(void)
+{
+    recovery_cause_t cause;
+
+    if (m_radio_check_due && (m_radio_state == RADIO_STATE_RX))
+    {
+        m_radio_check_due = false;
+        if (cc1101_read(&m_radio, CC1101_IOCFG0) != cc1101_shadow_get(&m_radio_shadow, CC1101_IOCFG0))
+        {
+            CC1101_Recover(RECOVERY_CAUSE_CONFIG);
+            return true;
+        }
+    }
+
+    if (m_radio_spi_fault)
+    {
+        cause = RECOVERY_CAUSE_SPI;
+    }
+    else if (m_radio.rdy_timeouts != m_radio_rdy_timeouts_seen)
+    {
+        cause = RECOVERY_CAUSE_NO_ANSWER;
+    }
+    else if (m_radio_fifo_errors >= RADIO_FIFO_ERRORS_MAX)
+    {
+        cause = RECOVERY_CAUSE_FIFO;
+    }
+    else if (m_radio_tx_timeouts >= RADIO_TX_TIMEOUTS_MAX)
+    {
+        cause = RECOVERY_CAUSE_TX;
+    }
+    else
+    {
+        return false;
+    }
+
+    CC1101_Recover(cause);
+    return true;
+}
+
+
+/**@brief Function for doing the radio work from the main loop.
+ *
+ * @details Posted by GDO0 at the end of a packet, by the router when a packet is queued for the
+ *          radio or a radio sink has freed a slot, by the end of a send and by the link keepalive
+ *          timer, which also catches a GDO0 edge that was missed, and by the power timer. At most
+ *          one packet is sent per run, its end posts the next run. With slots, nothing is sent
+ *          outside the windows, and a window starts with the beacon of the master. A radio in a low
+ *          power state is woken first, the run follows once its crystal is up.
+ *
+ *          While a phone is connected, a run that would not end before the next BLE radio event
+ *          is held back until that event is over, see @ref ble_timeline. The RX FIFO drain and the
+ *          TX FIFO load then run in one piece instead of being stretched by the SoftDevice.
+ */
+static void radio_evt_handler(void * p_event_data, uint16_t event_size)
+{
+    m_radio_evt_pending = false;
+
+    if ((m_radio_state != RADIO_STATE_RX) && (m_radio_state != RADIO_STATE_DOWN))
+    {
+        // The reset, the wake or the send in progress posts this handler when it is done.
+        return;
+    }
+
+    radio_slot_poll();
+
+    if (m_radio_state == RADIO_STATE_DOWN)
+    {
+        if (radio_has_work())
+        {
+            // radio_wake_done posts the run.
+            radio_wake_start(POWER_MGR_IDLE);
+        }
+        else
+        {
+            // Nothing to send, maybe a deeper state is due.
+            radio_power_poll();
+        }
+        return;
+    }
+
+    if (!ble_timeline_gap_fits(RADIO_RUN_TIME))
+    {
+        // Posted again at the end of the next BLE radio event.
+        return;
+    }
+
+    ble_timeline_run_begin();
+    radio_rx_poll();
+    radio_slot_poll();                                  // A beacon received opens the window.
+    radio_profile_poll();
+    if ((m_radio_slot == SLOT_SYNC_FREE) || (m_radio_slot == SLOT_SYNC_OPEN))
+    {
+        radio_sync_poll();
+        if (m_radio_state == RADIO_STATE_RX)
+        {
+            radio_link_poll();
+        }
+        if (m_radio_state == RADIO_STATE_RX)
+        {
+            radio_tx_poll();
+        }
+    }
+    if (radio_fault_poll())
+    {
+        ble_timeline_run_end();
+        return;
+    }
+    if (m_radio_state == RADIO_STATE_RX)
+    {
+        radio_power_poll();
+    }
+    ble_timeline_run_end();
+}
+
+
+/**@brief Function for handling the GDO0 pin event.
+ *
+ * @details GDO0 rises at the sync word and falls at the end of a packet, sent or received. Both
+ *          edges are timestamped, see @ref radio_ts, the radio work runs at the end.
+ */
+static void radio_gdo0_handler(nrf_drv_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
+{
+    uint16_t start = isr_prof_enter(ISR_PROF_GPIOTE);
+
+    if (radio_ts_on_edge(nrf_gpio_pin_read(RADIO_GDO0_PIN) != 0))
+    {
+        radio_evt_post();
+    }
+    isr_prof_exit(ISR_PROF_GPIOTE, start);
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_RADIO.
+ */
+static uint8_t radio_stats_get(uint8_t * p_buf)
+{
+    m_radio_stats.rdy_timeouts = m_radio.rdy_timeouts;
+    m_radio_stats.spi_accesses = m_radio.accesses;
+    memcpy(p_buf, &m_radio_stats, sizeof(m_radio_stats));
+    memcpy(&p_buf[sizeof(m_radio_stats)], &m_radio_shadow.stats, sizeof(m_radio_shadow.stats));
+    return sizeof(m_radio_stats) + sizeof(m_radio_shadow.stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_RADIO.
+ */
+static void radio_stats_clear(void)
+{
+    memset(&m_radio_stats, 0, sizeof(m_radio_stats));
+    // radio_fault_poll compares against m_radio_rdy_timeouts_seen: move it along, keeping a
+    // timeout that is not handled yet.
+    m_radio_rdy_timeouts_seen = (m_radio.rdy_timeouts != m_radio_rdy_timeouts_seen) ? UINT32_MAX : 0;
+    m_radio.rdy_timeouts = 0;
+    m_radio.accesses     = 0;
+    memset(&m_radio_shadow.stats, 0, sizeof(m_radio_shadow.stats));
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_RADIO_VERIFY.
+ */
+static uint32_t radio_verify(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    uint8_t first_diff = 0;
+
+    if ((m_radio_state == RADIO_STATE_DOWN) || (m_radio_state == RADIO_STATE_WAKE))
+    {
+        // Reading the registers would wake the chip behind the back of power_mgr.
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    p_rsp[0]   = (cc1101_shadow_verify(&m_radio_shadow, &first_diff) == NRF_SUCCESS) ? 1 : 0;
+    p_rsp[1]   = first_diff;
+    *p_rsp_len = 2;
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for timing SPI_BENCH_RUNS CC1101 transactions on one SPI path.
+ *
+ * @return Time per transaction, SS handling included, in ns.
+ */
+static uint32_t spi_bench_run(void (* transfer)(uint8_t const *, uint8_t *, uint16_t), uint16_t len)
+{
+    uint8_t  tx[SPI_BENCH_BURST] = {CC1101_IOCFG2 | CC1101_READ_BURST}; // ignored after a single byte
+    uint8_t  rx[SPI_BENCH_BURST];
+    uint32_t start;
+    uint32_t end;
+    uint32_t ticks;
+    uint8_t  i;
+
+    if (len == 2)
+    {
+        tx[0] = CC1101_IOCFG2 | CC1101_READ_SINGLE;
+    }
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&start));
+    for (i = 0; i < SPI_BENCH_RUNS; i++)
+    {
+        if (cc1101_chip_ready(&m_radio))
+        {
+            transfer(tx, rx, len);
+        }
+        cc1101_deselect(&m_radio);
+    }
+    UNUSED_VARIABLE(app_timer_cnt_get(&end));
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(end, start, &ticks));
+
+    return (uint32_t)(((uint64_t)ticks * 1000000000 * (APP_TIMER_PRESCALER + 1)) / APP_TIMER_CLOCK_FREQ / SPI_BENCH_RUNS);
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_SPI_BENCH.
+ *
+ * @details Only reads configuration registers, the radio keeps receiving. Runs between two
+ *          radio runs, as everything else in the main loop.
+ */
+static uint32_t spi_bench(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    uint32_t times[4];
+
+    if (m_radio_state != RADIO_STATE_RX)
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    times[0] = spi_bench_run(cc1101_hal_poll, 2);
+    times[1] = spi_bench_run(cc1101_hal_burst, 2);
+    times[2] = spi_bench_run(cc1101_hal_poll, SPI_BENCH_BURST);
+    times[3] = spi_bench_run(cc1101_hal_burst, SPI_BENCH_BURST);
+
+    memcpy(p_rsp, times, sizeof(times));
+    *p_rsp_len = sizeof(times);
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_RADIO_PROFILE_GET.
+ */
+static uint32_t radio_profile_cmd_get(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    radio_profile_t const * p_profile;
+    uint8_t                 name_len;
+
+    p_profile = radio_profile_get((args_len > 0) ? p_args[0] : m_radio_profile);
+    if (p_profile == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    name_len = strlen(p_profile->p_name);
+    p_rsp[0] = m_radio_profile;
+    p_rsp[1] = radio_profile_count();
+    memcpy(&p_rsp[2], &p_profile->freq_hz, sizeof(uint32_t));
+    memcpy(&p_rsp[6], &p_profile->drate_baud, sizeof(uint32_t));
+    memcpy(&p_rsp[10], p_profile->p_name, name_len);
+    *p_rsp_len = 10 + name_len;
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_RADIO_PROFILE_SET.
+ *
+ * @details The profile is kept in @ref kv as the profile used at boot first, and only applied,
+ *          by @ref radio_profile_poll once the send in progress is done, if that succeeded. A
+ *          profile that would be lost on reboot is not used.
+ */
+static uint32_t radio_profile_cmd_set(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    uint32_t err_code;
+
+    if (args_len < 1)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+    if (radio_profile_get(p_args[0]) == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    err_code = kv_write(KV_KEY_RADIO_PROFILE, &p_args[0], 1);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    m_radio_profile_next = p_args[0];
+    radio_evt_post();
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_POWER_GET.
+ */
+static uint32_t power_cmd_get(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    uint16_t budget_us = power_mgr_budget_get();
+
+    memcpy(&p_rsp[0], &budget_us, sizeof(budget_us));
+    p_rsp[2]   = power_mgr_state_get();
+    *p_rsp_len = 3;
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_POWER_SET.
+ *
+ * @details The radio is woken up by @ref radio_evt_handler when the budget drops to 0, otherwise
+ *          the new budget applies from the next idle period. It is kept in @ref kv as the budget
+ *          used at boot.
+ */
+static uint32_t power_cmd_set(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    uint16_t budget_us;
+
+    if (args_len < sizeof(budget_us))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    memcpy(&budget_us, p_args, sizeof(budget_us));
+    power_mgr_budget_set(budget_us);
+    radio_evt_post();
+    return kv_write(KV_KEY_POWER_BUDGET, p_args, sizeof(budget_us));
 }
 
 
-/**@brief   Function for handling app_uart events.
- *
- * @details This function will receive a single character from the app_uart module and append it to 
- *          a string. The string will be be sent over BLE when the last character received was a 
- *          'new line' i.e '\n' (hex 0x0D) or if the string has reached a length of 
- *          @ref NUS_MAX_DATA_LENGTH.
+/**@brief Function for handling @ref CTRL_CMD_SLOT_GET.
  */
-/**@snippet [Handling the data received over UART] */
-void uart_event_handle(app_uart_evt_t * p_event)
+static uint32_t slot_cmd_get(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
 {
-    static uint8_t data_array[BLE_NUS_MAX_DATA_LEN];
-    static uint8_t index = 0;
-    uint32_t       err_code;
-
-    switch (p_event->evt_type)
-    {
-        case APP_UART_DATA_READY:
-            UNUSED_VARIABLE(app_uart_get(&data_array[index]));
-            index++;
+    uint16_t period_ms = slot_sync_period_max_get();
 
-            if ((data_array[index - 1] == '\n') || (index >= (BLE_NUS_MAX_DATA_LEN)))
-            {
-                err_code = ble_nus_string_send(&m_nus, data_array, index);
-                if (err_code != NRF_ERROR_INVALID_STATE)
-                {
-                    APP_ERROR_CHECK(err_code);
-                }
-                
-                index = 0;
-            }
-            break;
+    memcpy(&p_rsp[0], &period_ms, sizeof(period_ms));
+    p_rsp[2]   = slot_sync_role_get();
+    *p_rsp_len = 3;
+    return NRF_SUCCESS;
+}
 
-        case APP_UART_COMMUNICATION_ERROR:
-            APP_ERROR_HANDLER(p_event->data.error_communication);
-            break;
 
-        case APP_UART_FIFO_ERROR:
-            APP_ERROR_HANDLER(p_event->data.error_code);
-            break;
+/**@brief Function for handling @ref CTRL_CMD_SLOT_SET.
+ *
+ * @details Enabling starts a search for the beacons of the peer. It is kept in @ref kv for the
+ *          next boot.
+ */
+static uint32_t slot_cmd_set(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    uint16_t period_ms;
+    uint32_t now;
 
-        default:
-            break;
+    if (args_len < sizeof(period_ms))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
     }
+
+    memcpy(&period_ms, p_args, sizeof(period_ms));
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    slot_sync_enable(period_ms, now);
+    radio_evt_post();
+    return kv_write(KV_KEY_SLOT_PERIOD, p_args, sizeof(period_ms));
 }
-/**@snippet [Handling the data received over UART] */
 
 
-/**@brief  Function for initializing the UART module.
+/**@brief Function for writing consecutive CC1101 registers for @ref cc1101_shadow.
  */
-/**@snippet [UART Initialization] */
-static void uart_init(void)
+static void radio_shadow_write(uint8_t addr, uint8_t const * p_data, uint8_t length)
 {
-    uint32_t                     err_code;
-    const app_uart_comm_params_t comm_params =
+    if (length == 1)
     {
-        RX_PIN_NUMBER,
-        TX_PIN_NUMBER,
-        RTS_PIN_NUMBER,
-        CTS_PIN_NUMBER,
-        APP_UART_FLOW_CONTROL_ENABLED,
-        false,
-        UART_BAUDRATE_BAUDRATE_Baud38400
-    };
-
-    APP_UART_FIFO_INIT( &comm_params,
-                       UART_RX_BUF_SIZE,
-                       UART_TX_BUF_SIZE,
-                       uart_event_handle,
-                       APP_IRQ_PRIORITY_LOW,
-                       err_code);
-    APP_ERROR_CHECK(err_code);
+        UNUSED_VARIABLE(cc1101_write(&m_radio, addr, p_data[0]));
+    }
+    else
+    {
+        UNUSED_VARIABLE(cc1101_write_burst(&m_radio, addr, p_data, length));
+    }
 }
-/**@snippet [UART Initialization] */
 
 
-/**@brief Function for initializing the Advertising functionality.
+/**@brief Function for reading consecutive CC1101 registers for @ref cc1101_shadow.
  */
-static void advertising_init(void)
+static void radio_shadow_read(uint8_t addr, uint8_t * p_data, uint8_t length)
 {
-    uint32_t      err_code;
-    ble_advdata_t advdata;
-    ble_advdata_t scanrsp;
+    UNUSED_VARIABLE(cc1101_read_burst(&m_radio, addr, p_data, length));
+}
 
-    // Build advertising data struct to pass into @ref ble_advertising_init.
-    memset(&advdata, 0, sizeof(advdata));
-    advdata.name_type          = BLE_ADVDATA_FULL_NAME;
-    advdata.include_appearance = false;
-    advdata.flags              = BLE_GAP_ADV_FLAGS_LE_ONLY_LIMITED_DISC_MODE;
 
-    memset(&scanrsp, 0, sizeof(scanrsp));
-    scanrsp.uuids_complete.uuid_cnt = sizeof(m_adv_uuids) / sizeof(m_adv_uuids[0]);
-    scanrsp.uuids_complete.p_uuids  = m_adv_uuids;
+/**@brief Function for resuming from @ref standby: the advertising and the link keepalive restart
+ *        and a credit frame tells the peer this end is back. Nothing else stopped.
+ */
+static void standby_resume(void)
+{
+    uint32_t err_code;
 
-    ble_adv_modes_config_t options = {0};
-    options.ble_adv_fast_enabled  = BLE_ADV_FAST_ENABLED;
-    options.ble_adv_fast_interval = APP_ADV_INTERVAL;
-    options.ble_adv_fast_timeout  = APP_ADV_TIMEOUT_IN_SECONDS;
+    err_code = bsp_indication_set(BSP_INDICATE_ADVERTISING);
+    APP_ERROR_CHECK(err_code);
+    err_code = ble_advertising_start(BLE_ADV_MODE_FAST);
+    APP_ERROR_CHECK(err_code);
+    standby_on_resumed();
 
-    err_code = ble_advertising_init(&advdata, &scanrsp, &options, on_adv_evt, NULL);
+    err_code = app_timer_start(m_link_keepalive_timer_id, LINK_KEEPALIVE_INTERVAL, NULL);
     APP_ERROR_CHECK(err_code);
+    link_credit_update_force(&m_link);                  // Wakes a radio that is down, unlike the keepalive.
+    m_radio_check_due    = true;                        // Paused with the keepalive timer.
+    radio_evt_post();
 }
 
-/**@brief Function for placing the application in low power state while waiting for events.
+
+/**@brief Function for initializing the radio driver: sequences, GDO0 interrupt and statistics.
+ *
+ * @details Needs neither the SoftDevice nor flash, so that the CC1101 reset by @ref CC1101_Init
+ *          runs while the BLE stack starts. The settings are read later by
+ *          @ref radio_settings_load, and the GDO0 timestamps are connected by @ref radio_ts_init
+ *          once the SoftDevice owns PPI.
  */
-static void power_manage(void)
+static void radio_init(void)
 {
-    uint32_t err_code = sd_app_evt_wait();
+    uint32_t                   err_code;
+    nrf_drv_gpiote_in_config_t config = GPIOTE_CONFIG_IN_SENSE_TOGGLE(true);
+
+    err_code = seq_init(&m_radio_seq, m_radio_seq_timer_id);
     APP_ERROR_CHECK(err_code);
-	
-}
+    err_code = app_timer_create(&m_radio_power_timer_id, APP_TIMER_MODE_SINGLE_SHOT, radio_power_timeout_handler);
+    APP_ERROR_CHECK(err_code);
+    cc1101_init(&m_radio);
+    cc1101_shadow_init(&m_radio_shadow, radio_shadow_write, radio_shadow_read);
+    power_mgr_init(&m_radio, &m_radio_shadow);
+    slot_sync_init(NRF_FICR->DEVICEID[0]);
 
-/**
+    err_code = nrf_drv_gpiote_in_init(RADIO_GDO0_PIN, &config, radio_gdo0_handler);
+    APP_ERROR_CHECK(err_code);
+    nrf_drv_gpiote_in_event_enable(RADIO_GDO0_PIN, true);
 
-	Beginning of CC1101 specific functions followed by the main()
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_RADIO, radio_stats_get, radio_stats_clear);
+    APP_ERROR_CHECK(err_code);
+    err_code = ctrl_cmd_register(CTRL_CMD_RADIO_VERIFY, radio_verify);
+    APP_ERROR_CHECK(err_code);
+    err_code = ctrl_cmd_register(CTRL_CMD_RADIO_PROFILE_GET, radio_profile_cmd_get);
+    APP_ERROR_CHECK(err_code);
+    err_code = ctrl_cmd_register(CTRL_CMD_RADIO_PROFILE_SET, radio_profile_cmd_set);
+    APP_ERROR_CHECK(err_code);
+    err_code = ctrl_cmd_register(CTRL_CMD_SPI_BENCH, spi_bench);
+    APP_ERROR_CHECK(err_code);
+    err_code = ctrl_cmd_register(CTRL_CMD_POWER_GET, power_cmd_get);
+    APP_ERROR_CHECK(err_code);
+    err_code = ctrl_cmd_register(CTRL_CMD_POWER_SET, power_cmd_set);
+    APP_ERROR_CHECK(err_code);
+    err_code = ctrl_cmd_register(CTRL_CMD_SLOT_GET, slot_cmd_get);
+    APP_ERROR_CHECK(err_code);
+    err_code = ctrl_cmd_register(CTRL_CMD_SLOT_SET, slot_cmd_set);
+    APP_ERROR_CHECK(err_code);
 
+    err_code = ble_timeline_init(radio_evt_post);
+    APP_ERROR_CHECK(err_code);
+}
 
-*/
 
+/**@brief Function for deciding whether the radio can spare a CPU stall, the gate of @ref flash_sched.
+ *
+ * @details Never while a packet is sent, while a packet is being received (GDO0 high) or while
+ *          radio work is waiting in the scheduler. Always while the radio is down, as nothing is
+ *          received then. Otherwise a stall shorter than the air time of the longest packet at the
+ *          current data rate is allowed: a packet starting now is still in the RX FIFO when the
+ *          stall ends. A longer stall, i.e. an erase at a high data rate, waits until the link has
+ *          been quiet for RADIO_FLASH_QUIET, as the peer is then unlikely to be in the middle of a
+ *          burst.
+ */
+static bool radio_flash_allowed(uint32_t stall_us)
+{
+    uint32_t now;
+    uint32_t quiet;
 
+    if ((m_radio_state == RADIO_STATE_TX) || nrf_gpio_pin_read(RADIO_GDO0_PIN) || m_radio_evt_pending)
+    {
+        return false;
+    }
+    if (m_radio_state == RADIO_STATE_DOWN)
+    {
+        // Nothing is received.
+        return true;
+    }
 
-//
-//function for a write burst command to the CC1101
-//
-void CC1101_WriteBurst(uint8_t address, uint8_t * data, uint16_t len)
-{
-  uint8_t burstAddress;
-  int i;
+    if (stall_us <= (uint64_t)RADIO_PACKET_AIR_BITS * 1000000 / radio_profile_get(m_radio_profile)->drate_baud)
+    {
+        return true;
+    }
 
-  burstAddress = (address | 0x40);//set R/W=0 and B=1
-  m_tx_data[0] = burstAddress; //set address
-	
-	//for loop to fill our TX BUFFER with the data passed in to the write burst function
-   for(i=1;i<=len+1;i++){
-   m_tx_data[i] = data[i-1];
-    }                                                                          
-   nrf_gpio_pin_clear(SPIM0_SS_PIN);  				//set SS low
-   while(nrf_gpio_pin_read(SPIM0_MISO_PIN));  //wait until SO goes low(0)
-   spi_send_recv(m_tx_data, m_rx_data, len);
-   while(nrf_gpio_pin_read(SPIM0_MISO_PIN));  //wait for SS to low
-   nrf_gpio_pin_set(SPIM0_SS_PIN);          //set SS high      
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_radio_last_activity, &quiet));
+    return (quiet >= RADIO_FLASH_QUIET);
 }
 
-//
-// function for read burst command
-//
-void SpiReadBurstReg(uint8_t address,uint8_t size)
+
+/**@brief Function for initializing pstorage, the flash scheduler and the key/value store.
+ */
+static void storage_init(void)
 {
-			uint8_t burstAddress;
-			int i;
-			burstAddress = (address | 0xC0);//set R/W=1 and B=1
-			
-			//clear out tx data
-			for(i = 0;i<64;i++)
-			{
-				m_tx_data[i] = 0x00;
-			}
-			//set burst address
-			m_tx_data[0] = burstAddress;
-			
-			nrf_gpio_pin_clear(SPIM0_SS_PIN);
-			
+    uint32_t err_code;
 
-			//only read 10 characters for now, willuse size input later
-			spi_send_recv(m_tx_data, m_rx_data, 10u);
-			nrf_gpio_pin_set(SPIM0_SS_PIN);
+    err_code = pstorage_init();
+    APP_ERROR_CHECK(err_code);
+    err_code = flash_sched_init(m_flash_sched_timer_id, radio_flash_allowed, FLASH_RETRY_INTERVAL);
+    APP_ERROR_CHECK(err_code);
+    err_code = kv_init();
+    APP_ERROR_CHECK(err_code);
 }
 
 
-//
-//function for a read single byte 
-//
-uint8_t CC1101_ReadSingle(uint8_t address)
-{              
-    uint8_t value[2];
-    uint8_t readAddress;
-    readAddress = (address | 0x80);                 //set R/w=1 and B=0
-    m_tx_data[0] = readAddress;											//set address
-    m_tx_data[1] = 0x00;														//send empty byte
-    nrf_gpio_pin_clear(SPIM0_SS_PIN);    						//set SS low
-    while(nrf_gpio_pin_read(SPIM0_MISO_PIN)); 		 	//wait until SO goes low(0)
-    spi_send_recv(m_tx_data, value, 2u);
-    nrf_gpio_pin_set(SPIM0_SS_PIN);     						//set SS high
-		return value[0];		
+/**@brief Function for reading the radio settings from the key/value store.
+ *
+ * @details The profile is the last one set with @ref CTRL_CMD_RADIO_PROFILE_SET, else the one
+ *          programmed in UICR, else RADIO_PROFILE_DEFAULT. The wake latency budget is the last
+ *          one set with @ref CTRL_CMD_POWER_SET, else 0, and the slots are those set with
+ *          @ref CTRL_CMD_SLOT_SET, else off. All are first used once the CC1101 reset is done, from
+ *          the main loop.
+ */
+static void radio_settings_load(void)
+{
+    uint8_t  profile;
+    uint16_t budget_us;
+    uint16_t period_ms;
+    uint32_t now;
+    uint8_t  length = sizeof(profile);
 
-}
+    if ((kv_read(KV_KEY_RADIO_PROFILE, &profile, &length) == NRF_SUCCESS) && (profile < radio_profile_count()))
+    {
+        m_radio_profile = profile;
+    }
+    else if (NRF_UICR->CUSTOMER[RADIO_PROFILE_UICR_INDEX] < radio_profile_count())
+    {
+        m_radio_profile = NRF_UICR->CUSTOMER[RADIO_PROFILE_UICR_INDEX];
+    }
+    m_radio_profile_next = m_radio_profile;
 
-//
-//function for a write single byte command
-//
-void CC1101_WriteSingle(uint8_t address, uint8_t data)
-{
-			m_tx_data[0] = address; //set address
-      m_tx_data[1] = data;
-      nrf_gpio_pin_clear(SPIM0_SS_PIN);  //set SS low
-      while(nrf_gpio_pin_read(SPIM0_MISO_PIN));  //wait until SO goes low(0)
-      spi_send_recv(m_tx_data, m_rx_data, 2u);
-      while(nrf_gpio_pin_read(SPIM0_MISO_PIN));  //wait for SS to low
-      nrf_gpio_pin_set(SPIM0_SS_PIN);          //set SS high
-                
-}
+    length = sizeof(budget_us);
+    if ((kv_read(KV_KEY_POWER_BUDGET, (uint8_t *)&budget_us, &length) == NRF_SUCCESS) && (length == sizeof(budget_us)))
+    {
+        power_mgr_budget_set(budget_us);
+    }
 
-//
-// function for sending a strobe command to the CC1101
-//
-void SpiStrobe(uint8_t Strobe)
-{
-										nrf_gpio_pin_clear(SPIM0_SS_PIN);							//set SS low
-                    while(nrf_gpio_pin_read(SPIM0_MISO_PIN));    	//wait until SO goes low(0)
-                    m_tx_data[0] = Strobe;    										//send SRES command strobe
-                    m_tx_data[1] = 0x00;    											//send empty byte
-                    while(nrf_gpio_pin_read(SPIM0_MISO_PIN));    	//wait until SO goes low(0)
-                    spi_send_recv(m_tx_data, m_rx_data, 2u);
-										nrf_gpio_pin_set(SPIM0_SS_PIN);
+    radio_slot_airtime_update();
+    length = sizeof(period_ms);
+    if ((kv_read(KV_KEY_SLOT_PERIOD, (uint8_t *)&period_ms, &length) == NRF_SUCCESS) && (length == sizeof(period_ms)))
+    {
+        UNUSED_VARIABLE(app_timer_cnt_get(&now));
+        slot_sync_enable(period_ms, now);
+    }
 }
 
-//
-// function for putting the cc1101 in transmit mode and writing to the TXFIFO
-//
-void SendDataPacket(uint8_t * TX_data,uint16_t TXFIFO_Address_Size)
-{   
-		int _STX=0x35;//Command strobe for transmit mode
-    int _SFTX=0x3B;//Command strobe for flush TXFIFO
-    int TXFIFO_Address=0x3F;//Address of TX FIFO buffer
-		sendPacket = true;
-//    SpiStrobe(_SFTX);    // Flush TXfifo
-//  
-//    nrf_gpio_pin_set(SPIM0_SS_PIN);
-		
-		nrf_delay_us(1000);
-    CC1101_WriteBurst(TXFIFO_Address, TX_data, TXFIFO_Address_Size);//Sends a burst command indicating data and address to send to
-		//sendPacket = true;
-    SpiStrobe(_STX);//Send transmit mode command strobe
-		nrf_delay_ms(1000);
 
-		SpiStrobe(_SFTX);    // Flush TXfifo
-		nrf_delay_us(100);
-		nrf_gpio_pin_set(SPIM0_SS_PIN);
+/**@brief Function for initializing the SPI master of the CC1101.
+ */
+static uint32_t spi_init(void)
+{
+    uint32_t                   err_code;
+    nrf_drv_spi_config_t const config =
+    {
+        #if (SPI0_ENABLED == 1)
+            .sck_pin  = SPIM0_SCK_PIN,
+            .mosi_pin = SPIM0_MOSI_PIN,
+            .miso_pin = SPIM0_MISO_PIN,
+            .ss_pin   = NRF_DRV_SPI_PIN_NOT_USED,      // SS belongs to the CC1101 driver
+        #elif (SPI1_ENABLED == 1)
+            .sck_pin  = SPIM1_SCK_PIN,
+            .mosi_pin = SPIM1_MOSI_PIN,
+            .miso_pin = SPIM1_MISO_PIN,
+            .ss_pin   = NRF_DRV_SPI_PIN_NOT_USED,      // SS belongs to the CC1101 driver
+        #elif (SPI2_ENABLED == 1)
+            .sck_pin  = SPIM2_SCK_PIN,
+            .mosi_pin = SPIM2_MOSI_PIN,
+            .miso_pin = SPIM2_MISO_PIN,
+            .ss_pin   = NRF_DRV_SPI_PIN_NOT_USED,      // SS belongs to the CC1101 driver
+        #endif
+        .irq_priority = APP_IRQ_PRIORITY_HIGH,             // a byte per interrupt, not held back by UART or GPIOTE
+        .orc          = 0xCC,
+        .frequency    = SPI_FREQUENCY,
+        .mode         = NRF_DRV_SPI_MODE_0,
+        .bit_order    = NRF_DRV_SPI_BIT_ORDER_MSB_FIRST,
+    };
+
+    err_code = nrf_drv_spi_init(&m_spi_master, &config, spi_master_event_handler);
+    return err_code;
 }
 
-//
-// function for putting the cc1101 in receive mode and reading from the RXFIFO
-//
-int RecvDataPacket(void)
+
+/**@brief Function for starting the SPI master of the CC1101, or starting it over.
+ *
+ * @details A failure is a radio fault rather than a fatal error: the radio work starts a recovery,
+ *          which tries again. Until then the transfers read 0xFF.
+ */
+static void spi_start(void)
 {
-	uint8_t size;
-	uint8_t RXSTROBE = 0x34;//value of RXSTROBE
-	uint8_t RXFIFO = 0x3F;	//address of RXFIFO
-  uint8_t SFRX = 0x3A;		//SFRX strobe value
-	
-		SpiStrobe(RXSTROBE);								//rx Strobe
-		nrf_delay_ms(500);
-		size = CC1101_ReadSingle(RXFIFO);		//read from RXFIFO
-		SpiReadBurstReg(RXFIFO, 10u);				//burst read from RXFIFO	
-		SpiStrobe(SFRX);										//flush RX FIFO
-		return size;												//returns number of bytes received
+    if (m_spi_ready)
+    {
+        nrf_drv_spi_uninit(&m_spi_master);
+    }
 
+    m_spi_ready = (spi_init() == NRF_SUCCESS);
+    if (!m_spi_ready)
+    {
+        m_radio_spi_fault = true;
+    }
 }
 
 
@@ -858,146 +2879,207 @@ int main(void)
     uint8_t  start_string[] = START_STRING;
     printf("%s",start_string);
     // Initialize timer.
-    APP_TIMER_INIT(APP_TIMER_PRESCALER, APP_TIMER_OP_QUEUE_SIZE, false);
+    scheduler_init();
+    lfclk_start();
+    APP_TIMER_APPSH_INIT(APP_TIMER_PRESCALER, APP_TIMER_OP_QUEUE_SIZE, true);
+    boot_prof_mark(BOOT_PROF_TIMERS);
+#if (UART_FRAMING == UART_FRAMING_COBS)
+    uart_frame_decoder_reset(&m_uart_decoder);
+#endif
+    ctrl_init();
+    cpu_load_init();
+    isr_prof_init();
+    recovery_init();
+    bridge_init();
 		nrf_drv_gpiote_init();
     uart_init();
+    spi_start();
     //buttons_leds_init(&erase_bonds);
+    boot_prof_mark(BOOT_PROF_DRIVERS);
+
+    // The CC1101 reset waits on app_timer, its steps run from the main loop. Started first so that
+    // the waits pass while the SoftDevice and the advertising start, packets wait in the radio
+    // queue until it is configured.
+    radio_init();
+    CC1101_Init();
+    boot_prof_mark(BOOT_PROF_RADIO_START);
+
     ble_stack_init();
+    err_code = radio_ts_init(nrf_drv_gpiote_in_event_addr_get(RADIO_GDO0_PIN));
+    APP_ERROR_CHECK(err_code);
+    boot_prof_mark(BOOT_PROF_BLE_STACK);
+    storage_init();
+    energy_init();
+    radio_settings_load();
+    boot_prof_mark(BOOT_PROF_STORAGE);
         
     gap_params_init();
     services_init();
     advertising_init();
     conn_params_init();
+    standby_init(standby_resume);
+    boot_prof_mark(BOOT_PROF_SERVICES);
 
     err_code = ble_advertising_start(BLE_ADV_MODE_FAST);
-
     APP_ERROR_CHECK(err_code);
-		
-      //More SPI Additions
-         nrf_drv_spi_config_t const config =
+    boot_prof_mark(BOOT_PROF_ADVERTISING);
+
+    boot_prof_mark(BOOT_PROF_MAIN_LOOP);
+    boot_prof_report();
+
+    // Enter main loop. Everything runs from the scheduler, posted by interrupts and timers.
+    for (;;)
     {
-        #if (SPI0_ENABLED == 1)
-            .sck_pin  = SPIM0_SCK_PIN,
-            .mosi_pin = SPIM0_MOSI_PIN,
-            .miso_pin = SPIM0_MISO_PIN,
-            .ss_pin   = SPIM0_SS_PIN,
-        #elif (SPI1_ENABLED == 1)
-            .sck_pin  = SPIM1_SCK_PIN,
-            .mosi_pin = SPIM1_MOSI_PIN,
-            .miso_pin = SPIM1_MISO_PIN,
-            .ss_pin   = SPIM1_SS_PIN,
-        #elif (SPI2_ENABLED == 1)
-            .sck_pin  = SPIM2_SCK_PIN,
-            .mosi_pin = SPIM2_MOSI_PIN,
-            .miso_pin = SPIM2_MISO_PIN,
-            .ss_pin   = SPIM2_SS_PIN,
-        #endif
-        .irq_priority = APP_IRQ_PRIORITY_LOW,
-        .orc          = 0xCC,
-        .frequency    = NRF_DRV_SPI_FREQ_1M,
-        .mode         = NRF_DRV_SPI_MODE_0,
-        .bit_order    = NRF_DRV_SPI_BIT_ORDER_MSB_FIRST,
-    };
-    ret_code_t err_code1 = nrf_drv_spi_init(&m_spi_master, &config, spi_master_event_handler);
-    APP_ERROR_CHECK(err_code1);
-		
-		/*
-		
-		End of Initializing services for the Nordic Board	
-		
-		Beginning of CC1101 initializing.
-		
-		*/
+        app_sched_execute();
+        recovery_wdt_feed();
+        power_manage();
+    }
+}
+//
+// manual power-on reset of the CC1101: SS pulse, SRES once CHIP_RDYn is low, configuration once it is
+// low again. Every wait is a step of m_radio_seq, the radio work starts once the chip is configured.
+//
+static void CC1101_InitSsHigh(seq_t * p_seq);
+static void CC1101_InitWaitReady(seq_t * p_seq);
+static void CC1101_InitReset(seq_t * p_seq);
+static void CC1101_InitDone(seq_t * p_seq);
+static void CC1101_InitTimeout(seq_t * p_seq);
+
+//
+// condition polled by the reset sequence, SS stays low while waiting
+//
+static bool CC1101_ChipReady(void)
+{
+	return cc1101_chip_ready(&m_radio);
+}
+
+static void CC1101_InitStart(seq_t * p_seq)
+{
+	m_radio_state = RADIO_STATE_INIT;
+	power_mgr_state_set(POWER_MGR_IDLE);
 
-    CC1101_Init();
-		
-		
-		// Enter main loop.
-		for (;;)
-    {	
-			//
-			//for setting in receive mode
-			//
-			RecvDataPacket();
-			SEGGER_RTT_WriteString(0,"RX data:");
-			for(uint32_t i = 0; i<8;i++){
-				SEGGER_RTT_printf(0,"%x",m_rx_data[i]);
-			}
-			SEGGER_RTT_WriteString(0,"\n");
-            
-			//
-			//for sending data that was recieved from the BTLE event			
-			//
-       if(m_transfer_completed & newData)
-       {
-				m_transfer_completed = false;
-        newData = false;
-				SendDataPacket(txt_data, strlen((char *) txt_data) + 1);//Additional byte (5+1) is header byte
-        nrf_delay_ms(1);
-                    
-       }
-                
-    }
-}
-void CC1101_Init(void){
-	
 	//sequence of SS pin on/off to indicate we are going to reset the system
-	
-	nrf_gpio_pin_clear(SPIM0_SS_PIN);
-	nrf_delay_ms(1);
-	nrf_gpio_pin_set(SPIM0_SS_PIN);
-	nrf_delay_ms(1);
-	nrf_gpio_pin_clear(SPIM0_SS_PIN);
-	
-	//strobe CC1101 reset
-	uint8_t SRES = 0x30;
-	SpiStrobe(SRES);	
-	nrf_delay_ms(5);
-	
+	UNUSED_VARIABLE(cc1101_chip_ready(&m_radio));
+	seq_delay(&m_radio_seq, RADIO_RESET_PULSE, CC1101_InitSsHigh);
+}
+
+static void CC1101_InitSsHigh(seq_t * p_seq)
+{
+	cc1101_deselect(&m_radio);
+	seq_delay(&m_radio_seq, RADIO_RESET_PULSE, CC1101_InitWaitReady);
+}
+
+static void CC1101_InitWaitReady(seq_t * p_seq)
+{
+	seq_wait(&m_radio_seq, CC1101_ChipReady, RADIO_RDY_POLL_INTERVAL, RADIO_RDY_TIMEOUT,
+	         CC1101_InitReset, CC1101_InitTimeout);
+}
+
+static void CC1101_InitReset(seq_t * p_seq)
+{
+	//strobe CC1101 reset, CHIP_RDYn goes low again once it is done
+	UNUSED_VARIABLE(cc1101_strobe(&m_radio, CC1101_SRES));
+	cc1101_shadow_invalidate(&m_radio_shadow);		//the chip is back to its reset values
+	seq_wait(&m_radio_seq, CC1101_ChipReady, RADIO_RDY_POLL_INTERVAL, RADIO_RDY_TIMEOUT,
+	         CC1101_InitDone, CC1101_InitTimeout);
+}
+
+static void CC1101_InitDone(seq_t * p_seq)
+{
+	cc1101_deselect(&m_radio);
+
 	//calibrate CC1101
 	CC1101_Calibrate();
-	nrf_delay_ms(1);
-	
+	m_radio_rdy_timeouts_seen = m_radio.rdy_timeouts;
+	recovery_done();
+
+	radio_rx_start();
+	radio_evt_post();
+
+	boot_prof_mark(BOOT_PROF_RADIO_READY);
+	boot_prof_report();
+}
+
+static void CC1101_InitTimeout(seq_t * p_seq)
+{
+	//no answer from the chip, try again later
+	cc1101_deselect(&m_radio);
+	m_radio.rdy_timeouts++;
+	recovery_escalate();
+	seq_delay(&m_radio_seq, RADIO_INIT_RETRY_INTERVAL, CC1101_InitStart);
+}
+
+//
+// starts the reset sequence and returns, the radio is used once it is done
+//
+void CC1101_Init(void)
+{
+	CC1101_InitStart(&m_radio_seq);
+}
+
+//
+// hot reset of a CC1101 that misbehaves: SRES once CHIP_RDYn is low, then the shadowed configuration
+// is written back, all within milliseconds. the queues, the link state and the slots are kept. a chip
+// that does not answer falls back to the power-on reset sequence above
+//
+static void CC1101_Recover(recovery_cause_t cause)
+{
+	recovery_start(cause);
+
+	seq_cancel(&m_radio_seq);				//a send in progress is abandoned
+	cc1101_deselect(&m_radio);
+	radio_ts_start();
+	m_radio_state       = RADIO_STATE_INIT;
+	m_radio_tx_beacon   = false;
+	m_radio_spi_fault   = false;
+	m_radio_fifo_errors = 0;
+	m_radio_tx_timeouts = 0;
+	power_mgr_state_set(POWER_MGR_IDLE);
+	if (cause == RECOVERY_CAUSE_SPI)
+	{
+		spi_start();					//failing again sets m_radio_spi_fault, another recovery follows
+	}
+
+	seq_wait(&m_radio_seq, CC1101_ChipReady, RADIO_RDY_POLL_INTERVAL, RADIO_RDY_TIMEOUT,
+	         CC1101_InitReset, CC1101_InitTimeout);
 }
+//
+// configuration of the CC1101 common to every radio profile, written through the shadow so only what
+// differs from the chip is sent. band and data rate dependent registers come from radio_profile.c
+//
+static cc1101_reg_t const m_radio_config[] =
+{
+    {CC1101_FSCTRL0, 0x00},                                         // FSCTRL0
+    {CC1101_CHANNR, 0x00},                                          // CHANNR
+    {CC1101_FREND1, 0x56},                                          // FREND1
+    {CC1101_FREND0, 0x10},                                          // FREND0
+    {CC1101_MCSM0, 0x18},                                           // MCSM0
+    {CC1101_MCSM1, 0x30},                                           // MCSM1 CCA unless receiving, idle after send/receive
+    {CC1101_FOCCFG, 0x16},                                          // FOCCFG
+    {CC1101_BSCFG, 0x6C},                                           // BSCFG
+    {CC1101_AGCCTRL1, 0x40},                                        // AGCCTRL1
+    {CC1101_AGCCTRL0, 0x91},                                        // AGCCTRL0
+    {CC1101_FSCAL3, 0xE9},                                          // FSCAL3
+    {CC1101_FSCAL2, 0x2A},                                          // FSCAL2
+    {CC1101_FSCAL1, 0x00},                                          // FSCAL1
+    {CC1101_FSCAL0, 0x1F},                                          // FSCAL0
+    {CC1101_FSTEST, 0x59},                                          // FSTEST
+    {CC1101_TEST2, 0x81},                                           // TEST2
+    {CC1101_TEST1, 0x35},                                           // TEST1
+    {CC1101_TEST0, 0x09},                                           // TEST0
+    {CC1101_IOCFG2, 0x29},                                          // IOCFG2
+    {CC1101_IOCFG0, 0x06},                                          // IOCFG0
+    {CC1101_PKTCTRL1, 0x04},                                        // PKTCTRL1
+    {CC1101_ADDR, 0x00},                                            // ADDR
+    {CC1101_PKTLEN, RADIO_PACKET_MAX},                              // PKTLEN
+    {CC1101_SYNC1, 0xD3},                                           // SYNC1
+    {CC1101_SYNC0, 0x91},                                           // SYNC0
+    {CC1101_FIFOTHR, 0x47},                                         // FIFO THR
+};
+
 void CC1101_Calibrate(void)
 {
-                CC1101_WriteSingle(0x0B,0x06);              //FSCTRL1
-                CC1101_WriteSingle(0x0C,0x00);              //FSCTRL0
-                CC1101_WriteSingle(0x0D,0x21);              //FREQ2
-                CC1101_WriteSingle(0x0E,0x62);              //FREQ1
-                CC1101_WriteSingle(0x0F,0x76);              //FREQ0
-                CC1101_WriteSingle(0x10,0xF5);              //MDMCFG4
-                CC1101_WriteSingle(0x11,0x83);              //MDMCFG3
-                CC1101_WriteSingle(0x12,0x13);              //MDMCFG2
-                CC1101_WriteSingle(0x13,0x22);              //MDMCFG1
-                CC1101_WriteSingle(0x14,0xF8);              //MDMCFG0
-                CC1101_WriteSingle(0x0A,0x00);              //CHANNR
-                CC1101_WriteSingle(0x15,0x15);              //DEVIATN
-                CC1101_WriteSingle(0x21,0x56);              //FREND1
-                CC1101_WriteSingle(0x22,0x10);              //FREND0
-                CC1101_WriteSingle(0x18,0x18);              //MCSM0
-								CC1101_WriteSingle(0x17,0x00);							//MCSM1 set to idle after send/receive
-                CC1101_WriteSingle(0x19,0x16);              //FOCCFG
-                CC1101_WriteSingle(0x1A,0x6C);              //BSCFG
-                CC1101_WriteSingle(0x1B,0x03);              //AGCCTRL2
-                CC1101_WriteSingle(0x1C,0x40);              //AGCCTRL1
-                CC1101_WriteSingle(0x1D,0x91);              //AGCCTRL0
-                CC1101_WriteSingle(0x23,0xE9);              //FSCAL3
-                CC1101_WriteSingle(0x24,0x2A);              //FSCAL2
-                CC1101_WriteSingle(0x25,0x00);              //FSCAL1
-                CC1101_WriteSingle(0x26,0x1F);              //FSCAL0
-                CC1101_WriteSingle(0x29,0x59);              //FSTEST
-                CC1101_WriteSingle(0x2C,0x81);              //TEST2
-                CC1101_WriteSingle(0x2D,0x35);              //TEST1
-                CC1101_WriteSingle(0x2E,0x09);              //TEST0
-                CC1101_WriteSingle(0x00,0x29);              //IOCFG2
-                CC1101_WriteSingle(0x02,0x06);              //IOCFG0
-                CC1101_WriteSingle(0x07,0x04);              //PKTCTRL1
-                CC1101_WriteSingle(0x08,0x05);              //PKTCTRL0
-                CC1101_WriteSingle(0x09,0x00);              //ADDR
-                CC1101_WriteSingle(0x06,0xFF);              //PKTLEN
-                CC1101_WriteSingle(0x04,0xD3);              //SYNC1
-                CC1101_WriteSingle(0x05,0x91);              //SYNC0
-                CC1101_WriteSingle(0x03,0x47);              //FIFO THR
-
-}
\ No newline at end of file
+    cc1101_shadow_set_list(&m_radio_shadow, m_radio_config, sizeof(m_radio_config) / sizeof(m_radio_config[0]));
+    radio_profile_write();
+    UNUSED_VARIABLE(cc1101_shadow_flush(&m_radio_shadow));
+}
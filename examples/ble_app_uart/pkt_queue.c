@@ -0,0 +1,95 @@
+/** @file
+ *
+ * @brief Packet queue implementation.
+ */
+
+#include "pkt_queue.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "app_timer.h"
+
+
+uint32_t pkt_queue_init(pkt_queue_t * p_queue, pkt_t * p_buf, uint8_t size)
+{
+    if ((p_queue == NULL) || (p_buf == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    // Free running uint8_t indices only wrap correctly for power of two sizes up to 128.
+    if ((size == 0) || (size > 128) || ((size & (size - 1)) != 0))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    p_queue->p_buf     = p_buf;
+    p_queue->size_mask = size - 1;
+    p_queue->read_pos  = 0;
+    p_queue->write_pos = 0;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t pkt_queue_put(pkt_queue_t * p_queue, uint8_t port, uint8_t const * p_data, uint8_t length)
+{
+    uint32_t now;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    return pkt_queue_put_at(p_queue, port, p_data, length, now);
+}
+
+
+uint32_t pkt_queue_put_at(pkt_queue_t *   p_queue,
+                          uint8_t         port,
+                          uint8_t const * p_data,
+                          uint8_t         length,
+                          uint32_t        timestamp)
+{
+    pkt_t * p_slot;
+
+    if ((length == 0) || (length > PKT_QUEUE_DATA_MAX))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+    if (pkt_queue_is_full(p_queue))
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    p_slot         = &p_queue->p_buf[p_queue->write_pos & p_queue->size_mask];
+    p_slot->length    = length;
+    p_slot->port      = port;
+    p_slot->timestamp = timestamp;
+    memcpy(p_slot->data, p_data, length);
+
+    // Publish the slot only once it is completely written.
+    p_queue->write_pos++;
+
+    return NRF_SUCCESS;
+}
+
+
+pkt_t * pkt_queue_peek(pkt_queue_t * p_queue)
+{
+    if (pkt_queue_count(p_queue) == 0)
+    {
+        return NULL;
+    }
+
+    return &p_queue->p_buf[p_queue->read_pos & p_queue->size_mask];
+}
+
+
+uint32_t pkt_queue_pop(pkt_queue_t * p_queue)
+{
+    if (pkt_queue_count(p_queue) == 0)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    p_queue->read_pos++;
+
+    return NRF_SUCCESS;
+}
@@ -0,0 +1,119 @@
+/** @file
+ *
+ * @defgroup pkt_queue Packet queue
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    FIFO of whole packets used between the stages of the UART/BLE/radio bridge.
+ *
+ * @details The queue works like @ref app_fifo, but every element is a complete packet of up to
+ *          @ref PKT_QUEUE_DATA_MAX bytes instead of a single byte. The buffer is supplied by the
+ *          caller and its number of slots must be a power of two.
+ *
+ * @note    A queue has no internal locking. One producer and one consumer running at the same
+ *          interrupt priority (or one of them in thread mode) is safe.
+ */
+
+#ifndef PKT_QUEUE_H__
+#define PKT_QUEUE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "compiler_abstraction.h"
+
+#define PKT_QUEUE_DATA_MAX              61                                          /**< Largest payload held by one slot (one CC1101 FIFO packet). */
+
+/**@brief A single queued packet. */
+typedef struct
+{
+    uint32_t timestamp;                                                             /**< RTC1 counter when the packet was queued, or received, see @ref pkt_queue_put_at. */
+    uint8_t  length;                                                                /**< Number of valid bytes in data. */
+    uint8_t  port;                                                                  /**< Logical port of the packet, see @ref router. */
+    uint8_t  data[PKT_QUEUE_DATA_MAX];                                              /**< Packet payload. */
+} pkt_t;
+
+/**@brief Packet queue instance. */
+typedef struct
+{
+    pkt_t *          p_buf;                                                         /**< Slot storage supplied by the user. */
+    uint8_t          size_mask;                                                     /**< Number of slots minus one. */
+    volatile uint8_t read_pos;                                                      /**< Free running index of the next slot to read. */
+    volatile uint8_t write_pos;                                                     /**< Free running index of the next slot to write. */
+} pkt_queue_t;
+
+/**@brief Function for initializing a packet queue.
+ *
+ * @param[out] p_queue  Queue instance.
+ * @param[in]  p_buf    Slot storage.
+ * @param[in]  size     Number of slots in p_buf. Must be a power of two, at most 128.
+ *
+ * @retval NRF_SUCCESS              Queue initialized.
+ * @retval NRF_ERROR_NULL           A NULL pointer was supplied.
+ * @retval NRF_ERROR_INVALID_LENGTH size is not a power of two or is too large.
+ */
+uint32_t pkt_queue_init(pkt_queue_t * p_queue, pkt_t * p_buf, uint8_t size);
+
+/**@brief Function for copying a packet into the queue.
+ *
+ * @details The packet is stamped with the app_timer counter, to measure queueing latency.
+ *
+ * @param[in] p_queue  Queue instance.
+ * @param[in] port     Logical port stored with the packet.
+ * @param[in] p_data   Packet data.
+ * @param[in] length   Packet length.
+ *
+ * @retval NRF_SUCCESS              Packet queued.
+ * @retval NRF_ERROR_INVALID_LENGTH length is zero or larger than @ref PKT_QUEUE_DATA_MAX.
+ * @retval NRF_ERROR_NO_MEM         The queue is full.
+ */
+uint32_t pkt_queue_put(pkt_queue_t * p_queue, uint8_t port, uint8_t const * p_data, uint8_t length);
+
+/**@brief Function for copying a packet into the queue with the time it was received, e.g. the
+ *        hardware timestamp of its end on the radio.
+ *
+ * @param[in] timestamp  RTC1 counter stored with the packet.
+ *
+ * @return As @ref pkt_queue_put.
+ */
+uint32_t pkt_queue_put_at(pkt_queue_t *   p_queue,
+                          uint8_t         port,
+                          uint8_t const * p_data,
+                          uint8_t         length,
+                          uint32_t        timestamp);
+
+/**@brief Function for getting the oldest packet without removing it.
+ *
+ * @details The returned slot stays valid until @ref pkt_queue_pop is called. This lets a consumer
+ *          retry a packet that a lower layer could not accept yet.
+ *
+ * @return Pointer to the oldest packet, or NULL if the queue is empty.
+ */
+pkt_t * pkt_queue_peek(pkt_queue_t * p_queue);
+
+/**@brief Function for removing the oldest packet.
+ *
+ * @retval NRF_SUCCESS          Packet removed.
+ * @retval NRF_ERROR_NOT_FOUND  The queue is empty.
+ */
+uint32_t pkt_queue_pop(pkt_queue_t * p_queue);
+
+/**@brief Function for getting the number of packets in the queue. */
+static __INLINE uint8_t pkt_queue_count(pkt_queue_t const * p_queue)
+{
+    return (uint8_t)(p_queue->write_pos - p_queue->read_pos);
+}
+
+/**@brief Function for getting the number of free slots in the queue. */
+static __INLINE uint8_t pkt_queue_space(pkt_queue_t const * p_queue)
+{
+    return (uint8_t)(p_queue->size_mask + 1 - pkt_queue_count(p_queue));
+}
+
+/**@brief Function for checking whether the queue is full. */
+static __INLINE bool pkt_queue_is_full(pkt_queue_t const * p_queue)
+{
+    return (pkt_queue_space(p_queue) == 0);
+}
+
+#endif // PKT_QUEUE_H__
+
+/** @} */
@@ -0,0 +1,137 @@
+/** @file
+ *
+ * @brief Packet scheduler implementation.
+ */
+
+#include "pkt_sched.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "app_timer.h"
+
+
+uint32_t pkt_sched_init(pkt_sched_t *   p_sched,
+                        pkt_queue_t *   p_queues,
+                        uint8_t         count,
+                        uint8_t const * p_weights)
+{
+    uint8_t i;
+
+    if ((count == 0) || (count > PKT_SCHED_QUEUES_MAX))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    memset(p_sched, 0, sizeof(*p_sched));
+    for (i = 1; i < count; i++)
+    {
+        if (p_weights[i] == 0)
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+        p_sched->weights[i] = p_weights[i];
+    }
+
+    p_sched->p_queues = p_queues;
+    p_sched->count    = count;
+    p_sched->current  = 1;
+    p_sched->credit   = p_sched->weights[1];
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for checking whether a lower priority queue holds a packet that waited longer
+ *        than the packet taken from queue.
+ */
+static bool is_preemption(pkt_sched_t * p_sched, uint8_t queue, uint32_t now, uint32_t latency)
+{
+    pkt_t  * p_pkt;
+    uint32_t waited;
+    uint8_t  i;
+
+    for (i = queue + 1; i < p_sched->count; i++)
+    {
+        p_pkt = pkt_queue_peek(&p_sched->p_queues[i]);
+        if (p_pkt == NULL)
+        {
+            continue;
+        }
+        UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, p_pkt->timestamp, &waited));
+        if (waited > latency)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+pkt_t * pkt_sched_next(pkt_sched_t * p_sched, uint8_t * p_queue)
+{
+    pkt_t * p_pkt;
+    uint8_t i;
+
+    p_pkt = pkt_queue_peek(&p_sched->p_queues[0]);
+    if (p_pkt != NULL)
+    {
+        *p_queue = 0;
+        return p_pkt;
+    }
+
+    // Keep the turn while it has credit, otherwise pass it on to the next non-empty queue.
+    for (i = 0; i < p_sched->count; i++)
+    {
+        if (p_sched->current >= p_sched->count)
+        {
+            p_sched->current = 1;
+            p_sched->credit  = p_sched->weights[1];
+        }
+
+        if (p_sched->credit > 0)
+        {
+            p_pkt = pkt_queue_peek(&p_sched->p_queues[p_sched->current]);
+            if (p_pkt != NULL)
+            {
+                *p_queue = p_sched->current;
+                return p_pkt;
+            }
+        }
+
+        p_sched->current++;
+        if (p_sched->current < p_sched->count)
+        {
+            p_sched->credit = p_sched->weights[p_sched->current];
+        }
+    }
+
+    return NULL;
+}
+
+
+void pkt_sched_sent(pkt_sched_t * p_sched, uint8_t queue, uint32_t now)
+{
+    pkt_sched_stats_t * p_stats = &p_sched->stats[queue];
+    pkt_t             * p_pkt   = pkt_queue_peek(&p_sched->p_queues[queue]);
+    uint32_t            latency;
+
+    if (p_pkt == NULL)
+    {
+        return;
+    }
+
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, p_pkt->timestamp, &latency));
+    p_stats->sent++;
+    p_stats->latency_total += latency;
+    p_stats->latency_max    = MAX(p_stats->latency_max, latency);
+
+    if (is_preemption(p_sched, queue, now, latency))
+    {
+        p_stats->preemptions++;
+    }
+
+    if ((queue != 0) && (queue == p_sched->current) && (p_sched->credit > 0))
+    {
+        p_sched->credit--;
+    }
+}
@@ -0,0 +1,87 @@
+/** @file
+ *
+ * @defgroup pkt_sched Packet scheduler
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Strict priority and weighted round robin over a set of @ref pkt_queue.
+ *
+ * @details Queue 0 is the priority class and is always served first. The other queues share what
+ *          is left by weighted round robin: once selected, queue n may send up to weight[n] packets
+ *          in a row before the next non-empty queue gets its turn. An empty queue gives up its turn,
+ *          so the link is never idle while a packet is waiting. On the radio no port uses the
+ *          priority class by default, and the link control frames do not go through the queues.
+ *
+ *          The decision is taken when the consumer is ready to send, i.e. just before a packet is
+ *          loaded into the radio. A priority packet queued while bulk packets are waiting is
+ *          therefore sent next, which is counted as a preemption.
+ *
+ *          The time every packet spent queued is accumulated per queue from @ref pkt_t::timestamp.
+ */
+
+#ifndef PKT_SCHED_H__
+#define PKT_SCHED_H__
+
+#include <stdint.h>
+#include "pkt_queue.h"
+
+#define PKT_SCHED_QUEUES_MAX            3                                           /**< Largest number of queues of a scheduler. */
+
+/**@brief Statistics of one queue. */
+typedef struct
+{
+    uint32_t sent;                                                                  /**< Packets taken from the queue. */
+    uint32_t latency_total;                                                         /**< Sum of the time packets spent queued, in RTC1 ticks. */
+    uint32_t latency_max;                                                           /**< Longest time a packet spent queued, in RTC1 ticks. */
+    uint32_t preemptions;                                                           /**< Packets sent while an older packet of a lower priority queue waited. */
+} pkt_sched_stats_t;
+
+/**@brief Scheduler instance. */
+typedef struct
+{
+    pkt_queue_t *     p_queues;                                                     /**< Queues, queue 0 is the strict priority class. */
+    uint8_t           count;                                                        /**< Number of queues. */
+    uint8_t           weights[PKT_SCHED_QUEUES_MAX];                                /**< Packets per turn of queues 1 and up. */
+    uint8_t           current;                                                      /**< Queue holding the round robin turn. */
+    uint8_t           credit;                                                       /**< Packets left in the turn of current. */
+    pkt_sched_stats_t stats[PKT_SCHED_QUEUES_MAX];                                  /**< Statistics per queue. */
+} pkt_sched_t;
+
+/**@brief Function for initializing a scheduler.
+ *
+ * @param[out] p_sched    Scheduler instance.
+ * @param[in]  p_queues   Initialized queues, in priority order.
+ * @param[in]  count      Number of queues, at most @ref PKT_SCHED_QUEUES_MAX.
+ * @param[in]  p_weights  Weight of every queue. The weight of queue 0 is not used.
+ *
+ * @retval NRF_SUCCESS              Scheduler initialized.
+ * @retval NRF_ERROR_INVALID_LENGTH count is 0 or too large.
+ * @retval NRF_ERROR_INVALID_PARAM  A weight of queue 1 or up is zero.
+ */
+uint32_t pkt_sched_init(pkt_sched_t *   p_sched,
+                        pkt_queue_t *   p_queues,
+                        uint8_t         count,
+                        uint8_t const * p_weights);
+
+/**@brief Function for selecting the next packet to send.
+ *
+ * @details The packet stays in its queue. Once it has been handed to the lower layer the consumer
+ *          calls @ref pkt_sched_sent, and then removes it from the queue.
+ *
+ * @param[in]  p_sched  Scheduler instance.
+ * @param[out] p_queue  Queue of the selected packet.
+ *
+ * @return The selected packet, or NULL if all queues are empty.
+ */
+pkt_t * pkt_sched_next(pkt_sched_t * p_sched, uint8_t * p_queue);
+
+/**@brief Function for accounting a packet returned by @ref pkt_sched_next.
+ *
+ * @param[in] p_sched  Scheduler instance.
+ * @param[in] queue    Queue of the packet.
+ * @param[in] now      RTC1 counter when the packet was handed to the lower layer.
+ */
+void pkt_sched_sent(pkt_sched_t * p_sched, uint8_t queue, uint32_t now);
+
+#endif // PKT_SCHED_H__
+
+/** @} */
@@ -0,0 +1,208 @@
+/** @file
+ *
+ * @brief Power manager implementation.
+ */
+
+#include "power_mgr.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "ctrl.h"
+
+STATIC_ASSERT(sizeof(power_mgr_stats_t) <= CTRL_RSP_DATA_MAX);
+
+/**@brief Low power state, with the idle time it needs and the time it takes to leave it. */
+typedef struct
+{
+    power_mgr_state_t state;                                                        /**< State. */
+    uint16_t          after_ms;                                                     /**< Idle time before it is entered. */
+    uint16_t          wake_us;                                                      /**< Wake latency, on top of the calibration of every SRX or STX. */
+} power_mgr_level_t;
+
+/**@brief Low power states, deepest first. */
+static power_mgr_level_t const m_levels[] =
+{
+    {POWER_MGR_SLEEP, POWER_MGR_SLEEP_AFTER_MS, POWER_MGR_SLEEP_WAKE_US},
+    {POWER_MGR_XOFF,  POWER_MGR_XOFF_AFTER_MS,  POWER_MGR_XOFF_WAKE_US},
+    {POWER_MGR_IDLE,  POWER_MGR_RX_LINGER_MS,   0},
+};
+
+static cc1101_t *        mp_radio;                                                  /**< CC1101 driver. */
+static cc1101_shadow_t * mp_shadow;                                                 /**< Configuration restored after SLEEP. */
+static power_mgr_stats_t m_stats;                                                   /**< Statistics. */
+static power_mgr_state_t m_state = POWER_MGR_IDLE;                                  /**< State of the CC1101. */
+static uint32_t          m_mark_ticks;                                              /**< RTC1 counter when m_state was entered or last accounted. */
+static uint16_t          m_budget_us = 0;                                           /**< Wake latency budget, 0 to keep the radio in RX. */
+
+
+/**@brief Function for accounting the time since the last mark to the current state. */
+static void mark(void)
+{
+    uint32_t now;
+    uint32_t diff;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_mark_ticks, &diff));
+    m_stats.ticks[m_state] += diff;
+    m_mark_ticks            = now;
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_POWER.
+ */
+static uint8_t power_mgr_stats_get(uint8_t * p_buf)
+{
+    mark();
+    memcpy(p_buf, &m_stats, sizeof(m_stats));
+    return sizeof(m_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_POWER.
+ */
+static void power_mgr_stats_clear(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    UNUSED_VARIABLE(app_timer_cnt_get(&m_mark_ticks));
+}
+
+
+uint32_t power_mgr_ticks_get(power_mgr_state_t state)
+{
+    mark();
+    return m_stats.ticks[state];
+}
+
+
+void power_mgr_init(cc1101_t * p_radio, cc1101_shadow_t * p_shadow)
+{
+    uint32_t err_code;
+
+    mp_radio  = p_radio;
+    mp_shadow = p_shadow;
+    UNUSED_VARIABLE(app_timer_cnt_get(&m_mark_ticks));
+
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_POWER, power_mgr_stats_get, power_mgr_stats_clear);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+void power_mgr_budget_set(uint16_t budget_us)
+{
+    m_budget_us = budget_us;
+}
+
+
+uint16_t power_mgr_budget_get(void)
+{
+    return m_budget_us;
+}
+
+
+power_mgr_state_t power_mgr_state_get(void)
+{
+    return m_state;
+}
+
+
+void power_mgr_state_set(power_mgr_state_t state)
+{
+    if (state != m_state)
+    {
+        mark();
+        m_state = state;
+    }
+}
+
+
+power_mgr_state_t power_mgr_select(uint32_t idle_ms, uint32_t * p_next_ms)
+{
+    uint8_t i;
+
+    *p_next_ms = 0;
+    if (m_budget_us == 0)
+    {
+        return POWER_MGR_RX;
+    }
+
+    for (i = 0; i < sizeof(m_levels) / sizeof(m_levels[0]); i++)
+    {
+        if (m_levels[i].wake_us > m_budget_us)
+        {
+            continue;
+        }
+        if (idle_ms >= m_levels[i].after_ms)
+        {
+            return m_levels[i].state;
+        }
+        // Deepest first, so the last one set is the nearest.
+        *p_next_ms = m_levels[i].after_ms - idle_ms;
+    }
+    return POWER_MGR_RX;
+}
+
+
+void power_mgr_enter(power_mgr_state_t state)
+{
+    // Any access starts the crystal, wait for it rather than for CHIP_RDYn to time out.
+    if (((m_state == POWER_MGR_XOFF) || (m_state == POWER_MGR_SLEEP)) && !power_mgr_wake())
+    {
+        return;
+    }
+
+    UNUSED_VARIABLE(cc1101_strobe(mp_radio, CC1101_SIDLE));
+    if (state == POWER_MGR_XOFF)
+    {
+        UNUSED_VARIABLE(cc1101_strobe(mp_radio, CC1101_SXOFF));
+    }
+    else if (state == POWER_MGR_SLEEP)
+    {
+        UNUSED_VARIABLE(cc1101_strobe(mp_radio, CC1101_SPWD));
+    }
+    power_mgr_state_set(state);
+}
+
+
+void power_mgr_wake_start(void)
+{
+    // SS low starts the crystal.
+    UNUSED_VARIABLE(cc1101_chip_ready(mp_radio));
+}
+
+
+bool power_mgr_wake_end(bool ready)
+{
+    cc1101_deselect(mp_radio);
+    if (!ready)
+    {
+        m_stats.wake_failures++;
+        return false;
+    }
+
+    if ((m_state == POWER_MGR_XOFF) || (m_state == POWER_MGR_SLEEP))
+    {
+        m_stats.wakeups++;
+        if (m_state == POWER_MGR_SLEEP)
+        {
+            cc1101_shadow_on_sleep(mp_shadow);
+            UNUSED_VARIABLE(cc1101_shadow_flush(mp_shadow));
+            m_stats.restores++;
+        }
+    }
+
+    power_mgr_state_set(POWER_MGR_IDLE);
+    return true;
+}
+
+
+bool power_mgr_wake(void)
+{
+    if ((m_state == POWER_MGR_XOFF) || (m_state == POWER_MGR_SLEEP))
+    {
+        return power_mgr_wake_end(cc1101_wake(mp_radio));
+    }
+
+    power_mgr_state_set(POWER_MGR_IDLE);
+    return true;
+}
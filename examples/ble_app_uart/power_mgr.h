@@ -0,0 +1,132 @@
+/** @file
+ *
+ * @defgroup power_mgr Power manager
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Low power states of the CC1101, chosen from the idle time of the link and a wake
+ *           latency budget, and the time spent in every state.
+ *
+ * @details Receiving costs the CC1101 about 15 mA, IDLE 1.7 mA with the crystal running, XOFF
+ *          165 uA and SLEEP (SPWD) 0.2 uA. The deeper states take longer to leave: the crystal
+ *          restarts after XOFF and SLEEP, and SLEEP also loses TEST2 to TEST0 and PATABLE entries 1
+ *          to 7, which are written back from @ref cc1101_shadow on wake.
+ *
+ *          With a budget of 0, the default, the radio never leaves RX and the peer can send at any
+ *          time. With a budget, the radio listens while there is traffic and for
+ *          @ref POWER_MGR_RX_LINGER_MS after it, then goes to the deepest state that the link has
+ *          been idle long enough for and that wakes within the budget. Nothing is received while
+ *          it is down: this is for a peer that only answers, or that can wait for this end to
+ *          talk. The nRF51 itself waits in System ON idle, see @ref cpu_load, and the CC1101 is put
+ *          to SLEEP before System OFF.
+ *
+ *          The time in every state is published as @ref CTRL_STATS_PAGE_POWER, in RTC1 ticks, so
+ *          that the average current of a configuration follows from the datasheet currents.
+ */
+
+#ifndef POWER_MGR_H__
+#define POWER_MGR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cc1101.h"
+#include "cc1101_shadow.h"
+
+#define POWER_MGR_RX_LINGER_MS          50                                          /**< Listening after the last packet sent or received. */
+#define POWER_MGR_XOFF_AFTER_MS         200                                         /**< Idle time before the crystal is stopped. */
+#define POWER_MGR_SLEEP_AFTER_MS        500                                         /**< Idle time before SPWD. */
+#define POWER_MGR_XOFF_WAKE_US          150                                         /**< Crystal start, typical. */
+#define POWER_MGR_SLEEP_WAKE_US         250                                         /**< Crystal start and restore of the registers lost in SLEEP. */
+
+/**@brief States of the CC1101, in the order of @ref CTRL_STATS_PAGE_POWER. */
+typedef enum
+{
+    POWER_MGR_RX,                                                                   /**< Receiving. */
+    POWER_MGR_TX,                                                                   /**< Sending. */
+    POWER_MGR_IDLE,                                                                 /**< IDLE, crystal running. Also the reset sequence. */
+    POWER_MGR_XOFF,                                                                 /**< Crystal off, registers kept. */
+    POWER_MGR_SLEEP,                                                                /**< SPWD, some registers lost. */
+    POWER_MGR_COUNT                                                                 /**< Number of states. */
+} power_mgr_state_t;
+
+/**@brief Content of @ref CTRL_STATS_PAGE_POWER. */
+typedef struct
+{
+    uint32_t ticks[POWER_MGR_COUNT];                                                /**< RTC1 ticks spent in every state. */
+    uint32_t wakeups;                                                               /**< Wakes from XOFF or SLEEP. */
+    uint32_t restores;                                                              /**< Wakes from SLEEP, with a register restore. */
+    uint32_t wake_failures;                                                         /**< Wakes the chip did not answer. */
+} power_mgr_stats_t;
+
+/**@brief Function for initializing the manager and registering @ref CTRL_STATS_PAGE_POWER.
+ *
+ * @param[in] p_radio   CC1101 driver.
+ * @param[in] p_shadow  Configuration restored after SLEEP.
+ */
+void power_mgr_init(cc1101_t * p_radio, cc1101_shadow_t * p_shadow);
+
+/**@brief Function for setting the wake latency budget.
+ *
+ * @param[in] budget_us  Longest wake allowed, 0 to keep the radio in RX.
+ */
+void power_mgr_budget_set(uint16_t budget_us);
+
+/**@brief Function for getting the wake latency budget. */
+uint16_t power_mgr_budget_get(void);
+
+/**@brief Function for getting the state the CC1101 is in. */
+power_mgr_state_t power_mgr_state_get(void);
+
+/**@brief Function for getting the time spent in a state, up to now.
+ *
+ * @return RTC1 ticks, as in @ref CTRL_STATS_PAGE_POWER.
+ */
+uint32_t power_mgr_ticks_get(power_mgr_state_t state);
+
+/**@brief Function for recording a state the radio driver put the CC1101 in: RX, TX or IDLE.
+ */
+void power_mgr_state_set(power_mgr_state_t state);
+
+/**@brief Function for choosing the state of an idle radio.
+ *
+ * @param[in]  idle_ms    Time since the last packet sent or received.
+ * @param[out] p_next_ms  Time until a deeper state is allowed, 0 if none is.
+ *
+ * @return The deepest state allowed now, @ref POWER_MGR_RX if the radio must keep listening.
+ */
+power_mgr_state_t power_mgr_select(uint32_t idle_ms, uint32_t * p_next_ms);
+
+/**@brief Function for putting the CC1101 in IDLE, XOFF or SLEEP.
+ *
+ * @details The CC1101 must not be accessed until it is woken, any access starts the crystal. From
+ *          XOFF or SLEEP, it is woken with @ref power_mgr_wake first.
+ */
+void power_mgr_enter(power_mgr_state_t state);
+
+/**@brief Function for starting the crystal of the CC1101 after XOFF or SLEEP.
+ *
+ * @details SS stays low. The caller waits for CHIP_RDYn, e.g. with @ref seq_wait on
+ *          @ref cc1101_chip_ready, and then calls @ref power_mgr_wake_end.
+ */
+void power_mgr_wake_start(void);
+
+/**@brief Function for ending a wake started with @ref power_mgr_wake_start: the CC1101 is back in
+ *        IDLE, its registers restored after SLEEP.
+ *
+ * @param[in] ready  The chip got ready in time.
+ *
+ * @return false if it did not, it then needs a reset.
+ */
+bool power_mgr_wake_end(bool ready);
+
+/**@brief Function for bringing the CC1101 back to IDLE, restoring its registers after SLEEP.
+ *
+ * @details Waits for the crystal, up to @ref CC1101_WAKE_US. Only for callers that cannot wait from
+ *          the main loop, e.g. before System OFF, the radio work uses @ref power_mgr_wake_start.
+ *
+ * @return false if the chip did not wake, it then needs a reset.
+ */
+bool power_mgr_wake(void);
+
+#endif // POWER_MGR_H__
+
+/** @} */
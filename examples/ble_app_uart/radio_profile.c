@@ -0,0 +1,89 @@
+/** @file
+ *
+ * @brief Radio profiles implementation.
+ */
+
+#include "radio_profile.h"
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "app_util.h"
+#include "cc1101_cfg.h"
+
+/**@brief Profiles: name, carrier (Hz), data rate (Baud), deviation (Hz), channel spacing (Hz),
+ *        RX filter (Hz), IF (Hz), MDMCFG1.NUM_PREAMBLE, sync word bits (16 or 32), whitening.
+ *
+ * @details Indexes are stored in the configuration of deployed devices: add profiles at the end.
+ *          The 1.2 kBaud profiles trade throughput for range, the 38.4 kBaud ones the other way
+ *          round. Profile 0 is the original configuration of the bridge.
+ */
+#define RADIO_PROFILE_LIST(P)                                                                       \
+    P("868-1k2",  868000000,  1200,  5200, 200000,  58000, 152000, 2, 32, 0)                      \
+    P("868-38k4", 868000000, 38383, 20630, 200000, 100000, 152000, 2, 16, 1)                      \
+    P("433-1k2",  433920000,  1200,  5200, 200000,  58000, 152000, 2, 32, 0)                      \
+    P("433-38k4", 433920000, 38383, 20630, 200000, 100000, 152000, 2, 16, 1)                      \
+    P("915-1k2",  915000000,  1200,  5200, 200000,  58000, 152000, 2, 32, 0)                      \
+    P("915-38k4", 915000000, 38383, 20630, 200000, 100000, 152000, 2, 16, 1)
+
+/**@brief Register values of a profile. MDMCFG2 is GFSK with the DC filter on, AGCCTRL2 is the RF
+ *        Studio value for the data rate, PKTCTRL0 is variable length with CRC. The address of a
+ *        register and the @ref cc1101_cfg macro computing its value share a name. */
+#define RADIO_PROFILE_ENTRY(name, f, r, d, s, bw, f_if, preamble, sync_bits, white)                 \
+    {                                                                                               \
+        name, f, r,                                                                                 \
+        {                                                                                           \
+            {CC1101_FSCTRL1, CC1101_FSCTRL1(f_if)},                                                 \
+            {CC1101_FREQ2, CC1101_FREQ2(f)},                                                        \
+            {CC1101_FREQ1, CC1101_FREQ1(f)},                                                        \
+            {CC1101_FREQ0, CC1101_FREQ0(f)},                                                        \
+            {CC1101_MDMCFG4, CC1101_MDMCFG4(bw, r)},                                                \
+            {CC1101_MDMCFG3, CC1101_MDMCFG3(r)},                                                    \
+            {CC1101_MDMCFG2, 0x10 | (((sync_bits) == 32) ? 0x03 : 0x02)},                           \
+            {CC1101_MDMCFG1, CC1101_MDMCFG1(0, preamble, s)},                                       \
+            {CC1101_MDMCFG0, CC1101_MDMCFG0(s)},                                                    \
+            {CC1101_DEVIATN, CC1101_DEVIATN(d)},                                                    \
+            {CC1101_AGCCTRL2, ((r) > 10000) ? 0x43 : 0x03},                                         \
+            {CC1101_PKTCTRL0, ((white) ? 0x40 : 0x00) | 0x05},                                      \
+        },                                                                                          \
+    },
+
+/**@brief Compile time checks of a profile. */
+#define RADIO_PROFILE_CHECK(name, f, r, d, s, bw, f_if, preamble, sync_bits, white)                 \
+    CC1101_CFG_CHECK(f, r, d, s, bw);                                                               \
+    STATIC_ASSERT(sizeof(name) <= RADIO_PROFILE_NAME_MAX + 1);                                      \
+    STATIC_ASSERT((preamble) <= 7);                                                                 \
+    STATIC_ASSERT(((sync_bits) == 16) || ((sync_bits) == 32));
+
+static radio_profile_t const m_profiles[] =
+{
+    RADIO_PROFILE_LIST(RADIO_PROFILE_ENTRY)
+};
+
+RADIO_PROFILE_LIST(RADIO_PROFILE_CHECK)
+
+STATIC_ASSERT(RADIO_PROFILE_DEFAULT < sizeof(m_profiles) / sizeof(m_profiles[0]));
+
+
+uint8_t radio_profile_count(void)
+{
+    return sizeof(m_profiles) / sizeof(m_profiles[0]);
+}
+
+
+radio_profile_t const * radio_profile_get(uint8_t index)
+{
+    return (index < radio_profile_count()) ? &m_profiles[index] : NULL;
+}
+
+
+uint32_t radio_profile_apply(cc1101_shadow_t * p_shadow, uint8_t index)
+{
+    radio_profile_t const * p_profile = radio_profile_get(index);
+
+    if (p_profile == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    cc1101_shadow_set_list(p_shadow, p_profile->regs, RADIO_PROFILE_REG_COUNT);
+    return NRF_SUCCESS;
+}
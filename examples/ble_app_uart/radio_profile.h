@@ -0,0 +1,59 @@
+/** @file
+ *
+ * @defgroup radio_profile Radio profiles
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Named CC1101 configurations for the supported bands and data rates.
+ *
+ * @details A profile holds the registers that depend on band and data rate: carrier, IF, modem,
+ *          deviation, preamble and sync word length, RX gain and data whitening. The other
+ *          registers come from the common configuration of the radio driver. Profiles are const
+ *          tables in flash, computed and range checked at compile time by @ref cc1101_cfg, so an
+ *          invalid profile does not build.
+ *
+ *          @ref radio_profile_apply writes a profile into a @ref cc1101_shadow. The next flush only
+ *          sends the registers that differ from the profile in use, a few short bursts to change
+ *          the data rate within a band.
+ *
+ *          Both ends of a link must use the same profile. No profile enables FEC: the CC1101 only
+ *          supports it with fixed length packets, and the link uses variable length packets.
+ */
+
+#ifndef RADIO_PROFILE_H__
+#define RADIO_PROFILE_H__
+
+#include <stdint.h>
+#include "cc1101_shadow.h"
+
+#define RADIO_PROFILE_REG_COUNT         12                                          /**< Registers set by a profile. */
+#define RADIO_PROFILE_NAME_MAX          12                                          /**< Longest profile name, without the terminator. */
+#define RADIO_PROFILE_DEFAULT           0                                           /**< Profile used when none was configured, 868 MHz at 1.2 kBaud. */
+
+/**@brief Radio profile. */
+typedef struct
+{
+    char const * p_name;                                                            /**< Name, e.g. "868-1k2". */
+    uint32_t     freq_hz;                                                           /**< Carrier frequency. */
+    uint32_t     drate_baud;                                                        /**< Data rate. */
+    cc1101_reg_t regs[RADIO_PROFILE_REG_COUNT];                                     /**< Register values. */
+} radio_profile_t;
+
+/**@brief Function for getting the number of profiles. */
+uint8_t radio_profile_count(void);
+
+/**@brief Function for getting a profile.
+ *
+ * @return Profile, or NULL if @p index is out of range.
+ */
+radio_profile_t const * radio_profile_get(uint8_t index);
+
+/**@brief Function for writing a profile into a shadow, to be sent with @ref cc1101_shadow_flush.
+ *
+ * @retval NRF_SUCCESS             Profile written.
+ * @retval NRF_ERROR_INVALID_PARAM Unknown profile.
+ */
+uint32_t radio_profile_apply(cc1101_shadow_t * p_shadow, uint8_t index);
+
+#endif // RADIO_PROFILE_H__
+
+/** @} */
@@ -0,0 +1,228 @@
+/** @file
+ *
+ * @brief Radio timestamps implementation.
+ */
+
+#include "radio_ts.h"
+#include <string.h>
+#include "nrf.h"
+#include "nrf_soc.h"
+#include "nordic_common.h"
+#include "app_error.h"
+#include "app_util_platform.h"
+#include "app_timer.h"
+#include "ctrl.h"
+
+#define RADIO_TS_PPI_CH                 0                                           /**< PPI channel from the GDO0 event to the TIMER1 capture. */
+#define RADIO_TS_CC_EDGE                0                                           /**< TIMER1 CC register captured by GDO0. */
+#define RADIO_TS_CC_NOW                 1                                           /**< TIMER1 CC register captured by software. */
+#define RADIO_TS_RTC_MASK               0x00FFFFFF                                  /**< RTC1 counter width. */
+
+STATIC_ASSERT(sizeof(radio_ts_stats_t) <= CTRL_RSP_DATA_MAX);
+
+static radio_ts_stats_t  m_stats;                                                   /**< Statistics. */
+static bool              m_running = false;                                         /**< TIMER1 is counting. */
+static uint32_t          m_sync;                                                    /**< TIMER1 at the last sync edge. */
+static bool              m_sync_valid = false;                                      /**< m_sync belongs to the packet in progress. */
+static radio_ts_frame_t  m_frame;                                                   /**< Last packet that ended. */
+static volatile bool     m_frame_ready = false;                                     /**< m_frame was not taken yet. */
+static uint32_t          m_tx_start;                                                /**< TIMER1 at the last STX. */
+
+
+/**@brief Function for converting a TIMER1 interval to microseconds. */
+static __INLINE uint32_t radio_ts_us(uint32_t from, uint32_t to)
+{
+    return (to - from) / RADIO_TS_TICKS_PER_US;
+}
+
+
+/**@brief Function for taking the last packet that ended and accounting its airtime.
+ */
+static bool radio_ts_take(radio_ts_frame_t * p_frame, uint32_t * p_airtime_us)
+{
+    bool ready;
+
+    CRITICAL_REGION_ENTER();
+    ready = m_frame_ready;
+    if (ready)
+    {
+        *p_frame      = m_frame;
+        m_frame_ready = false;
+    }
+    CRITICAL_REGION_EXIT();
+
+    if (!ready)
+    {
+        return false;
+    }
+
+    if (p_frame->sync_valid)
+    {
+        *p_airtime_us += radio_ts_us(p_frame->sync, p_frame->end);
+        m_stats.last_sync = p_frame->sync;
+    }
+    else
+    {
+        m_stats.sync_missed++;
+    }
+    m_stats.last_end = p_frame->end;
+    return true;
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_RADIO_TS.
+ */
+static uint8_t radio_ts_stats_get(uint8_t * p_buf)
+{
+    memcpy(p_buf, &m_stats, sizeof(m_stats));
+    return sizeof(m_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_RADIO_TS.
+ */
+static void radio_ts_stats_clear(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+
+uint32_t radio_ts_init(uint32_t event_addr)
+{
+    uint32_t err_code;
+
+    NRF_TIMER1->MODE      = TIMER_MODE_MODE_Timer;
+    NRF_TIMER1->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER1->PRESCALER = 0;
+    NRF_TIMER1->TASKS_CLEAR = 1;
+
+    err_code = sd_ppi_channel_assign(RADIO_TS_PPI_CH,
+                                     (const volatile void *)event_addr,
+                                     &NRF_TIMER1->TASKS_CAPTURE[RADIO_TS_CC_EDGE]);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    err_code = sd_ppi_channel_enable_set(1UL << RADIO_TS_PPI_CH);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    radio_ts_start();
+    return ctrl_stats_page_register(CTRL_STATS_PAGE_RADIO_TS, radio_ts_stats_get, radio_ts_stats_clear);
+}
+
+
+void radio_ts_start(void)
+{
+    NRF_TIMER1->TASKS_START = 1;
+    m_running = true;
+}
+
+
+void radio_ts_stop(void)
+{
+    NRF_TIMER1->TASKS_STOP = 1;
+    m_running = false;
+}
+
+
+uint32_t radio_ts_now(void)
+{
+    NRF_TIMER1->TASKS_CAPTURE[RADIO_TS_CC_NOW] = 1;
+    return NRF_TIMER1->CC[RADIO_TS_CC_NOW];
+}
+
+
+uint32_t radio_ts_rtc_ticks(uint32_t time)
+{
+    uint32_t rtc;
+    uint32_t ago;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&rtc));
+    ago = radio_ts_now() - time;
+    return (rtc - (uint32_t)(((uint64_t)ago * APP_TIMER_CLOCK_FREQ) / (RADIO_TS_TICKS_PER_US * 1000000UL))) & RADIO_TS_RTC_MASK;
+}
+
+
+bool radio_ts_on_edge(bool high)
+{
+    uint32_t time = NRF_TIMER1->CC[RADIO_TS_CC_EDGE];
+
+    if (!m_running)
+    {
+        return !high;
+    }
+
+    if (high)
+    {
+        m_sync       = time;
+        m_sync_valid = true;
+        return false;
+    }
+
+    // Low again already: CC[0] holds the end of the packet, whether the sync edge was seen or not.
+    m_frame.sync       = m_sync;
+    m_frame.end        = time;
+    m_frame.sync_valid = m_sync_valid;
+    m_frame_ready      = true;
+    m_sync_valid       = false;
+    return true;
+}
+
+
+void radio_ts_tx_started(void)
+{
+    CRITICAL_REGION_ENTER();
+    m_frame_ready = false;
+    CRITICAL_REGION_EXIT();
+    m_tx_start = radio_ts_now();
+}
+
+
+bool radio_ts_rx_done(radio_ts_frame_t * p_frame)
+{
+    radio_ts_frame_t frame;
+    uint32_t         read_us;
+
+    if (!radio_ts_take(&frame, &m_stats.rx_airtime_us))
+    {
+        return false;
+    }
+
+    read_us                = radio_ts_us(frame.end, radio_ts_now());
+    m_stats.rx_read_us     = read_us;
+    m_stats.rx_read_max_us = MAX(m_stats.rx_read_max_us, read_us);
+    m_stats.rx_frames++;
+    if (p_frame != NULL)
+    {
+        *p_frame = frame;
+    }
+    return true;
+}
+
+
+bool radio_ts_tx_done(radio_ts_frame_t * p_frame)
+{
+    radio_ts_frame_t frame;
+    uint32_t         start_us;
+
+    if (!radio_ts_take(&frame, &m_stats.tx_airtime_us))
+    {
+        return false;
+    }
+
+    if (frame.sync_valid)
+    {
+        start_us                = radio_ts_us(m_tx_start, frame.sync);
+        m_stats.tx_start_us     = start_us;
+        m_stats.tx_start_max_us = MAX(m_stats.tx_start_max_us, start_us);
+    }
+    m_stats.tx_frames++;
+    if (p_frame != NULL)
+    {
+        *p_frame = frame;
+    }
+    return true;
+}
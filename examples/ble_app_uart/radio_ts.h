@@ -0,0 +1,113 @@
+/** @file
+ *
+ * @defgroup radio_ts Radio timestamps
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Hardware timestamps of the sync word and of the end of every CC1101 packet.
+ *
+ * @details GDO0 (IOCFG0 = 0x06) rises when the sync word is sent or received and falls at the end
+ *          of the packet. A GPIOTE IN channel on GDO0 captures TIMER1 into CC[0] through PPI on
+ *          both edges, so the time of an edge does not depend on when its interrupt runs. The
+ *          interrupt only has to copy CC[0] before the next edge, and tells the edges apart by the
+ *          pin level. If it runs after the end of the packet, the sync time is lost and only the
+ *          end is stamped.
+ *
+ *          TIMER1 counts at 16 MHz, 62.5 ns, and wraps after 268 s. It is stopped while the CC1101
+ *          is in a low power state, see @ref power_mgr, so times are only comparable while the
+ *          radio stays up. Its clock is the 16 MHz RC oscillator unless the crystal is running,
+ *          which may be off by a few percent.
+ *
+ *          The airtime of every packet, the delay from the end of a received packet to its read
+ *          from the FIFO and the delay from STX to the sync word sent are published as
+ *          @ref CTRL_STATS_PAGE_RADIO_TS.
+ */
+
+#ifndef RADIO_TS_H__
+#define RADIO_TS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RADIO_TS_TICKS_PER_US           16                                          /**< TIMER1 counts per microsecond. */
+
+/**@brief Timestamps of one packet, in TIMER1 counts. */
+typedef struct
+{
+    uint32_t sync;                                                                  /**< Sync word, valid if sync_valid. */
+    uint32_t end;                                                                   /**< End of the packet. */
+    bool     sync_valid;                                                            /**< The sync edge was told apart from the end. */
+} radio_ts_frame_t;
+
+/**@brief Content of @ref CTRL_STATS_PAGE_RADIO_TS. */
+typedef struct
+{
+    uint32_t rx_frames;                                                             /**< Packets received with a timestamp. */
+    uint32_t tx_frames;                                                             /**< Packets sent with a timestamp. */
+    uint32_t sync_missed;                                                           /**< Packets whose sync edge was handled after their end. */
+    uint32_t rx_airtime_us;                                                         /**< Sync to end of the packets received. */
+    uint32_t tx_airtime_us;                                                         /**< Sync to end of the packets sent. */
+    uint32_t rx_read_us;                                                            /**< Last end of packet to its read from the RX FIFO. */
+    uint32_t rx_read_max_us;                                                        /**< Longest end of packet to its read. */
+    uint32_t tx_start_us;                                                           /**< Last STX to sync word sent: calibration and preamble. */
+    uint32_t tx_start_max_us;                                                       /**< Longest STX to sync word sent. */
+    uint32_t last_sync;                                                             /**< TIMER1 at the sync word of the last packet. */
+    uint32_t last_end;                                                              /**< TIMER1 at the end of the last packet. */
+} radio_ts_stats_t;
+
+/**@brief Function for starting TIMER1, connecting the GDO0 event to its capture and registering
+ *        @ref CTRL_STATS_PAGE_RADIO_TS.
+ *
+ * @details PPI belongs to the SoftDevice once it is enabled, so this is called after it.
+ *
+ * @param[in] event_addr  Address of the GPIOTE IN event of GDO0.
+ *
+ * @return NRF_SUCCESS, or the error of the SoftDevice PPI call.
+ */
+uint32_t radio_ts_init(uint32_t event_addr);
+
+/**@brief Function for starting TIMER1 again when the CC1101 leaves a low power state. */
+void radio_ts_start(void);
+
+/**@brief Function for stopping TIMER1, and its clock, while the CC1101 is in a low power state. */
+void radio_ts_stop(void);
+
+/**@brief Function for reading TIMER1. Not for interrupt context. */
+uint32_t radio_ts_now(void);
+
+/**@brief Function for converting a TIMER1 time of the last few seconds to the RTC1 counter, the time
+ *        base of app_timer. Not for interrupt context.
+ *
+ * @details Rounded to the 31 us RTC1 tick.
+ */
+uint32_t radio_ts_rtc_ticks(uint32_t time);
+
+/**@brief Function for handling a GDO0 edge, from its GPIOTE interrupt.
+ *
+ * @param[in] high  Level of GDO0 when the interrupt runs.
+ *
+ * @return true at the end of a packet.
+ */
+bool radio_ts_on_edge(bool high);
+
+/**@brief Function for recording STX, the start of the delay to the sync word. */
+void radio_ts_tx_started(void);
+
+/**@brief Function for taking the timestamps of the packet just received.
+ *
+ * @param[out] p_frame  Timestamps, may be NULL.
+ *
+ * @return false if no packet ended since the last one taken.
+ */
+bool radio_ts_rx_done(radio_ts_frame_t * p_frame);
+
+/**@brief Function for taking the timestamps of the packet just sent.
+ *
+ * @param[out] p_frame  Timestamps, may be NULL.
+ *
+ * @return false if no packet ended since @ref radio_ts_tx_started.
+ */
+bool radio_ts_tx_done(radio_ts_frame_t * p_frame);
+
+#endif // RADIO_TS_H__
+
+/** @} */
@@ -0,0 +1,195 @@
+/** @file
+ *
+ * @brief Fault recovery implementation.
+ */
+
+#include "recovery.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "SEGGER_RTT.h"
+#include "ctrl.h"
+
+#define RECOVERY_RECORD_MAGIC           0x52434552                                  /**< "RECR", the record was written by this firmware. */
+#define RECOVERY_RECORD_SIZE            0x20                                        /**< Size of IRAM2 in the Keil target. */
+#define RECOVERY_TICKS_TO_US(ticks)     ((uint32_t)(((uint64_t)(ticks) * 1000000) / APP_TIMER_CLOCK_FREQ)) /**< RTC1 ticks to us, app_timer runs RTC1 without prescaler. */
+
+STATIC_ASSERT(sizeof(recovery_stats_t) <= CTRL_RSP_DATA_MAX);
+
+/**@brief Crash record, kept in RAM across the watchdog reset. */
+typedef struct
+{
+    uint32_t        magic;                                                          /**< RECOVERY_RECORD_MAGIC. */
+    uint32_t        crashes;                                                        /**< Fatal errors since the last power-on. */
+    uint32_t        pending;                                                        /**< 1 until the boot after the crash reported it. */
+    uint32_t        error_code;                                                     /**< Error code of the last fatal error. */
+    uint32_t        line_num;                                                       /**< Line of the last fatal error. */
+    uint8_t const * p_file_name;                                                    /**< File of the last fatal error, in flash. */
+    uint32_t        check;                                                          /**< XOR of the fields above, RAM content after a power-on fails it. */
+} recovery_record_t;
+
+STATIC_ASSERT(sizeof(recovery_record_t) <= RECOVERY_RECORD_SIZE);
+
+#if defined(__CC_ARM)
+static recovery_record_t m_record __attribute__((at(RECOVERY_RECORD_ADDR), zero_init));
+#else
+static recovery_record_t m_record __attribute__((section(".noinit")));
+#endif
+
+static recovery_stats_t m_stats;                                                    /**< Statistics. */
+static bool             m_active = false;                                           /**< A recovery is in progress. */
+static uint32_t         m_start_ticks;                                              /**< RTC1 counter at the fault. */
+
+
+/**@brief Function for computing the check word of the record.
+ */
+static uint32_t record_check(void)
+{
+    return m_record.magic ^ m_record.crashes ^ m_record.pending ^ m_record.error_code ^
+           m_record.line_num ^ (uint32_t)m_record.p_file_name;
+}
+
+
+/**@brief Function for checking that a file name of the record points into the code flash.
+ */
+static bool file_name_is_valid(uint8_t const * p_file_name)
+{
+    return (p_file_name != NULL) &&
+           ((uint32_t)p_file_name < (NRF_FICR->CODESIZE * NRF_FICR->CODEPAGESIZE));
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_RECOVERY.
+ */
+static uint8_t recovery_stats_get(uint8_t * p_buf)
+{
+    memcpy(p_buf, &m_stats, sizeof(m_stats));
+    return sizeof(m_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_RECOVERY.
+ *
+ * @details The crash counters stay, they describe the resets rather than this run.
+ */
+static void recovery_stats_clear(void)
+{
+    memset(m_stats.recoveries, 0, sizeof(m_stats.recoveries));
+    m_stats.escalations = 0;
+    m_stats.last_us     = 0;
+    m_stats.max_us      = 0;
+}
+
+
+void recovery_init(void)
+{
+    uint32_t err_code;
+
+    if ((m_record.magic != RECOVERY_RECORD_MAGIC) || (m_record.check != record_check()))
+    {
+        memset(&m_record, 0, sizeof(m_record));
+        m_record.magic = RECOVERY_RECORD_MAGIC;
+    }
+
+    m_stats.crashes     = m_record.crashes;
+    m_stats.crash_error = m_record.error_code;
+    m_stats.crash_line  = m_record.line_num;
+
+    if (m_record.pending != 0)
+    {
+        SEGGER_RTT_printf(0, "crash %u %s:%u\n",
+                          m_record.error_code,
+                          file_name_is_valid(m_record.p_file_name) ? (char const *)m_record.p_file_name : "?",
+                          m_record.line_num);
+        m_record.pending = 0;
+    }
+    m_record.check = record_check();
+
+    if ((NRF_POWER->RESETREAS & POWER_RESETREAS_DOG_Msk) != 0)
+    {
+        NRF_POWER->RESETREAS = POWER_RESETREAS_DOG_Msk;
+    }
+
+    // Keeps counting while the CPU sleeps, stops while a debugger halts it.
+    NRF_WDT->CONFIG      = (WDT_CONFIG_HALT_Pause << WDT_CONFIG_HALT_Pos) |
+                           (WDT_CONFIG_SLEEP_Run << WDT_CONFIG_SLEEP_Pos);
+    NRF_WDT->CRV         = (uint32_t)(((uint64_t)RECOVERY_WDT_TIMEOUT_MS * APP_TIMER_CLOCK_FREQ) / 1000);
+    NRF_WDT->RREN        = WDT_RREN_RR0_Msk;
+    NRF_WDT->TASKS_START = 1;
+
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_RECOVERY, recovery_stats_get, recovery_stats_clear);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+void recovery_wdt_feed(void)
+{
+    NRF_WDT->RR[0] = WDT_RR_RR_Reload;
+}
+
+
+void recovery_start(recovery_cause_t cause)
+{
+    m_stats.recoveries[cause]++;
+    if (!m_active)
+    {
+        m_active = true;
+        UNUSED_VARIABLE(app_timer_cnt_get(&m_start_ticks));
+    }
+}
+
+
+void recovery_escalate(void)
+{
+    if (m_active)
+    {
+        m_stats.escalations++;
+    }
+}
+
+
+void recovery_done(void)
+{
+    uint32_t now;
+    uint32_t ticks;
+
+    if (!m_active)
+    {
+        return;
+    }
+
+    m_active = false;
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_start_ticks, &ticks));
+    m_stats.last_us = RECOVERY_TICKS_TO_US(ticks);
+    m_stats.max_us  = MAX(m_stats.max_us, m_stats.last_us);
+}
+
+
+void recovery_crash(uint32_t error_code, uint32_t line_num, uint8_t const * p_file_name)
+{
+    if ((m_record.magic != RECOVERY_RECORD_MAGIC) || (m_record.check != record_check()))
+    {
+        memset(&m_record, 0, sizeof(m_record));
+        m_record.magic = RECOVERY_RECORD_MAGIC;
+    }
+
+    m_record.crashes++;
+    m_record.pending     = 1;
+    m_record.error_code  = error_code;
+    m_record.line_num    = line_num;
+    m_record.p_file_name = p_file_name;
+    m_record.check       = record_check();
+
+    if (NRF_WDT->RUNSTATUS == 0)
+    {
+        NVIC_SystemReset();
+    }
+
+    for (;;)
+    {
+        // The watchdog resets.
+    }
+}
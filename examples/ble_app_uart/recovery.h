@@ -0,0 +1,95 @@
+/** @file
+ *
+ * @defgroup recovery Fault recovery
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Tiered recovery: a radio fault resets only the CC1101, a fatal error resets the nRF51
+ *           through the watchdog and leaves a crash record for the next boot.
+ *
+ * @details The radio code detects its own faults: accesses abandoned because CHIP_RDYn stayed
+ *          high, an SPI burst that did not complete, RX FIFO errors or sends abandoned in a row, a
+ *          failed wake, and a configuration register that no longer holds the shadowed value,
+ *          which means the chip was reset behind the driver. It then starts a recovery:
+ *
+ *          1. SRES once CHIP_RDYn is low and the configuration of @ref cc1101_shadow written back,
+ *             a few ms. The link state, the queues and the BLE connection are kept.
+ *          2. If the chip does not answer, the power-on reset sequence of the CC1101, retried until
+ *             it does.
+ *
+ *          The nRF51 itself is reset only on what the application cannot continue from: a
+ *          SoftDevice assert, or an error of the SoftDevice or of an nRF51 driver caught by
+ *          APP_ERROR_CHECK. Errors of the SPI master of the CC1101 are radio faults like the above.
+ *          The error is kept in a RAM record that survives the reset, at @ref RECOVERY_RECORD_ADDR
+ *          which the Keil target keeps out of the zero initialized RAM, and the handler waits for
+ *          the watchdog. The watchdog is
+ *          fed from the main loop, so a hung main loop resets as well.
+ *
+ *          The recoveries per cause, their duration and the last crash are published as
+ *          @ref CTRL_STATS_PAGE_RECOVERY. A crash record found at boot is also printed on RTT
+ *          channel 0 as "crash <error> <file>:<line>".
+ */
+
+#ifndef RECOVERY_H__
+#define RECOVERY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RECOVERY_WDT_TIMEOUT_MS         2000                                        /**< Watchdog timeout, the main loop runs at least every RTT poll. */
+#define RECOVERY_RECORD_ADDR            0x20007FE0                                  /**< Crash record, IRAM2 of the Keil target, NoInit. */
+
+/**@brief Radio faults. */
+typedef enum
+{
+    RECOVERY_CAUSE_NO_ANSWER,                                                       /**< CHIP_RDYn stayed high during an access. */
+    RECOVERY_CAUSE_SPI,                                                             /**< An SPI burst failed to start or did not complete. */
+    RECOVERY_CAUSE_FIFO,                                                            /**< RX FIFO errors in a row. */
+    RECOVERY_CAUSE_TX,                                                              /**< Sends abandoned in a row. */
+    RECOVERY_CAUSE_WAKE,                                                            /**< The chip did not wake from XOFF or SLEEP. */
+    RECOVERY_CAUSE_CONFIG,                                                          /**< The configuration was lost. */
+    RECOVERY_CAUSE_COUNT                                                            /**< Number of causes. */
+} recovery_cause_t;
+
+/**@brief Content of @ref CTRL_STATS_PAGE_RECOVERY. */
+typedef struct
+{
+    uint32_t recoveries[RECOVERY_CAUSE_COUNT];                                      /**< Recoveries started, per cause. */
+    uint32_t escalations;                                                           /**< Recoveries that needed the power-on reset sequence. */
+    uint32_t last_us;                                                               /**< Fault to radio configured again, last recovery. */
+    uint32_t max_us;                                                                /**< Longest recovery. */
+    uint32_t crashes;                                                               /**< Watchdog resets after a fatal error, kept across resets. */
+    uint32_t crash_error;                                                           /**< Error code of the last one. */
+    uint32_t crash_line;                                                            /**< Line of the last one. */
+} recovery_stats_t;
+
+/**@brief Function for starting the watchdog, reading the crash record of the last reset and
+ *        registering @ref CTRL_STATS_PAGE_RECOVERY.
+ */
+void recovery_init(void);
+
+/**@brief Function for feeding the watchdog, from the main loop. */
+void recovery_wdt_feed(void);
+
+/**@brief Function for recording the start of a radio recovery.
+ *
+ * @details A fault found during a recovery is counted but keeps its start time.
+ */
+void recovery_start(recovery_cause_t cause);
+
+/**@brief Function for recording that the recovery in progress needs the power-on reset sequence. */
+void recovery_escalate(void);
+
+/**@brief Function for recording the radio configured again, the end of a recovery if one is in
+ *        progress.
+ */
+void recovery_done(void);
+
+/**@brief Function for recording a fatal error and waiting for the watchdog reset.
+ *
+ * @details Resets right away if the watchdog is not running yet. Does not return.
+ */
+void recovery_crash(uint32_t error_code, uint32_t line_num, uint8_t const * p_file_name);
+
+#endif // RECOVERY_H__
+
+/** @} */
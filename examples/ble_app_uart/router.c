@@ -0,0 +1,389 @@
+/** @file
+ *
+ * @brief Packet router implementation.
+ */
+
+#include "router.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "app_error.h"
+#include "app_scheduler.h"
+#include "app_timer.h"
+#include "ctrl.h"
+
+/**@brief A sink endpoint. */
+typedef struct
+{
+    pkt_queue_t * p_queues;                                                         /**< Packets waiting to be sent per class, NULL if not registered. */
+    router_kick_t kick;                                                             /**< Called after a packet was queued. */
+    uint8_t       queue_count;                                                      /**< Number of queues. */
+    uint8_t       classes[ROUTER_PORT_COUNT];                                       /**< Queue of every port. */
+    uint8_t       mtu;                                                              /**< Largest packet the sink can send. */
+    bool          kicking;                                                          /**< kick is running. */
+    bool          kick_pending;                                                     /**< kick was requested while running. */
+} sink_t;
+
+/**@brief Counters of the router, published as @ref CTRL_STATS_PAGE_ROUTER. */
+typedef struct
+{
+    uint32_t queued[ROUTER_EP_COUNT];                                               /**< Packets queued per sink. */
+    uint32_t dropped[ROUTER_EP_COUNT];                                              /**< Packets dropped per sink because it was full or the packet too long. */
+    uint32_t no_route[ROUTER_EP_COUNT];                                             /**< Packets discarded per source because their port had no sink. */
+} router_stats_t;
+
+static uint8_t         m_routes[ROUTER_EP_COUNT][ROUTER_PORT_COUNT];                /**< Set of sinks of every source port. */
+static sink_t          m_sinks[ROUTER_EP_COUNT];                                    /**< Sink endpoints. */
+static router_resume_t m_resume[ROUTER_EP_COUNT];                                   /**< Callbacks of the sources holding off their peer. */
+static router_stats_t  m_stats;                                                     /**< Router statistics. */
+static volatile bool   m_resume_pending = false;                                    /**< The resume callbacks are posted to the scheduler. */
+
+STATIC_ASSERT(ROUTER_EP_COUNT <= 8);
+STATIC_ASSERT(sizeof(router_stats_t) <= CTRL_RSP_DATA_MAX);
+
+
+/**@brief Function for queueing a packet to a sink, without kicking it.
+ */
+static uint32_t sink_queue(uint8_t ep, uint8_t port, uint8_t const * p_data, uint8_t length, uint32_t timestamp)
+{
+    sink_t * p_sink = &m_sinks[ep];
+    uint8_t  queue  = (port < ROUTER_PORT_COUNT) ? p_sink->classes[port] : 0;
+
+    if ((p_sink->p_queues == NULL) ||
+        (length > p_sink->mtu) ||
+        (pkt_queue_put_at(&p_sink->p_queues[queue], port, p_data, length, timestamp) != NRF_SUCCESS))
+    {
+        m_stats.dropped[ep]++;
+        return NRF_ERROR_NO_MEM;
+    }
+
+    m_stats.queued[ep]++;
+    return NRF_SUCCESS;
+}
+
+
+void router_sink_kick(uint8_t ep)
+{
+    sink_t * p_sink = &m_sinks[ep];
+    bool     run;
+
+    if (p_sink->kick == NULL)
+    {
+        return;
+    }
+
+    CRITICAL_REGION_ENTER();
+    run = !p_sink->kicking;
+    p_sink->kicking      = true;
+    p_sink->kick_pending = !run;
+    CRITICAL_REGION_EXIT();
+
+    // A kick requested while this one runs, from an interrupt or from the kick itself, runs it again.
+    while (run)
+    {
+        p_sink->kick();
+
+        CRITICAL_REGION_ENTER();
+        run = p_sink->kick_pending;
+        p_sink->kicking      = run;
+        p_sink->kick_pending = false;
+        CRITICAL_REGION_EXIT();
+    }
+}
+
+
+uint32_t router_put(uint8_t src, uint8_t port, uint8_t const * p_data, uint8_t length)
+{
+    uint32_t now;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    return router_put_at(src, port, p_data, length, now);
+}
+
+
+uint32_t router_put_at(uint8_t src, uint8_t port, uint8_t const * p_data, uint8_t length, uint32_t timestamp)
+{
+    uint32_t err_code = NRF_SUCCESS;
+    uint8_t  sinks;
+    uint8_t  ep;
+
+    if ((src >= ROUTER_EP_COUNT) || (port >= ROUTER_PORT_COUNT) || (m_routes[src][port] == 0))
+    {
+        if (src < ROUTER_EP_COUNT)
+        {
+            m_stats.no_route[src]++;
+        }
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    CRITICAL_REGION_ENTER();
+    sinks = m_routes[src][port];
+
+    // Queue to every sink first, so a sink kicked early cannot resume a source before the others.
+    for (ep = 0; ep < ROUTER_EP_COUNT; ep++)
+    {
+        if ((sinks & ROUTER_EP_MASK(ep)) && (sink_queue(ep, port, p_data, length, timestamp) != NRF_SUCCESS))
+        {
+            err_code = NRF_ERROR_NO_MEM;
+        }
+    }
+    CRITICAL_REGION_EXIT();
+
+    for (ep = 0; ep < ROUTER_EP_COUNT; ep++)
+    {
+        if (sinks & ROUTER_EP_MASK(ep))
+        {
+            router_sink_kick(ep);
+        }
+    }
+
+    return err_code;
+}
+
+
+uint32_t router_sink_put(uint8_t ep, uint8_t port, uint8_t const * p_data, uint8_t length)
+{
+    uint32_t err_code;
+    uint32_t now;
+
+    if (ep >= ROUTER_EP_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+
+    CRITICAL_REGION_ENTER();
+    err_code = sink_queue(ep, port, p_data, length, now);
+    CRITICAL_REGION_EXIT();
+
+    router_sink_kick(ep);
+
+    return err_code;
+}
+
+
+/**@brief Function for calling the resume callbacks of the sources, from the main loop.
+ */
+static void resume_evt_handler(void * p_event_data, uint16_t event_size)
+{
+    uint8_t src;
+
+    m_resume_pending = false;
+
+    for (src = 0; src < ROUTER_EP_COUNT; src++)
+    {
+        if (m_resume[src] != NULL)
+        {
+            m_resume[src]();
+        }
+    }
+}
+
+
+void router_sink_pop(uint8_t ep, uint8_t queue)
+{
+    uint32_t err_code;
+    bool     post;
+
+    CRITICAL_REGION_ENTER();
+    UNUSED_VARIABLE(pkt_queue_pop(&m_sinks[ep].p_queues[queue]));
+    post             = !m_resume_pending;
+    m_resume_pending = true;
+    CRITICAL_REGION_EXIT();
+
+    // The sink pops in the middle of its own work (an SPI burst, a notification), the sources
+    // continue once that is done.
+    if (post)
+    {
+        err_code = app_sched_event_put(NULL, 0, resume_evt_handler);
+        APP_ERROR_CHECK(err_code);
+    }
+}
+
+
+uint8_t router_space(uint8_t src)
+{
+    uint8_t space = 0xFF;
+    uint8_t port;
+    uint8_t ep;
+
+    // Only the queue every routed port maps to, a class no port uses does not limit the source.
+    for (port = 0; port < ROUTER_PORT_COUNT; port++)
+    {
+        for (ep = 0; ep < ROUTER_EP_COUNT; ep++)
+        {
+            if (((m_routes[src][port] & ROUTER_EP_MASK(ep)) != 0) && (m_sinks[ep].p_queues != NULL))
+            {
+                space = MIN(space, pkt_queue_space(&m_sinks[ep].p_queues[m_sinks[ep].classes[port]]));
+            }
+        }
+    }
+    return space;
+}
+
+
+bool router_is_blocked(uint8_t src)
+{
+    return (router_space(src) == 0);
+}
+
+
+uint32_t router_sink_register(uint8_t       ep,
+                              pkt_queue_t * p_queues,
+                              uint8_t       queue_count,
+                              uint8_t       mtu,
+                              router_kick_t kick)
+{
+    if ((ep >= ROUTER_EP_COUNT) || (queue_count == 0) || (queue_count > ROUTER_CLASSES_MAX))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_sinks[ep].p_queues    = p_queues;
+    m_sinks[ep].queue_count = queue_count;
+    m_sinks[ep].mtu         = MIN(mtu, PKT_QUEUE_DATA_MAX);
+    m_sinks[ep].kick        = kick;
+    memset(m_sinks[ep].classes, MIN(1, queue_count - 1), sizeof(m_sinks[ep].classes));
+    return NRF_SUCCESS;
+}
+
+
+uint32_t router_class_set(uint8_t ep, uint8_t port, uint8_t class)
+{
+    if ((ep >= ROUTER_EP_COUNT) || (port >= ROUTER_PORT_COUNT) || (class >= m_sinks[ep].queue_count))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_sinks[ep].classes[port] = class;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t router_source_register(uint8_t ep, router_resume_t resume)
+{
+    if (ep >= ROUTER_EP_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_resume[ep] = resume;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t router_route_set(uint8_t src, uint8_t port, uint8_t sinks)
+{
+    uint8_t ep;
+
+    if ((src >= ROUTER_EP_COUNT) || (port >= ROUTER_PORT_COUNT) ||
+        ((sinks & ~(ROUTER_EP_MASK(ROUTER_EP_COUNT) - 1)) != 0))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    for (ep = 0; ep < ROUTER_EP_COUNT; ep++)
+    {
+        if ((sinks & ROUTER_EP_MASK(ep)) && (m_sinks[ep].p_queues == NULL))
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+    }
+
+    m_routes[src][port] = sinks;
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_ROUTE_GET.
+ */
+static uint32_t cmd_route_get(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    memcpy(p_rsp, m_routes, sizeof(m_routes));
+    *p_rsp_len = sizeof(m_routes);
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_ROUTE_SET.
+ */
+static uint32_t cmd_route_set(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    if (args_len < 3)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    return router_route_set(p_args[0], p_args[1], p_args[2]);
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_CLASS_GET.
+ */
+static uint32_t cmd_class_get(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    if ((args_len < 1) || (p_args[0] >= ROUTER_EP_COUNT))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    memcpy(p_rsp, m_sinks[p_args[0]].classes, ROUTER_PORT_COUNT);
+    *p_rsp_len = ROUTER_PORT_COUNT;
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for handling @ref CTRL_CMD_CLASS_SET.
+ */
+static uint32_t cmd_class_set(uint8_t const * p_args, uint8_t args_len, uint8_t * p_rsp, uint8_t * p_rsp_len)
+{
+    if (args_len < 3)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    return router_class_set(p_args[0], p_args[1], p_args[2]);
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_ROUTER.
+ */
+static uint8_t router_stats_get(uint8_t * p_buf)
+{
+    memcpy(p_buf, &m_stats, sizeof(m_stats));
+    return sizeof(m_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_ROUTER.
+ */
+static void router_stats_clear(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+
+void router_init(void)
+{
+    uint32_t err_code;
+
+    memset(m_routes, 0, sizeof(m_routes));
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    err_code = ctrl_cmd_register(CTRL_CMD_ROUTE_GET, cmd_route_get);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = ctrl_cmd_register(CTRL_CMD_ROUTE_SET, cmd_route_set);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = ctrl_cmd_register(CTRL_CMD_CLASS_GET, cmd_class_get);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = ctrl_cmd_register(CTRL_CMD_CLASS_SET, cmd_class_set);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_ROUTER, router_stats_get, router_stats_clear);
+    APP_ERROR_CHECK(err_code);
+}
@@ -0,0 +1,170 @@
+/** @file
+ *
+ * @defgroup router Packet router
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Routing table connecting the endpoints of the bridge.
+ *
+ * @details Every endpoint (NUS, UART, CC1101 radio, RTT) is a source and a sink of packets. A
+ *          source hands each received packet to @ref router_put together with the logical port it
+ *          arrived on. The routing table maps (source, port) to a set of sinks and the packet is
+ *          copied into a @ref pkt_queue of every one of them. Each sink drains its own queues at
+ *          its own pace.
+ *
+ *          A sink may have several queues, one per traffic class. The class of a packet is given
+ *          by its port (@ref router_class_set) and control responses (@ref ROUTER_PORT_CTRL) always
+ *          use queue 0. The sink decides in which order it serves its queues, see @ref pkt_sched.
+ *
+ *          A source that can hold off its peer (the UART with RTS) checks @ref router_is_blocked
+ *          after every packet and is called back through its @ref router_resume_t once a sink has
+ *          freed a slot. Packets from other sources are dropped when a sink queue is full, which is
+ *          counted per sink in @ref CTRL_STATS_PAGE_ROUTER.
+ *
+ *          The table is read and changed at runtime with @ref CTRL_CMD_ROUTE_GET and
+ *          @ref CTRL_CMD_ROUTE_SET, the classes with @ref CTRL_CMD_CLASS_GET and
+ *          @ref CTRL_CMD_CLASS_SET.
+ *
+ * @note    Queue operations run inside a critical region, so sources running in thread mode can
+ *          share sinks with sources running at APP_IRQ_PRIORITY_LOW. The sink and source callbacks
+ *          run with interrupts enabled, the source callbacks from the main loop.
+ */
+
+#ifndef ROUTER_H__
+#define ROUTER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pkt_queue.h"
+
+#define ROUTER_PORT_COUNT               4                                           /**< Number of logical ports per source. */
+#define ROUTER_PORT_CTRL                0xFF                                        /**< Port of control channel responses, see @ref router_sink_put. */
+#define ROUTER_CLASSES_MAX              3                                           /**< Largest number of queues (traffic classes) of a sink. */
+
+#define ROUTER_EP_MASK(ep)              (1 << (ep))                                 /**< Bit of an endpoint in a set of sinks. */
+
+/**@brief Endpoints. */
+typedef enum
+{
+    ROUTER_EP_NUS   = 0,                                                            /**< Nordic UART Service. */
+    ROUTER_EP_UART  = 1,                                                            /**< UART. */
+    ROUTER_EP_RADIO = 2,                                                            /**< CC1101 radio link. */
+    ROUTER_EP_RTT   = 3,                                                            /**< SEGGER RTT channel 0. */
+    ROUTER_EP_COUNT                                                                 /**< Number of endpoints. */
+} router_ep_t;
+
+/**@brief Sink callback, called after a packet was added to the sink queue. */
+typedef void (*router_kick_t)(void);
+
+/**@brief Source callback, called after a sink has freed a slot. */
+typedef void (*router_resume_t)(void);
+
+/**@brief Function for initializing the router.
+ *
+ * @details Clears the routing table and registers the control channel commands and statistics.
+ */
+void router_init(void);
+
+/**@brief Function for registering the queues of a sink.
+ *
+ * @details All ports start in class 1, or in class 0 for a sink with a single queue.
+ *
+ * @param[in] ep           Endpoint.
+ * @param[in] p_queues     Queues of packets to send on the endpoint, one per class.
+ * @param[in] queue_count  Number of queues, at most @ref ROUTER_CLASSES_MAX.
+ * @param[in] mtu          Largest packet the endpoint can send. Longer packets are dropped.
+ * @param[in] kick         Called after a packet was queued, may be NULL for sinks polled from the
+ *                         main loop.
+ *
+ * @retval NRF_SUCCESS             Sink registered.
+ * @retval NRF_ERROR_INVALID_PARAM Unknown endpoint or bad number of queues.
+ */
+uint32_t router_sink_register(uint8_t       ep,
+                              pkt_queue_t * p_queues,
+                              uint8_t       queue_count,
+                              uint8_t       mtu,
+                              router_kick_t kick);
+
+/**@brief Function for setting the traffic class, i.e. the sink queue, of the packets of a port.
+ *
+ * @retval NRF_SUCCESS             Class set.
+ * @retval NRF_ERROR_INVALID_PARAM Unknown sink, port or class.
+ */
+uint32_t router_class_set(uint8_t ep, uint8_t port, uint8_t class);
+
+/**@brief Function for registering a source that holds off its peer when @ref router_is_blocked.
+ *
+ * @retval NRF_SUCCESS             Source registered.
+ * @retval NRF_ERROR_INVALID_PARAM Unknown endpoint.
+ */
+uint32_t router_source_register(uint8_t ep, router_resume_t resume);
+
+/**@brief Function for setting the sinks of a source port.
+ *
+ * @param[in] src    Source endpoint.
+ * @param[in] port   Port of the source.
+ * @param[in] sinks  Set of @ref ROUTER_EP_MASK, 0 to discard the port.
+ *
+ * @retval NRF_SUCCESS             Route set.
+ * @retval NRF_ERROR_INVALID_PARAM Unknown source, port or sink.
+ */
+uint32_t router_route_set(uint8_t src, uint8_t port, uint8_t sinks);
+
+/**@brief Function for routing a packet received by a source.
+ *
+ * @retval NRF_SUCCESS              Packet queued to every sink of the port.
+ * @retval NRF_ERROR_NOT_FOUND      The port has no route, the packet is discarded.
+ * @retval NRF_ERROR_NO_MEM         At least one sink was full or could not send a packet this long.
+ */
+uint32_t router_put(uint8_t src, uint8_t port, uint8_t const * p_data, uint8_t length);
+
+/**@brief Function for routing a packet received by a source, with the time it was received.
+ *
+ * @param[in] timestamp  RTC1 counter stored in @ref pkt_t::timestamp instead of the time it is
+ *                       queued.
+ *
+ * @return As @ref router_put.
+ */
+uint32_t router_put_at(uint8_t src, uint8_t port, uint8_t const * p_data, uint8_t length, uint32_t timestamp);
+
+/**@brief Function for queueing a packet to one sink, bypassing the routing table.
+ *
+ * @details Used for responses of the control channel, with port @ref ROUTER_PORT_CTRL.
+ *
+ * @retval NRF_SUCCESS              Packet queued.
+ * @retval NRF_ERROR_NO_MEM         The sink was full or could not send a packet this long.
+ */
+uint32_t router_sink_put(uint8_t ep, uint8_t port, uint8_t const * p_data, uint8_t length);
+
+/**@brief Function for removing the oldest packet of a sink queue once the sink is done with it.
+ *
+ * @details Resumes the held sources from the main loop, once the sink has returned.
+ *
+ * @param[in] ep     Endpoint.
+ * @param[in] queue  Queue of the sink.
+ */
+void router_sink_pop(uint8_t ep, uint8_t queue);
+
+/**@brief Function for running the callback of a sink, e.g. when the endpoint can send again.
+ *
+ * @details Calls from within the callback, or from an interrupt while it runs, are deferred
+ *          until it returns, so a sink never runs recursively.
+ */
+void router_sink_kick(uint8_t ep);
+
+/**@brief Function for getting the number of packets a source can still route without a drop.
+ *
+ * @return Smallest number of free slots in the queues the routed ports of the source map to, in
+ *         every sink they reach, or 0xFF if the source has no route.
+ */
+uint8_t router_space(uint8_t src);
+
+/**@brief Function for checking whether a sink reachable from a source is full.
+ *
+ * @details A source that holds off its peer while this returns true never loses a packet to a
+ *          full queue, as long as it is the only source of those sinks.
+ */
+bool router_is_blocked(uint8_t src);
+
+#endif // ROUTER_H__
+
+/** @} */
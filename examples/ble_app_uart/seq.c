@@ -0,0 +1,119 @@
+/** @file
+ *
+ * @brief Non-blocking sequences implementation.
+ */
+
+#include "seq.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "app_error.h"
+#include "app_util.h"
+
+
+/**@brief Function for starting the timer of a sequence. */
+static void timer_start(seq_t * p_seq, uint32_t ticks)
+{
+    uint32_t err_code;
+
+    p_seq->busy = true;
+    err_code = app_timer_start(p_seq->timer_id, MAX(ticks, APP_TIMER_MIN_TIMEOUT_TICKS), p_seq);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for ending the wait and running a step. */
+static void step_run(seq_t * p_seq, seq_step_t step)
+{
+    p_seq->busy = false;
+    if (step != NULL)
+    {
+        step(p_seq);
+    }
+}
+
+
+/**@brief Function for handling the timeout of the sequence timer.
+ *
+ * @param[in] p_context  Sequence.
+ */
+static void seq_timeout_handler(void * p_context)
+{
+    seq_t * p_seq = (seq_t *)p_context;
+
+    if (!p_seq->busy)
+    {
+        // Cancelled after the timer had expired.
+        return;
+    }
+
+    if ((p_seq->cond == NULL) || p_seq->cond())
+    {
+        step_run(p_seq, p_seq->next);
+        return;
+    }
+
+    if (p_seq->remaining_ticks < p_seq->poll_ticks)
+    {
+        p_seq->timeouts++;
+        step_run(p_seq, p_seq->on_timeout);
+        return;
+    }
+
+    p_seq->remaining_ticks -= p_seq->poll_ticks;
+    timer_start(p_seq, p_seq->poll_ticks);
+}
+
+
+uint32_t seq_init(seq_t * p_seq, app_timer_id_t timer_id)
+{
+    memset(p_seq, 0, sizeof(*p_seq));
+    p_seq->timer_id = timer_id;
+
+    return app_timer_create(&p_seq->timer_id, APP_TIMER_MODE_SINGLE_SHOT, seq_timeout_handler);
+}
+
+
+void seq_delay(seq_t * p_seq, uint32_t ticks, seq_step_t next)
+{
+    p_seq->next = next;
+    p_seq->cond = NULL;
+    timer_start(p_seq, ticks);
+}
+
+
+void seq_wait(seq_t *    p_seq,
+              seq_cond_t cond,
+              uint32_t   poll_ticks,
+              uint32_t   timeout_ticks,
+              seq_step_t next,
+              seq_step_t on_timeout)
+{
+    if (cond())
+    {
+        step_run(p_seq, next);
+        return;
+    }
+
+    p_seq->next            = next;
+    p_seq->on_timeout      = on_timeout;
+    p_seq->cond            = cond;
+    p_seq->poll_ticks      = MAX(poll_ticks, APP_TIMER_MIN_TIMEOUT_TICKS);
+    p_seq->remaining_ticks = timeout_ticks;
+    timer_start(p_seq, p_seq->poll_ticks);
+}
+
+
+void seq_cancel(seq_t * p_seq)
+{
+    if (p_seq->busy)
+    {
+        p_seq->busy = false;
+        UNUSED_VARIABLE(app_timer_stop(p_seq->timer_id));
+    }
+}
+
+
+bool seq_is_busy(seq_t const * p_seq)
+{
+    return p_seq->busy;
+}
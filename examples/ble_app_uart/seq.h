@@ -0,0 +1,93 @@
+/** @file
+ *
+ * @defgroup seq Non-blocking sequences
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Multi-step driver sequences on app_timer, without busy-waiting.
+ *
+ * @details A sequence is a chain of steps. Instead of calling nrf_delay or spinning on a pin, a step
+ *          ends with @ref seq_delay or @ref seq_wait, naming the step to run once the hardware is
+ *          ready. The CPU is free, or asleep in sd_app_evt_wait, in between.
+ *
+ *          @ref seq_wait polls a condition at a fixed interval and gives up after a timeout, so a
+ *          device that never answers cannot hang the application. The timeout step decides how to
+ *          recover.
+ *
+ *          Steps run from the app_timer timeout handler, i.e. from the main loop when app_timer
+ *          uses the scheduler. Waits are rounded up to APP_TIMER_MIN_TIMEOUT_TICKS (about 150 us at
+ *          prescaler 0).
+ */
+
+#ifndef SEQ_H__
+#define SEQ_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "app_timer.h"
+
+typedef struct seq_s seq_t;
+
+/**@brief Step of a sequence. */
+typedef void (*seq_step_t)(seq_t * p_seq);
+
+/**@brief Condition polled by @ref seq_wait. */
+typedef bool (*seq_cond_t)(void);
+
+/**@brief Sequence instance. */
+struct seq_s
+{
+    app_timer_id_t timer_id;                                                        /**< Single shot timer of the sequence. */
+    seq_step_t     next;                                                            /**< Step run when the wait ends. */
+    seq_step_t     on_timeout;                                                      /**< Step run when the condition was not met in time. */
+    seq_cond_t     cond;                                                            /**< Condition waited for, NULL for a plain delay. */
+    uint32_t       poll_ticks;                                                      /**< Interval between two checks of cond. */
+    uint32_t       remaining_ticks;                                                 /**< Time left before the timeout. */
+    bool           busy;                                                            /**< A wait is in progress. */
+    uint32_t       timeouts;                                                        /**< Number of waits that timed out. */
+};
+
+/**@brief Function for initializing a sequence.
+ *
+ * @param[out] p_seq     Sequence.
+ * @param[in]  timer_id  Timer defined with APP_TIMER_DEF, used by this sequence only.
+ *
+ * @return NRF_SUCCESS or an error code from app_timer_create.
+ */
+uint32_t seq_init(seq_t * p_seq, app_timer_id_t timer_id);
+
+/**@brief Function for running a step after a delay.
+ *
+ * @param[in] p_seq  Sequence.
+ * @param[in] ticks  Delay in RTC1 ticks.
+ * @param[in] next   Step to run.
+ */
+void seq_delay(seq_t * p_seq, uint32_t ticks, seq_step_t next);
+
+/**@brief Function for running a step once a condition is met.
+ *
+ * @details The condition is checked right away, and @p next runs before the function returns if it
+ *          is already met.
+ *
+ * @param[in] p_seq          Sequence.
+ * @param[in] cond           Condition.
+ * @param[in] poll_ticks     Interval between two checks, in RTC1 ticks.
+ * @param[in] timeout_ticks  Time after which @p on_timeout runs instead, in RTC1 ticks.
+ * @param[in] next           Step to run once the condition is met.
+ * @param[in] on_timeout     Step to run on timeout.
+ */
+void seq_wait(seq_t *    p_seq,
+              seq_cond_t cond,
+              uint32_t   poll_ticks,
+              uint32_t   timeout_ticks,
+              seq_step_t next,
+              seq_step_t on_timeout);
+
+/**@brief Function for cancelling the wait in progress, its step does not run. */
+void seq_cancel(seq_t * p_seq);
+
+/**@brief Function for checking whether a wait is in progress. */
+bool seq_is_busy(seq_t const * p_seq);
+
+#endif // SEQ_H__
+
+/** @} */
@@ -0,0 +1,521 @@
+/** @file
+ *
+ * @brief Radio slots implementation.
+ */
+
+#include "slot_sync.h"
+#include <string.h>
+#include "nordic_common.h"
+#include "app_error.h"
+#include "ctrl.h"
+
+#define SLOT_SYNC_TICKS_SIGN            0x00800000                                  /**< Sign bit of a difference of two RTC1 counters. */
+#define SLOT_SYNC_MS_TO_TICKS(ms)       ((uint32_t)(((uint64_t)(ms) * 32768) / 1000)) /**< Milliseconds to RTC1 ticks. */
+
+STATIC_ASSERT(sizeof(slot_sync_stats_t) <= CTRL_RSP_DATA_MAX);
+
+static slot_sync_stats_t m_stats;                                                   /**< Statistics. */
+static uint32_t          m_id;                                                      /**< Device ID of this end. */
+static slot_sync_role_t  m_role = SLOT_SYNC_OFF;                                    /**< Role of this end. */
+static uint32_t          m_period_max;                                              /**< Longest period. */
+static uint32_t          m_period;                                                  /**< Time from the start of the current window to the next, in the master's clock. */
+static uint32_t          m_packet_ticks = 76;                                       /**< Air time of the longest packet, 250 kBaud until set. */
+static uint32_t          m_start;                                                   /**< Start of the window open, else of the next one. */
+static bool              m_open = false;                                            /**< A window is open. */
+static bool              m_traffic;                                                 /**< Data flowed in the window. */
+static uint32_t          m_last_traffic;                                            /**< RTC1 counter at the last data packet. */
+static bool              m_peer_rx;                                                 /**< The peer was heard in the window. */
+static uint8_t           m_missed;                                                  /**< Windows without a beacon (follower) or without the peer (master). */
+static uint32_t          m_search_end;                                              /**< End of the search for a beacon. */
+
+static bool              m_beacon_due;                                              /**< Master: the beacon of the window is not built yet. */
+static bool              m_traffic_last;                                            /**< Master: data flowed in the previous window. */
+static uint8_t           m_idle_windows;                                            /**< Master: idle windows since the period last changed. */
+static uint8_t           m_seq;                                                     /**< Master: sequence number of the next beacon. */
+static uint32_t          m_beacon_start;                                            /**< Master: start of the window of the last beacon. */
+static uint32_t          m_delay;                                                   /**< Master: window start to sync word of the last beacon. */
+static bool              m_delay_valid;                                             /**< Master: m_delay is measured and not sent yet. */
+
+static bool              m_beacon_rx;                                               /**< Follower: the beacon of the window was received. */
+static uint32_t          m_next;                                                    /**< Follower: start of the next window, from the beacon. */
+static uint32_t          m_delay_est;                                               /**< Follower: delay of the master's last beacon. */
+static bool              m_last_valid;                                              /**< Follower: a beacon was received. */
+static uint8_t           m_last_seq;                                                /**< Follower: sequence number of the last beacon. */
+static uint32_t          m_last_sync;                                               /**< Follower: RTC1 counter at its sync word. */
+static uint32_t          m_last_period;                                             /**< Follower: its period. */
+static bool              m_anchor_valid;                                            /**< Follower: the exact start of a window is known. */
+static uint8_t           m_anchor_seq;                                              /**< Follower: sequence number of its beacon. */
+static uint32_t          m_anchor;                                                  /**< Follower: its start. */
+static uint32_t          m_anchor_period;                                           /**< Follower: its period. */
+static bool              m_pred_valid;                                              /**< Follower: a window start was predicted. */
+static uint8_t           m_pred_seq;                                                /**< Follower: sequence number of its beacon. */
+static uint32_t          m_pred;                                                    /**< Follower: the start predicted. */
+static int32_t           m_drift_ppm;                                               /**< Follower: master clock against the local one. */
+static uint32_t          m_err;                                                     /**< Follower: average error of the predicted starts. */
+
+
+/**@brief Function for the signed difference a - b of two RTC1 counters. */
+static int32_t ticks_sub(uint32_t a, uint32_t b)
+{
+    uint32_t diff = (a - b) & SLOT_SYNC_TICKS_MASK;
+
+    return ((diff & SLOT_SYNC_TICKS_SIGN) != 0) ? (int32_t)diff - (int32_t)(SLOT_SYNC_TICKS_MASK + 1) : (int32_t)diff;
+}
+
+
+/**@brief Function for adding a signed time to an RTC1 counter. */
+static uint32_t ticks_add(uint32_t a, int32_t b)
+{
+    return (a + (uint32_t)b) & SLOT_SYNC_TICKS_MASK;
+}
+
+
+/**@brief Function for the shortest time a window is open. */
+static uint32_t window_ticks(void)
+{
+    return SLOT_SYNC_WINDOW_PACKETS * m_packet_ticks + SLOT_SYNC_GUARD_MIN;
+}
+
+
+/**@brief Function for the shortest period, which leaves the radio asleep most of the time. */
+static uint32_t period_min(void)
+{
+    return MAX(SLOT_SYNC_PERIOD_MIN, 4 * window_ticks());
+}
+
+
+/**@brief Function for converting a period of the master to the local clock. */
+static uint32_t local_period(uint32_t period)
+{
+    return period + (int32_t)(((int64_t)period * m_drift_ppm) / 1000000);
+}
+
+
+/**@brief Function for the time a follower opens early and closes late, widened for every beacon
+ *        missed.
+ */
+static uint32_t guard_ticks(void)
+{
+    if (m_role != SLOT_SYNC_FOLLOWER)
+    {
+        return 0;
+    }
+    return (SLOT_SYNC_GUARD_MIN + 2 * m_err) * (1 + m_missed);
+}
+
+
+/**@brief Function for the end of the window open: its shortest length, or longer while data flows,
+ *        but always before the wake for the next one.
+ */
+static uint32_t window_end(void)
+{
+    uint32_t guard = guard_ticks();
+    uint32_t end   = ticks_add(m_start, guard + window_ticks());
+    uint32_t limit = ticks_add(m_start, local_period(m_period) - guard - SLOT_SYNC_WAKE_LEAD);
+
+    if (m_traffic && (ticks_sub(ticks_add(m_last_traffic, 2 * m_packet_ticks), end) > 0))
+    {
+        end = ticks_add(m_last_traffic, 2 * m_packet_ticks);
+    }
+    if (ticks_sub(limit, m_start) <= 0)
+    {
+        return end;
+    }
+    return (ticks_sub(end, limit) > 0) ? limit : end;
+}
+
+
+/**@brief Function for listening for a beacon. */
+static void search_start(uint32_t now)
+{
+    m_role       = SLOT_SYNC_SEARCH;
+    m_open       = false;
+    m_search_end = ticks_add(now, 2 * m_period_max + window_ticks());
+}
+
+
+/**@brief Function for starting to send beacons, with the longest period until data flows. */
+static void master_start(uint32_t now)
+{
+    m_role         = SLOT_SYNC_MASTER;
+    m_open         = false;
+    m_start        = now;
+    m_period       = m_period_max;
+    m_missed       = SLOT_SYNC_LOST_WINDOWS;
+    m_idle_windows = 0;
+    m_traffic_last = false;
+    m_delay_valid  = false;
+}
+
+
+/**@brief Function for starting to follow the beacons of the peer, with no clock estimate yet. */
+static void follower_start(void)
+{
+    m_role         = SLOT_SYNC_FOLLOWER;
+    m_open         = false;
+    m_missed       = 0;
+    m_last_valid   = false;
+    m_anchor_valid = false;
+    m_pred_valid   = false;
+    m_drift_ppm    = 0;
+    m_err          = 0;
+    m_delay_est    = SLOT_SYNC_DELAY_DEFAULT;
+}
+
+
+/**@brief Function for opening the window due, a late one starting now. */
+static void window_open(uint32_t now)
+{
+    if ((m_role == SLOT_SYNC_MASTER) && (ticks_sub(now, m_start) > (int32_t)window_ticks()))
+    {
+        m_start = now;
+    }
+
+    m_open       = true;
+    m_traffic    = false;
+    m_peer_rx    = false;
+    m_beacon_rx  = false;
+    m_beacon_due = (m_role == SLOT_SYNC_MASTER);
+    m_stats.windows++;
+}
+
+
+/**@brief Function for closing the window open and moving to the next one. */
+static void window_close(uint32_t now)
+{
+    m_open = false;
+
+    if (m_role == SLOT_SYNC_MASTER)
+    {
+        m_missed       = m_peer_rx ? 0 : MIN(m_missed + 1, SLOT_SYNC_LOST_WINDOWS);
+        m_traffic_last = m_traffic;
+        m_beacon_due   = false;
+        m_start        = ticks_add(m_start, m_period);
+        return;
+    }
+
+    if (m_beacon_rx)
+    {
+        m_start = m_next;
+        return;
+    }
+
+    m_stats.beacons_missed++;
+    m_start = ticks_add(m_start, local_period(m_period));
+    if (++m_missed >= SLOT_SYNC_LOST_WINDOWS)
+    {
+        m_stats.sync_lost++;
+        search_start(now);
+    }
+}
+
+
+/**@brief Function for what the radio may do in the window open. */
+static slot_sync_slot_t window_slot(void)
+{
+    if ((m_role == SLOT_SYNC_FOLLOWER) && !m_beacon_rx)
+    {
+        return SLOT_SYNC_LISTEN;
+    }
+    return SLOT_SYNC_OPEN;
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_SLOT.
+ */
+static uint8_t slot_sync_stats_get(uint8_t * p_buf)
+{
+    m_stats.role          = m_role;
+    m_stats.peer          = (m_role == SLOT_SYNC_FOLLOWER) ||
+                            ((m_role == SLOT_SYNC_MASTER) && (m_missed < SLOT_SYNC_LOST_WINDOWS));
+    m_stats.period_max_ms = slot_sync_period_max_get();
+    m_stats.period_ticks  = ((m_role == SLOT_SYNC_MASTER) || (m_role == SLOT_SYNC_FOLLOWER)) ? m_period : 0;
+    m_stats.guard_ticks   = guard_ticks();
+    m_stats.drift_ppm     = m_drift_ppm;
+    m_stats.error_ticks   = m_err;
+    memcpy(p_buf, &m_stats, sizeof(m_stats));
+    return sizeof(m_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_SLOT.
+ */
+static void slot_sync_stats_clear(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+
+void slot_sync_init(uint32_t id)
+{
+    uint32_t err_code;
+
+    m_id   = id;
+    m_role = SLOT_SYNC_OFF;
+
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_SLOT, slot_sync_stats_get, slot_sync_stats_clear);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+void slot_sync_enable(uint16_t period_max_ms, uint32_t now)
+{
+    if (period_max_ms == 0)
+    {
+        m_role       = SLOT_SYNC_OFF;
+        m_open       = false;
+        m_period_max = 0;
+        return;
+    }
+
+    m_period_max = MAX(SLOT_SYNC_MS_TO_TICKS(period_max_ms), period_min());
+    if (m_role == SLOT_SYNC_OFF)
+    {
+        search_start(now);
+    }
+    m_period = MIN(m_period, m_period_max);
+}
+
+
+uint16_t slot_sync_period_max_get(void)
+{
+    if (m_role == SLOT_SYNC_OFF)
+    {
+        return 0;
+    }
+    return (uint16_t)MIN(((uint64_t)m_period_max * 1000) / 32768, 0xFFFF);
+}
+
+
+slot_sync_role_t slot_sync_role_get(void)
+{
+    return m_role;
+}
+
+
+void slot_sync_airtime_set(uint32_t packet_ticks)
+{
+    m_packet_ticks = MAX(packet_ticks, 1);
+    m_period_max   = MAX(m_period_max, period_min());
+}
+
+
+slot_sync_slot_t slot_sync_poll(uint32_t now, uint32_t * p_next_ticks)
+{
+    int32_t left;
+
+    *p_next_ticks = 0;
+
+    if (m_role == SLOT_SYNC_OFF)
+    {
+        return SLOT_SYNC_FREE;
+    }
+    if (m_role == SLOT_SYNC_SEARCH)
+    {
+        left = ticks_sub(m_search_end, now);
+        if (left > 0)
+        {
+            *p_next_ticks = left;
+            return SLOT_SYNC_FREE;
+        }
+        master_start(now);
+    }
+
+    if (m_open)
+    {
+        left = ticks_sub(window_end(), now);
+        if (left > 0)
+        {
+            *p_next_ticks = left;
+            return window_slot();
+        }
+        window_close(now);
+        if (m_role == SLOT_SYNC_SEARCH)
+        {
+            return slot_sync_poll(now, p_next_ticks);
+        }
+    }
+
+    left = ticks_sub(ticks_add(m_start, -(int32_t)guard_ticks()), now);
+    if (left <= 0)
+    {
+        window_open(now);
+        *p_next_ticks = MAX(ticks_sub(window_end(), now), 1);
+        return window_slot();
+    }
+
+    if ((m_role == SLOT_SYNC_MASTER) && (m_missed >= SLOT_SYNC_LOST_WINDOWS))
+    {
+        // No follower: listen all the time so that a lower ID starting later is heard.
+        *p_next_ticks = left;
+        return SLOT_SYNC_FREE;
+    }
+    if (left <= SLOT_SYNC_WAKE_LEAD)
+    {
+        // Awake for the window, but not sending yet.
+        *p_next_ticks = left;
+        return SLOT_SYNC_LISTEN;
+    }
+    *p_next_ticks = left - SLOT_SYNC_WAKE_LEAD;
+    return SLOT_SYNC_CLOSED;
+}
+
+
+uint8_t slot_sync_beacon_build(bool backlog, uint8_t * p_frame)
+{
+    uint16_t delay;
+
+    if ((m_role != SLOT_SYNC_MASTER) || !m_open || !m_beacon_due)
+    {
+        return 0;
+    }
+    m_beacon_due = false;
+
+    // Period to the next window.
+    if (m_traffic_last || backlog)
+    {
+        m_period       = m_period / 2;
+        m_idle_windows = 0;
+    }
+    else if (++m_idle_windows >= SLOT_SYNC_IDLE_WINDOWS)
+    {
+        m_period       = m_period * 2;
+        m_idle_windows = 0;
+    }
+    m_period = MIN(MAX(m_period, period_min()), m_period_max);
+
+    delay      = (uint16_t)MIN(m_delay, 0xFFFF);
+    p_frame[0] = SLOT_SYNC_FRAME;
+    p_frame[1] = m_delay_valid ? SLOT_SYNC_FLAG_DELAY_VALID : 0;
+    p_frame[2] = m_seq++;
+    memcpy(&p_frame[3], &m_id, sizeof(m_id));
+    p_frame[7]  = (uint8_t)(m_period);
+    p_frame[8]  = (uint8_t)(m_period >> 8);
+    p_frame[9]  = (uint8_t)(m_period >> 16);
+    p_frame[10] = (uint8_t)(delay);
+    p_frame[11] = (uint8_t)(delay >> 8);
+
+    m_delay_valid  = false;
+    m_beacon_start = m_start;
+    m_stats.beacons_tx++;
+    return SLOT_SYNC_FRAME_LEN;
+}
+
+
+void slot_sync_on_beacon_sent(uint32_t sync_ticks)
+{
+    int32_t delay = ticks_sub(sync_ticks, m_beacon_start);
+
+    if ((m_role == SLOT_SYNC_MASTER) && (delay >= 0))
+    {
+        m_delay       = (uint32_t)delay;
+        m_delay_valid = true;
+    }
+}
+
+
+void slot_sync_on_beacon(uint8_t const * p_frame, uint8_t length, uint32_t sync_ticks)
+{
+    uint32_t id;
+    uint8_t  seq;
+    uint32_t period;
+    uint32_t delay;
+    uint32_t anchor;
+    int32_t  sample;
+
+    if ((m_role == SLOT_SYNC_OFF) || (length < SLOT_SYNC_FRAME_LEN) || (p_frame[0] != SLOT_SYNC_FRAME))
+    {
+        return;
+    }
+
+    memcpy(&id, &p_frame[3], sizeof(id));
+    if (id == m_id)
+    {
+        return;
+    }
+    if (id > m_id)
+    {
+        // The peer follows this end once it hears it.
+        if (m_role == SLOT_SYNC_SEARCH)
+        {
+            master_start(sync_ticks);
+        }
+        return;
+    }
+
+    seq    = p_frame[2];
+    period = p_frame[7] | ((uint32_t)p_frame[8] << 8) | ((uint32_t)p_frame[9] << 16);
+    delay  = p_frame[10] | ((uint32_t)p_frame[11] << 8);
+    if (period == 0)
+    {
+        return;
+    }
+
+    if (m_role != SLOT_SYNC_FOLLOWER)
+    {
+        follower_start();
+    }
+    m_stats.beacons_rx++;
+
+    // The delay of the previous beacon gives the exact start of the previous window.
+    if (((p_frame[1] & SLOT_SYNC_FLAG_DELAY_VALID) != 0) && m_last_valid && (seq == (uint8_t)(m_last_seq + 1)))
+    {
+        anchor = ticks_add(m_last_sync, -(int32_t)delay);
+        if (m_anchor_valid && (m_last_seq == (uint8_t)(m_anchor_seq + 1)))
+        {
+            sample = (int32_t)(((int64_t)(ticks_sub(anchor, m_anchor) - (int32_t)m_anchor_period) * 1000000) /
+                               (int32_t)m_anchor_period);
+            if ((sample <= SLOT_SYNC_DRIFT_MAX_PPM) && (sample >= -SLOT_SYNC_DRIFT_MAX_PPM))
+            {
+                m_drift_ppm += (sample - m_drift_ppm) / 4;
+            }
+        }
+        if (m_pred_valid && (m_pred_seq == m_last_seq))
+        {
+            sample = ticks_sub(anchor, m_pred);
+            sample = (sample < 0) ? -sample : sample;
+            m_err  = (3 * m_err + (uint32_t)sample + 3) / 4;
+        }
+        m_anchor        = anchor;
+        m_anchor_seq    = m_last_seq;
+        m_anchor_period = m_last_period;
+        m_anchor_valid  = true;
+        m_delay_est     = delay;
+    }
+
+    // The start this end expected, checked against the exact one with the next beacon.
+    m_pred_valid = m_open && m_last_valid;
+    m_pred_seq   = seq;
+    m_pred       = m_start;
+
+    m_last_sync   = sync_ticks;
+    m_last_seq    = seq;
+    m_last_period = period;
+    m_last_valid  = true;
+
+    if (!m_open)
+    {
+        m_open    = true;
+        m_traffic = false;
+        m_stats.windows++;
+    }
+    m_period    = period;
+    m_start     = ticks_add(sync_ticks, -(int32_t)m_delay_est);
+    m_next      = ticks_add(m_start, local_period(period));
+    m_beacon_rx = true;
+    m_peer_rx   = true;
+    m_missed    = 0;
+}
+
+
+void slot_sync_on_peer(void)
+{
+    m_peer_rx = true;
+}
+
+
+void slot_sync_on_traffic(uint32_t now)
+{
+    m_traffic      = true;
+    m_last_traffic = now;
+}
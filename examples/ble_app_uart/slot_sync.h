@@ -0,0 +1,163 @@
+/** @file
+ *
+ * @defgroup slot_sync Radio slots
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Periodic radio windows agreed between the two extenders, with the CC1101 asleep in
+ *           between, kept aligned by beacons timestamped in hardware.
+ *
+ * @details Without slots both ends listen all the time, since neither knows when the other sends.
+ *          With slots one end, the master, opens a window every period and starts it with a beacon
+ *
+ *          | SLOT_SYNC_FRAME (1) | flags (1) | seq (1) | id (4) | period (3) | delay (2) |
+ *
+ *          sent on @ref ROUTER_PORT_CTRL. period is the time to the next window and delay the time
+ *          from the start of the previous window to the sync word of the previous beacon, both in
+ *          RTC1 ticks. The master only learns the delay once the beacon is out (see @ref radio_ts),
+ *          so it is sent one beacon late. The follower timestamps the sync word of every beacon in
+ *          its own RTC1 time and gets the exact start of the previous window from the next
+ *          beacon. The drift of its clock against the master's follows from two consecutive
+ *          starts, and the error of its own prediction of a start sets the guard time it opens
+ *          its window early and closes it late by.
+ *
+ *          Data flows within the windows only: the master sends after its beacon, the follower once
+ *          it has received the beacon of the window, and answers every beacon with a credit frame
+ *          so that the master knows it is there. A window stays open while data flows. The master
+ *          halves the period after a window with data, down to a few windows' length, and doubles it
+ *          after @ref SLOT_SYNC_IDLE_WINDOWS idle windows, up to the period set with
+ *          @ref slot_sync_enable. A packet thus waits at most one period.
+ *
+ *          The end with the lower FICR device ID is the master. Once enabled, an end first listens
+ *          for two of the longest periods for a beacon. If it hears none, it starts beaconing
+ *          itself. The follower goes back to listening after @ref SLOT_SYNC_LOST_WINDOWS windows
+ *          without a beacon. The master listens all the time while it has no follower, so that a
+ *          lower ID that starts later is heard.
+ *
+ *          Times are RTC1 ticks, of the 24 bit counter app_timer runs without prescaler, and wrap
+ *          after 512 s. The module keeps no timer: the caller polls it with the time and gets the
+ *          time of the next change back. Published as @ref CTRL_STATS_PAGE_SLOT.
+ */
+
+#ifndef SLOT_SYNC_H__
+#define SLOT_SYNC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SLOT_SYNC_FRAME                 0x02                                        /**< Type byte of a beacon, see @ref link_credit for the other control frames. */
+#define SLOT_SYNC_FRAME_LEN             12                                          /**< Length of a beacon. */
+#define SLOT_SYNC_FLAG_DELAY_VALID      0x01                                        /**< The delay field of a beacon is that of the previous beacon. */
+#define SLOT_SYNC_TICKS_MASK            0x00FFFFFF                                  /**< RTC1 counter width. */
+#define SLOT_SYNC_PERIOD_MIN            4096                                        /**< Shortest period, 125 ms. */
+#define SLOT_SYNC_GUARD_MIN             33                                          /**< Guard time on each side of a window with a perfect prediction, 1 ms. */
+#define SLOT_SYNC_WAKE_LEAD             66                                          /**< Wake before a window: SLEEP exit, calibration and the radio work getting its turn, 2 ms. */
+#define SLOT_SYNC_DELAY_DEFAULT         33                                          /**< Start of window to beacon sync word assumed before the master tells it, 1 ms. */
+#define SLOT_SYNC_DRIFT_MAX_PPM         1000                                        /**< Drift samples beyond this are taken for a missed step and dropped. */
+#define SLOT_SYNC_IDLE_WINDOWS          2                                           /**< Idle windows before the master doubles the period. */
+#define SLOT_SYNC_LOST_WINDOWS          4                                           /**< Windows without the peer before the sync is given up. */
+#define SLOT_SYNC_WINDOW_PACKETS        3                                           /**< Longest packets a window holds at least: beacon, answer and one data packet. */
+
+/**@brief Role of this end. */
+typedef enum
+{
+    SLOT_SYNC_OFF,                                                                  /**< Slots disabled, the radio listens all the time. */
+    SLOT_SYNC_SEARCH,                                                               /**< Listening for a beacon. */
+    SLOT_SYNC_MASTER,                                                               /**< Sending the beacons. */
+    SLOT_SYNC_FOLLOWER                                                              /**< Following the beacons of the peer. */
+} slot_sync_role_t;
+
+/**@brief What the radio may do now. */
+typedef enum
+{
+    SLOT_SYNC_FREE,                                                                 /**< No slot in force: listen and send as without slots. */
+    SLOT_SYNC_LISTEN,                                                               /**< Window open, waiting for its beacon: listen only. */
+    SLOT_SYNC_OPEN,                                                                 /**< Window open: listen and send. */
+    SLOT_SYNC_CLOSED                                                                /**< Between windows: the radio may sleep and must not send. */
+} slot_sync_slot_t;
+
+/**@brief Content of @ref CTRL_STATS_PAGE_SLOT. */
+typedef struct
+{
+    uint8_t  role;                                                                  /**< @ref slot_sync_role_t. */
+    uint8_t  peer;                                                                  /**< 1 if the peer answered recently. */
+    uint16_t period_max_ms;                                                         /**< Longest period, 0 if disabled. */
+    uint32_t period_ticks;                                                          /**< Current period. */
+    uint32_t guard_ticks;                                                           /**< Current guard time. */
+    int32_t  drift_ppm;                                                             /**< Clock of the master against the local one, follower only. */
+    uint32_t error_ticks;                                                           /**< Average error of the predicted window start, follower only. */
+    uint32_t windows;                                                               /**< Windows opened. */
+    uint32_t beacons_tx;                                                            /**< Beacons sent. */
+    uint32_t beacons_rx;                                                            /**< Beacons received. */
+    uint32_t beacons_missed;                                                        /**< Windows the follower got no beacon in. */
+    uint32_t sync_lost;                                                             /**< Times the follower went back to listening. */
+} slot_sync_stats_t;
+
+/**@brief Function for initializing the module, disabled, and registering @ref CTRL_STATS_PAGE_SLOT.
+ *
+ * @param[in] id  Device ID of this end, decides the master.
+ */
+void slot_sync_init(uint32_t id);
+
+/**@brief Function for enabling or disabling the slots.
+ *
+ * @param[in] period_max_ms  Longest period, 0 to disable.
+ * @param[in] now            RTC1 counter.
+ */
+void slot_sync_enable(uint16_t period_max_ms, uint32_t now);
+
+/**@brief Function for getting the longest period, 0 if disabled. */
+uint16_t slot_sync_period_max_get(void);
+
+/**@brief Function for getting the role of this end. */
+slot_sync_role_t slot_sync_role_get(void);
+
+/**@brief Function for setting the air time of the longest packet at the current data rate, which
+ *        sizes the windows.
+ */
+void slot_sync_airtime_set(uint32_t packet_ticks);
+
+/**@brief Function for advancing the windows to now.
+ *
+ * @param[in]  now           RTC1 counter.
+ * @param[out] p_next_ticks  Time until the answer changes, 0 if it does not by itself.
+ *
+ * @return What the radio may do now.
+ */
+slot_sync_slot_t slot_sync_poll(uint32_t now, uint32_t * p_next_ticks);
+
+/**@brief Function for building the beacon of the window just opened, master only.
+ *
+ * @param[in]  backlog  Packets are waiting to be sent, the period is shortened as after a window
+ *                      with data.
+ * @param[out] p_frame  Beacon, @ref SLOT_SYNC_FRAME_LEN bytes.
+ *
+ * @return Length of the beacon, 0 if none is due.
+ */
+uint8_t slot_sync_beacon_build(bool backlog, uint8_t * p_frame);
+
+/**@brief Function for recording the time the sync word of the last beacon went out.
+ *
+ * @param[in] sync_ticks  RTC1 counter at the sync word.
+ */
+void slot_sync_on_beacon_sent(uint32_t sync_ticks);
+
+/**@brief Function for handling a beacon received.
+ *
+ * @param[in] p_frame     Beacon.
+ * @param[in] length      Length of the beacon.
+ * @param[in] sync_ticks  RTC1 counter at its sync word.
+ */
+void slot_sync_on_beacon(uint8_t const * p_frame, uint8_t length, uint32_t sync_ticks);
+
+/**@brief Function for recording a packet received from the peer. */
+void slot_sync_on_peer(void);
+
+/**@brief Function for recording a data packet sent or received, which keeps the window open.
+ *
+ * @param[in] now  RTC1 counter.
+ */
+void slot_sync_on_traffic(uint32_t now);
+
+#endif // SLOT_SYNC_H__
+
+/** @} */
@@ -0,0 +1,180 @@
+/** @file
+ *
+ * @brief Standby implementation.
+ */
+
+#include "standby.h"
+#include <string.h>
+#include "nrf.h"
+#include "nordic_common.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_scheduler.h"
+#include "app_util_platform.h"
+#include "nrf_drv_gpiote.h"
+#include "bsp.h"
+#include "ctrl.h"
+#include "isr_prof.h"
+
+#define STANDBY_TICKS_TO_US(ticks)      ((uint32_t)(((uint64_t)(ticks) * 1000000) / APP_TIMER_CLOCK_FREQ)) /**< RTC1 ticks to us, app_timer runs RTC1 without prescaler. */
+
+STATIC_ASSERT(sizeof(standby_stats_t) <= CTRL_RSP_DATA_MAX);
+
+static standby_resume_t m_resume;                                                   /**< Resumes the application. */
+static standby_stats_t  m_stats;                                                    /**< Statistics. */
+static volatile bool    m_active = false;                                           /**< In standby. */
+static bool             m_measuring = false;                                        /**< A wake waits for its first radio packet. */
+static bool             m_cold = false;                                             /**< The wake measured is the one from System OFF. */
+static uint32_t         m_wake_ticks;                                               /**< RTC1 counter at the wake measured. */
+
+
+/**@brief Function for resuming the application from the main loop.
+ */
+static void standby_resume_evt_handler(void * p_event_data, uint16_t event_size)
+{
+    m_resume();
+}
+
+
+/**@brief Function for handling the wake button.
+ */
+static void standby_button_handler(nrf_drv_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
+{
+    uint16_t start = isr_prof_enter(ISR_PROF_GPIOTE);
+
+    standby_wake(STANDBY_WAKE_BUTTON);
+    isr_prof_exit(ISR_PROF_GPIOTE, start);
+}
+
+
+/**@brief Function for reading @ref CTRL_STATS_PAGE_STANDBY.
+ */
+static uint8_t standby_stats_get(uint8_t * p_buf)
+{
+    CRITICAL_REGION_ENTER();
+    memcpy(p_buf, &m_stats, sizeof(m_stats));
+    CRITICAL_REGION_EXIT();
+    return sizeof(m_stats);
+}
+
+
+/**@brief Function for clearing @ref CTRL_STATS_PAGE_STANDBY.
+ */
+static void standby_stats_clear(void)
+{
+    CRITICAL_REGION_ENTER();
+    memset(&m_stats, 0, sizeof(m_stats));
+    CRITICAL_REGION_EXIT();
+}
+
+
+void standby_init(standby_resume_t resume)
+{
+    uint32_t                   err_code;
+    nrf_drv_gpiote_in_config_t config = GPIOTE_CONFIG_IN_SENSE_HITOLO(false);
+
+    m_resume = resume;
+
+    // Only the bit read here is cleared, the other reset reasons are left to their readers.
+    if ((NRF_POWER->RESETREAS & POWER_RESETREAS_OFF_Msk) != 0)
+    {
+        NRF_POWER->RESETREAS = POWER_RESETREAS_OFF_Msk;
+        m_wake_ticks         = 0;
+        m_measuring          = true;
+        m_cold               = true;
+    }
+
+    config.pull = NRF_GPIO_PIN_PULLUP;
+    err_code = nrf_drv_gpiote_in_init(BSP_BUTTON_0, &config, standby_button_handler);
+    APP_ERROR_CHECK(err_code);
+    nrf_drv_gpiote_in_event_enable(BSP_BUTTON_0, true);
+
+    err_code = ctrl_stats_page_register(CTRL_STATS_PAGE_STANDBY, standby_stats_get, standby_stats_clear);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+void standby_enter(void)
+{
+    m_stats.entries++;
+    m_active = true;
+}
+
+
+bool standby_is_active(void)
+{
+    return m_active;
+}
+
+
+void standby_wake(standby_wake_t source)
+{
+    uint32_t err_code;
+    bool     wake;
+
+    CRITICAL_REGION_ENTER();
+    wake     = m_active;
+    m_active = false;
+    CRITICAL_REGION_EXIT();
+
+    if (!wake)
+    {
+        return;
+    }
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&m_wake_ticks));
+    m_measuring = true;
+    m_cold      = false;
+    if (source == STANDBY_WAKE_BUTTON)
+    {
+        m_stats.button_wakes++;
+    }
+    else
+    {
+        m_stats.rf_wakes++;
+    }
+
+    err_code = app_sched_event_put(NULL, 0, standby_resume_evt_handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+void standby_on_resumed(void)
+{
+    uint32_t now;
+    uint32_t ticks;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_wake_ticks, &ticks));
+    m_stats.resume_us = STANDBY_TICKS_TO_US(ticks);
+}
+
+
+void standby_on_packet(void)
+{
+    uint32_t now;
+    uint32_t ticks;
+    uint32_t latency_us;
+
+    if (!m_measuring)
+    {
+        return;
+    }
+    m_measuring = false;
+
+    UNUSED_VARIABLE(app_timer_cnt_get(&now));
+    UNUSED_VARIABLE(app_timer_cnt_diff_compute(now, m_wake_ticks, &ticks));
+    latency_us = STANDBY_TICKS_TO_US(ticks);
+
+    CRITICAL_REGION_ENTER();
+    if (m_cold)
+    {
+        m_stats.cold_first_us = latency_us;
+    }
+    else
+    {
+        m_stats.warm_first_us     = latency_us;
+        m_stats.warm_first_max_us = MAX(m_stats.warm_first_max_us, latency_us);
+    }
+    CRITICAL_REGION_EXIT();
+}
@@ -0,0 +1,83 @@
+/** @file
+ *
+ * @defgroup standby Standby
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    System ON standby after the advertising timeout, with a fast resume on a button press
+ *           or a radio packet, and the wake to first packet latency of both wake paths.
+ *
+ * @details System OFF wakes through a reset: SoftDevice, UART and advertising setup, the CC1101
+ *          reset sequence and its configuration, and the link state starts over. In standby the
+ *          nRF51 only waits in System ON idle, with the advertising stopped. RAM, the CC1101
+ *          configuration and calibration, and the link credits are kept, so a resume only
+ *          restarts the advertising and sends a credit frame.
+ *
+ *          The wake button is BSP_BUTTON_0, watched through a GPIOTE port event. A data packet
+ *          received on the radio wakes as well, which needs the radio to listen: with a wake
+ *          latency budget (see @ref power_mgr) the CC1101 sleeps through standby and only the
+ *          button wakes. Link control frames do not wake, and no keepalive is sent in standby, so
+ *          two extenders in standby leave each other there.
+ *
+ *          The latency from the wake to the first radio packet sent, the credit frame that tells
+ *          the peer this end is back, is measured for both paths. After a wake from System OFF
+ *          (RESETREAS.OFF) it counts from the start of RTC1 in app_timer, which misses the reset
+ *          and the clock start before it, a few ms.
+ *          Published as @ref CTRL_STATS_PAGE_STANDBY.
+ */
+
+#ifndef STANDBY_H__
+#define STANDBY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**@brief Wake sources. */
+typedef enum
+{
+    STANDBY_WAKE_BUTTON,                                                            /**< BSP_BUTTON_0. */
+    STANDBY_WAKE_RF                                                                 /**< Data packet received on the radio. */
+} standby_wake_t;
+
+/**@brief Function resuming the application, from the main loop. */
+typedef void (*standby_resume_t)(void);
+
+/**@brief Content of @ref CTRL_STATS_PAGE_STANDBY. */
+typedef struct
+{
+    uint32_t entries;                                                               /**< Standby periods. */
+    uint32_t button_wakes;                                                          /**< Resumes by the button. */
+    uint32_t rf_wakes;                                                              /**< Resumes by a radio packet. */
+    uint32_t resume_us;                                                             /**< Last wake to advertising restarted. */
+    uint32_t warm_first_us;                                                         /**< Last wake from standby to first radio packet sent. */
+    uint32_t warm_first_max_us;                                                     /**< Longest wake from standby to first radio packet sent. */
+    uint32_t cold_first_us;                                                         /**< Wake from System OFF to first radio packet sent, 0 if this boot was not one. */
+} standby_stats_t;
+
+/**@brief Function for initializing standby: wake button, reset reason and
+ *        @ref CTRL_STATS_PAGE_STANDBY.
+ *
+ * @param[in] resume  Posted to the scheduler on wake.
+ */
+void standby_init(standby_resume_t resume);
+
+/**@brief Function for entering standby, once the advertising has stopped. */
+void standby_enter(void);
+
+/**@brief Function for checking whether the application is in standby. */
+bool standby_is_active(void);
+
+/**@brief Function for leaving standby, the resume function runs next from the scheduler.
+ *
+ * @details Does nothing outside standby. May be called from an interrupt.
+ */
+void standby_wake(standby_wake_t source);
+
+/**@brief Function for recording the end of the resume, once the advertising has restarted. */
+void standby_on_resumed(void);
+
+/**@brief Function for recording a radio packet sent, the end of a latency measurement. */
+void standby_on_packet(void);
+
+#endif // STANDBY_H__
+
+/** @} */
@@ -0,0 +1,168 @@
+/** @file
+ *
+ * @brief UART binary framing implementation.
+ */
+
+#include "uart_frame.h"
+#include <string.h>
+#include "nrf_error.h"
+#include "crc16.h"
+
+#define COBS_BLOCK_MAX                  0xFF                                        /**< Code of a full COBS block (254 data bytes, no implied zero). */
+
+
+uint32_t uart_frame_encode(uint8_t         channel,
+                           uint8_t const * p_payload,
+                           uint8_t         length,
+                           uint8_t *       p_out,
+                           uint8_t *       p_out_len)
+{
+    uint8_t  raw[UART_FRAME_RAW_MAX];
+    uint8_t  raw_len;
+    uint16_t crc;
+    uint8_t  code_idx;
+    uint8_t  out_len;
+    uint8_t  code;
+    uint8_t  i;
+
+    if (length > UART_FRAME_PAYLOAD_MAX)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    raw[0] = channel;
+    if (length > 0)
+    {
+        memcpy(&raw[1], p_payload, length);
+    }
+    crc               = crc16_compute(raw, length + 1, NULL);
+    raw[length + 1]   = (uint8_t)(crc & 0xFF);
+    raw[length + 2]   = (uint8_t)(crc >> 8);
+    raw_len           = length + 3;
+
+    // Every zero is replaced by the distance to the next one, stored in the block's code byte.
+    code_idx = 0;
+    out_len  = 1;
+    code     = 1;
+    for (i = 0; i < raw_len; i++)
+    {
+        if (raw[i] == 0)
+        {
+            p_out[code_idx] = code;
+            code_idx        = out_len++;
+            code            = 1;
+        }
+        else
+        {
+            p_out[out_len++] = raw[i];
+            code++;
+            if (code == COBS_BLOCK_MAX)
+            {
+                p_out[code_idx] = code;
+                code_idx        = out_len++;
+                code            = 1;
+            }
+        }
+    }
+    p_out[code_idx]  = code;
+    p_out[out_len++] = UART_FRAME_DELIMITER;
+
+    *p_out_len = out_len;
+    return NRF_SUCCESS;
+}
+
+
+void uart_frame_decoder_reset(uart_frame_decoder_t * p_dec)
+{
+    p_dec->len      = 0;
+    p_dec->code     = 0;
+    p_dec->block    = 0;
+    p_dec->overflow = false;
+}
+
+
+/**@brief Function for appending a decoded byte to the frame in progress.
+ */
+static void decoder_append(uart_frame_decoder_t * p_dec, uint8_t byte)
+{
+    if (p_dec->len < sizeof(p_dec->buf))
+    {
+        p_dec->buf[p_dec->len++] = byte;
+    }
+    else
+    {
+        p_dec->overflow = true;
+    }
+}
+
+
+/**@brief Function for checking a frame terminated by a delimiter.
+ */
+static bool decoder_frame_check(uart_frame_decoder_t * p_dec)
+{
+    uint16_t crc;
+
+    if ((p_dec->code != 0) || p_dec->overflow || (p_dec->len < 3))
+    {
+        p_dec->stats.format_errors++;
+        return false;
+    }
+
+    crc = crc16_compute(p_dec->buf, p_dec->len - 2, NULL);
+    if ((p_dec->buf[p_dec->len - 2] != (uint8_t)(crc & 0xFF)) ||
+        (p_dec->buf[p_dec->len - 1] != (uint8_t)(crc >> 8)))
+    {
+        p_dec->stats.crc_errors++;
+        return false;
+    }
+
+    p_dec->stats.frames++;
+    return true;
+}
+
+
+bool uart_frame_decoder_put(uart_frame_decoder_t * p_dec, uint8_t byte)
+{
+    bool valid = false;
+
+    if (byte == UART_FRAME_DELIMITER)
+    {
+        // A delimiter outside a frame is only padding.
+        if (p_dec->block != 0)
+        {
+            valid = decoder_frame_check(p_dec);
+        }
+        if (!valid)
+        {
+            p_dec->len = 0;
+        }
+        p_dec->code     = 0;
+        p_dec->block    = 0;
+        p_dec->overflow = false;
+        return valid;
+    }
+
+    if (p_dec->block == 0)
+    {
+        // First byte of a new frame, the previous one is no longer needed.
+        p_dec->len = 0;
+    }
+
+    if (p_dec->code == 0)
+    {
+        // Code byte. The previous block implies a zero unless it was a full block.
+        if ((p_dec->block != 0) && (p_dec->block != COBS_BLOCK_MAX))
+        {
+            decoder_append(p_dec, 0);
+        }
+        p_dec->block = byte;
+        p_dec->code  = byte - 1;
+    }
+    else
+    {
+        decoder_append(p_dec, byte);
+        p_dec->code--;
+    }
+
+    return false;
+}
@@ -0,0 +1,124 @@
+/** @file
+ *
+ * @defgroup uart_frame UART binary framing
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    COBS framing with CRC16 for the binary UART mode.
+ *
+ * @details A frame on the wire is the COBS encoding of
+ *
+ *          | channel (1) | payload (0..UART_FRAME_PAYLOAD_MAX) | CRC16-CCITT, LSB first (2) |
+ *
+ *          followed by a single 0x00 delimiter. COBS removes every 0x00 from the encoded bytes, so
+ *          payloads may contain any byte value and the receiver can always resynchronize on the
+ *          next delimiter. The CRC covers the channel byte and the payload.
+ *
+ *          The module only depends on the crc16 library and nrf_error.h, so it also builds on a
+ *          host PC, for the C host tool host/uart_frame_bench.c and the other end of the UART.
+ */
+
+#ifndef UART_FRAME_H__
+#define UART_FRAME_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "compiler_abstraction.h"
+
+#define UART_FRAME_PAYLOAD_MAX          61                                          /**< Largest payload of one frame (one radio packet). */
+#define UART_FRAME_RAW_MAX              (1 + UART_FRAME_PAYLOAD_MAX + 2)            /**< Channel, payload and CRC before encoding. */
+#define UART_FRAME_ENCODED_MAX          (UART_FRAME_RAW_MAX + (UART_FRAME_RAW_MAX / 254) + 2) /**< Worst case encoded size, including the delimiter. */
+
+#define UART_FRAME_DELIMITER            0x00                                        /**< Byte terminating every encoded frame. */
+
+/**@brief Frame channels.
+ *
+ * @details The low nibble of the channel byte is the channel, the high nibble is the logical port
+ *          of a data frame (see @ref router). Channel byte 0x00 is data on port 0.
+ */
+typedef enum
+{
+    UART_FRAME_CH_DATA = 0,                                                         /**< Bridge payload. */
+    UART_FRAME_CH_CTRL = 1,                                                         /**< Command channel, see @ref ctrl. */
+} uart_frame_ch_t;
+
+#define UART_FRAME_CH_BYTE(ch, port)    ((uint8_t)(((port) << 4) | (ch)))           /**< Channel byte of a channel and port. */
+#define UART_FRAME_CH(byte)             ((byte) & 0x0F)                             /**< Channel of a channel byte. */
+#define UART_FRAME_PORT(byte)           ((byte) >> 4)                               /**< Port of a channel byte. */
+
+/**@brief Receive statistics of a decoder. */
+typedef struct
+{
+    uint32_t frames;                                                                /**< Frames delivered with a valid CRC. */
+    uint32_t crc_errors;                                                            /**< Frames dropped because of a CRC mismatch. */
+    uint32_t format_errors;                                                         /**< Frames dropped because they were too short, too long or badly encoded. */
+} uart_frame_stats_t;
+
+/**@brief Streaming frame decoder. */
+typedef struct
+{
+    uint8_t            buf[UART_FRAME_RAW_MAX];                                     /**< Decoded bytes of the frame in progress. */
+    uint8_t            len;                                                         /**< Number of bytes in buf. */
+    uint8_t            code;                                                        /**< Remaining bytes of the current COBS block. */
+    uint8_t            block;                                                       /**< Length code of the current COBS block. */
+    bool               overflow;                                                    /**< The frame in progress does not fit in buf. */
+    uart_frame_stats_t stats;                                                       /**< Receive statistics. */
+} uart_frame_decoder_t;
+
+/**@brief Function for encoding a frame.
+ *
+ * @param[in]  channel    Channel of the frame.
+ * @param[in]  p_payload  Payload, may be NULL when length is zero.
+ * @param[in]  length     Payload length, at most @ref UART_FRAME_PAYLOAD_MAX.
+ * @param[out] p_out      Output buffer of at least @ref UART_FRAME_ENCODED_MAX bytes.
+ * @param[out] p_out_len  Number of bytes written to p_out, including the delimiter.
+ *
+ * @retval NRF_SUCCESS              Frame encoded.
+ * @retval NRF_ERROR_INVALID_LENGTH Payload too long.
+ */
+uint32_t uart_frame_encode(uint8_t         channel,
+                           uint8_t const * p_payload,
+                           uint8_t         length,
+                           uint8_t *       p_out,
+                           uint8_t *       p_out_len);
+
+/**@brief Function for resetting a decoder, discarding any frame in progress.
+ *
+ * @details The statistics are kept.
+ */
+void uart_frame_decoder_reset(uart_frame_decoder_t * p_dec);
+
+/**@brief Function for feeding one received byte to a decoder.
+ *
+ * @return true when the byte completed a valid frame. The frame is then available through
+ *         @ref uart_frame_channel, @ref uart_frame_payload and @ref uart_frame_payload_len until
+ *         the next byte is fed.
+ */
+bool uart_frame_decoder_put(uart_frame_decoder_t * p_dec, uint8_t byte);
+
+/**@brief Function for checking whether a decoder is in the middle of a frame. */
+static __INLINE bool uart_frame_decoder_busy(uart_frame_decoder_t const * p_dec)
+{
+    return (p_dec->block != 0);
+}
+
+/**@brief Function for getting the channel of the last decoded frame. */
+static __INLINE uint8_t uart_frame_channel(uart_frame_decoder_t const * p_dec)
+{
+    return p_dec->buf[0];
+}
+
+/**@brief Function for getting the payload of the last decoded frame. */
+static __INLINE uint8_t * uart_frame_payload(uart_frame_decoder_t * p_dec)
+{
+    return &p_dec->buf[1];
+}
+
+/**@brief Function for getting the payload length of the last decoded frame. */
+static __INLINE uint8_t uart_frame_payload_len(uart_frame_decoder_t const * p_dec)
+{
+    return p_dec->len - 3;
+}
+
+#endif // UART_FRAME_H__
+
+/** @} */